@@ -0,0 +1,84 @@
+#!/bin/bash
+
+# Times large config transactions: dummy links and routes via them are committed to the running
+# datastore in one edit, then removed in one edit. Every route nexthop is a leafref to a link of
+# the same transaction, the commit goes through the startcmds dependency sort.
+#
+# Usage: ./scripts/benchmark_config_commit.sh [ routes_count ] [ links_count ]
+# must be run as root from the repository root, with the YANG modules installed.
+# IPR2_SR_ARGS passes extra iproute2-sysrepo options, e.g. --config-netlink iproute2-ip-route.
+# The startcmds dependency sort time of each commit is reported apart, from the plugin output, when
+# the plugin is built for benchmarking with: make CPPFLAGS=-DCMDGEN_SORT_TIMING
+
+ROUTES=${1:-100000}
+LINKS=${2:-100}
+DATA_FILE=$(mktemp /tmp/benchmark_config_commit.XXXXXX.xml)
+LOG_FILE=$(mktemp /tmp/benchmark_config_commit.XXXXXX.log)
+
+cleanup() {
+    for ((i = 0; i < LINKS; i++)); do
+        echo "link del bench_commit$i"
+    done | ip -batch - 2>/dev/null
+    rm -f "$DATA_FILE" "$LOG_FILE"
+}
+
+# print the startcmds sort times logged by the plugin since the previous call.
+report_sort_time() {
+    sed -n "$((sort_lines + 1)),\$p" "$LOG_FILE" | grep -o "sorted [0-9]* startcmds in [0-9]* us" |
+        while read -r _ count _ _ us _; do
+            echo "BENCH-INFO: $1 sort startcmds=$count time=$((us / 1000)) ms"
+        done
+    sort_lines=$(wc -l <"$LOG_FILE")
+}
+
+## Step 1: generate the transaction data
+echo "Generating $LINKS dummy links and $ROUTES routes..."
+{
+    echo '<links xmlns="urn:okda:iproute2:ip:link">'
+    for ((i = 0; i < LINKS; i++)); do
+        echo "<link><name>bench_commit$i</name><type>dummy</type>"
+        echo "<admin-status>up</admin-status></link>"
+    done
+    echo '</links>'
+    echo '<routes xmlns="urn:okda:iproute2:ip:route">'
+    for ((i = 0; i < ROUTES; i++)); do
+        echo "<route><prefix>172.$((16 + i / 62500)).$((i / 250 % 250)).$((i % 250))/32</prefix>"
+        echo "<table>254</table><metric>0</metric><tos>default</tos><netns>1</netns>"
+        echo "<nexthop><dev>bench_commit$((i % LINKS))</dev></nexthop></route>"
+    done
+    echo '</routes>'
+} >"$DATA_FILE"
+
+# line buffered, the log is read while the plugin runs.
+stdbuf -oL ./bin/iproute2-sysrepo --no-monitor $IPR2_SR_ARGS >"$LOG_FILE" 2>&1 &
+sysrepo_pid=$!
+sort_lines=0
+sleep 1
+
+## Step 2: time the commit of the whole data
+start=$(date +%s%N)
+sysrepocfg -d running --edit "$DATA_FILE" -t 600
+ret=$?
+end=$(date +%s%N)
+if [ $ret -ne 0 ]; then
+    echo "BENCH-ERROR: failed to commit $ROUTES routes"
+else
+    echo "BENCH-INFO: commit links=$LINKS routes=$ROUTES time=$(((end - start) / 1000000)) ms"
+fi
+report_sort_time commit
+
+## Step 3: time the removal of the whole data
+start=$(date +%s%N)
+echo '<routes xmlns="urn:okda:iproute2:ip:route"/>' |
+    sysrepocfg -d running --import -m iproute2-ip-route -f xml -t 600 &&
+    echo '<links xmlns="urn:okda:iproute2:ip:link"/>' |
+    sysrepocfg -d running --import -m iproute2-ip-link -f xml -t 600
+end=$(date +%s%N)
+echo "BENCH-INFO: remove links=$LINKS routes=$ROUTES time=$(((end - start) / 1000000)) ms"
+report_sort_time remove
+
+## Step 4: cleanup
+kill $sysrepo_pid
+wait $sysrepo_pid 2>/dev/null
+cleanup
+exit $ret
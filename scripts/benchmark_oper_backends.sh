@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# Compares the oper data converter backends: node by node (default) and YANG JSON (--oper-json).
+# Creates dummy links with addresses and routes, then times operational datastore reads.
+#
+# Usage: ./scripts/benchmark_oper_backends.sh [ links_count ] [ iterations ]
+# must be run as root from the repository root, with the YANG modules installed.
+#
+# No results are recorded for this comparison yet, the JSON backend is not known to be faster
+# and stays opt-in until the numbers of both backends are recorded.
+
+LINKS=${1:-1000}
+ITERATIONS=${2:-10}
+MODULES="iproute2-ip-link iproute2-ip-route"
+
+cleanup() {
+    for ((i = 0; i < LINKS; i++)); do
+        echo "link del bench$i"
+    done | ip -batch - 2>/dev/null
+}
+
+## Step 1: create the benchmark config
+echo "Creating $LINKS dummy links with addresses and routes..."
+cleanup
+for ((i = 0; i < LINKS; i++)); do
+    echo "link add bench$i type dummy"
+    echo "link set bench$i up"
+    echo "address add 10.$((i / 250)).$((i % 250)).1/24 dev bench$i"
+    echo "route add 172.$((16 + i / 62500)).$((i / 250 % 250)).$((i % 250))/32 dev bench$i"
+done | ip -batch -
+if [ $? -ne 0 ]; then
+    echo "BENCH-ERROR: failed to create the benchmark config"
+    cleanup
+    exit 1
+fi
+
+## Step 2: time the operational reads with each backend
+for backend in "" "--oper-json"; do
+    ./bin/iproute2-sysrepo --no-monitor $backend >/dev/null 2>&1 &
+    sysrepo_pid=$!
+    sleep 1
+
+    for module in $MODULES; do
+        start=$(date +%s%N)
+        for ((n = 0; n < ITERATIONS; n++)); do
+            sysrepocfg -X -d operational -m $module -f json >/dev/null
+        done
+        end=$(date +%s%N)
+        echo "BENCH-INFO: backend=${backend:-node-by-node} module=$module" \
+            "avg=$(((end - start) / ITERATIONS / 1000000)) ms"
+    done
+
+    kill $sysrepo_pid
+    wait $sysrepo_pid 2>/dev/null
+done
+
+## Step 3: cleanup
+cleanup
+exit 0
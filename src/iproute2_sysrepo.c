@@ -19,14 +19,17 @@
 #include <pthread.h>
 #include <sys/stat.h>
 #include <setjmp.h>
+#include <errno.h>
 
 #include <stdio.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <stdbool.h>
+#include <net/if.h>
 
 /* common iproute2 */
 #include "utils.h"
+#include "rt_names.h"
 
 /* ip module */
 #include "namespace.h"
@@ -41,7 +44,10 @@
 #include "br_common.h"
 
 /* sysrepo */
+#include "json-c/linkhash.h"
 #include "lib/cmdgen.h"
+#include "lib/netns_cache.h"
+#include "lib/nl_encoder.h"
 #include "lib/oper_data.h"
 #include <sysrepo.h>
 
@@ -78,6 +84,8 @@ static struct filter_util *filter_list;
 
 /* common */
 struct rtnl_handle rth = { .fd = -1 };
+/* cached rtnl handle of the command in progress, see do_cmd() */
+static struct rtnl_handle *running_cmd_rth;
 
 /* sysrepo */
 sr_session_ctx_t *sr_session;
@@ -85,14 +93,54 @@ static sr_conn_ctx_t *sr_connection;
 static sr_subscription_ctx_t *sr_sub_ctx;
 int linux_monitor_suspended = 0;
 
+#define CONFIG_SCOPE_MAX 32
+/* netlink requests pipelined per ack round, their acks must fit the rtnl socket receive buffer */
+#define NL_BATCH_MAX_REQS 128
+/* worker threads applying the netlink requests of different netns concurrently */
+#define NL_WORKERS_MAX 16
+
+/*
+ * config ownership scope, the linux objects loaded and resynced to the running datastore.
+ * objects outside it (routes installed by routing daemons or the kernel, links of other
+ * managers...) are left to the operational datastore. an empty list owns every value.
+ */
+static struct config_scope {
+    int n_protocols;
+    __u32 protocols[CONFIG_SCOPE_MAX]; /* route protocol ids */
+    int n_tables;
+    struct {
+        __u32 first, last;
+    } tables[CONFIG_SCOPE_MAX]; /* route table id ranges */
+    int n_netns;
+    char *netns[CONFIG_SCOPE_MAX]; /* named netns, the default netns is always owned */
+    int n_kinds;
+    char *kinds[CONFIG_SCOPE_MAX]; /* link kinds, "" for links without kind */
+} config_scope;
+
 static void usage(void)
 {
     fprintf(
         stderr,
-        "Usage: iproute2-sysrepo [ --no-monitor ]\n"
+        "Usage: iproute2-sysrepo [ --no-monitor ] [ --oper-json ] [ --oper-netlink MODULES ]\n"
+        "                        [ --config-netlink MODULES ] [ --own-* LIST ]\n"
         "   --no-monitor: run iproute2-sysrepo without monitoring and syncing linux config changes to sysrepo,\n"
         "                 PS: the linux config will be loaded to sysrepo at startup if if \"--no-monitor\" option enabled.\n"
-        "                 by default the monitoring enabled.\"\n");
+        "                 by default the monitoring enabled.\"\n"
+        "   --oper-json: build data trees by emitting a YANG JSON document per module top node\n"
+        "                and parsing it once, instead of creating the nodes one by one.\n"
+        "   --oper-netlink MODULE[,MODULE...]: decode the modules data from netlink dumps instead\n"
+        "                 of iproute2 show commands outputs, supported by: iproute2-ip-link,\n"
+        "                 iproute2-ip-route, iproute2-ip-nexthop.\n"
+        "   --config-netlink MODULE[,MODULE...]: apply the modules config changes with netlink\n"
+        "                 requests instead of iproute2 commands, supported by: iproute2-ip-route,\n"
+        "                 iproute2-ip-nexthop.\n"
+        "   --own-protocols PROTO[,PROTO...]: load to running only the routes of these protocols,\n"
+        "                 e.g. \"boot,static\" to leave routing daemons and kernel routes out.\n"
+        "   --own-tables TABLE[-TABLE][,...]: load to running only the routes of these tables.\n"
+        "   --own-netns NAME[,NAME...]: load and monitor only these netns and the default one.\n"
+        "   --own-link-kinds KIND[,KIND...]: load to running only the links of these kinds,\n"
+        "                 \"none\" stands for links without kind.\n"
+        "   --own-* options scope the running datastore, operational data shows all objects.\n");
     exit(-1);
 }
 
@@ -115,10 +163,26 @@ volatile int exit_application = 0;
 static jmp_buf jbuf;
 static int jump_set = 0;
 
+/**
+ * give back the rtnl handle of a command that exited through iproute2 exit() in the middle of a
+ * netlink exchange, its socket is reset as it might hold unread replies.
+ */
+static void put_running_cmd_rth(void)
+{
+    if (running_cmd_rth == NULL)
+        return;
+    netns_cache_put(running_cmd_rth, true);
+    running_cmd_rth = NULL;
+    rth.fd = -1;
+}
+
 static void exit_cb(void)
 {
-    if (jump_set)
+    if (jump_set) {
+        // the other users of the netns handle wait for it, e.g. the rollback commands.
+        put_running_cmd_rth();
         longjmp(jbuf, EXIT_FAILURE);
+    }
 }
 
 static void sigint_handler(__attribute__((unused)) int signum)
@@ -343,21 +407,12 @@ static int do_cmd(int argc, char **argv)
     char *basename;
     int ret = 0;
 
-    int netns_fd = 0;
+    const char *netns = "1";
+    struct rtnl_handle *cmd_rth;
     // switch to default network namespace, as prev commands might changed the netns.
-    int fd = open("/proc/1/ns/net", O_RDONLY);
-    if (fd == -1) {
-        perror("open");
-        exit(EXIT_FAILURE);
-    }
-    // Switch to the default network namespace
-    if (setns(fd, CLONE_NEWNET) == -1) {
-        perror("setns");
-        close(fd);
+    if (netns_cache_switch(netns) != EXIT_SUCCESS)
         exit(EXIT_FAILURE);
-    }
-    // Close the file descriptor
-    close(fd);
+    put_running_cmd_rth();
 
     /* to run vrf exec without root, capabilities might be set, drop them
 	 * if not needed as the first thing.
@@ -456,9 +511,9 @@ static int do_cmd(int argc, char **argv)
             ++json;
         } else if (matches(opt, "-netns") == 0) {
             NEXT_ARG();
-            if (netns_switch2(argv[1]))
+            if (netns_cache_switch(argv[1]) != EXIT_SUCCESS)
                 exit(-1);
-            netns_fd = netns_get_fd(argv[1]);
+            netns = argv[1];
         } else if (matches(opt, "-Numeric") == 0) {
             ++numeric;
         } else if (matches(opt, "-all") == 0) {
@@ -478,20 +533,29 @@ static int do_cmd(int argc, char **argv)
         argv0 = basename + 2;
         arg_skip = 3;
     }
-    // we need to rtnl_open() for every command in order to have netns_switch() to work.
-    if (rtnl_open(&rth, 0) < 0)
+    // the cache must not keep a netns alive once it is deleted.
+    if (cmds == ip_cmds && argc > arg_skip && matches(argv0, "netns") == 0 &&
+        matches(argv[arg_skip], "delete") == 0)
+        netns_cache_drop(do_all || argc <= arg_skip + 1 ? NULL : argv[arg_skip + 1]);
+
+    // the rtnl socket is bound to its netns, each netns reuses its own cached one.
+    cmd_rth = netns_cache_rth(netns);
+    if (cmd_rth == NULL)
         return EXIT_FAILURE;
 
     for (c = cmds; c->cmd; ++c) {
         if (matches(argv0, c->cmd) == 0) {
+            rth = *cmd_rth;
+            running_cmd_rth = cmd_rth;
             ret = -(c->func(argc - arg_skip, argv + arg_skip));
-            rtnl_close(&rth);
-            if (netns_fd) {
-                close(netns_fd);
-            }
+            running_cmd_rth = NULL;
+            *cmd_rth = rth;
+            rth.fd = -1;
+            netns_cache_put(cmd_rth, false);
             return ret;
         }
     }
+    netns_cache_put(cmd_rth, false);
     fprintf(stderr,
             "Unknown argument \"%s\".\n"
             "\nPossible execution options:\n"
@@ -499,7 +563,6 @@ static int do_cmd(int argc, char **argv)
             "2- Run with individual iproute2 commands arguments.\n",
             argv[1]);
 
-    rtnl_close(&rth);
     return EXIT_FAILURE;
 }
 
@@ -518,6 +581,266 @@ int ip_sr_config_change_cb_prepare(const struct lyd_node *dnode)
     return SR_ERR_OK;
 }
 
+/**
+ * send the native netlink request of a command and wait for its ACK, in the request netns.
+ * @param [in] req netlink request.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int talk_nl_request(struct nl_request *req)
+{
+    struct rtnl_handle *req_rth = netns_cache_rth(req->netns);
+    int ret = EXIT_FAILURE;
+
+    if (req_rth != NULL && nl_request_resolve_devs(req) == EXIT_SUCCESS &&
+        rtnl_talk(req_rth, req->n, NULL) >= 0)
+        ret = EXIT_SUCCESS;
+    netns_cache_put(req_rth, false);
+    return ret;
+}
+
+/**
+ * count the consecutive commands having a native netlink request in the same netns, they are sent
+ * in one batch.
+ * @param [in] cmds commands, starting at the first command of the batch.
+ * @return number of commands in the batch, at most NL_BATCH_MAX_REQS.
+ */
+static int nl_batch_len(struct cmd_info **cmds)
+{
+    int n = 1;
+
+    while (n < NL_BATCH_MAX_REQS && cmds[n] != NULL && cmds[n]->nl_req != NULL &&
+           strcmp(cmds[n]->nl_req->netns, cmds[0]->nl_req->netns) == 0)
+        n++;
+    return n;
+}
+
+/**
+ * send the native netlink requests of a batch of commands on one socket of their netns.
+ * @param [in] cmds commands of the batch, see nl_batch_len().
+ * @param [in] n_cmds number of commands in the batch.
+ * @param [out] errors errno of each command request, 0 if the request is applied.
+ * @return index of the first failed command, -1 if all the batch is applied.
+ */
+static int talk_nl_batch(struct cmd_info **cmds, int n_cmds, int *errors)
+{
+    struct nl_request *reqs[NL_BATCH_MAX_REQS];
+    struct rtnl_handle *req_rth = netns_cache_rth(cmds[0]->nl_req->netns);
+    int n_reqs = 0, ret = EXIT_SUCCESS;
+
+    for (int i = 0; i < n_cmds; i++)
+        errors[i] = ECANCELED;
+    if (req_rth == NULL)
+        return 0;
+    // a missing device ends the batch, the requests before it are still sent.
+    while (n_reqs < n_cmds && nl_request_resolve_devs(cmds[n_reqs]->nl_req) == EXIT_SUCCESS) {
+        reqs[n_reqs] = cmds[n_reqs]->nl_req;
+        n_reqs++;
+    }
+    if (n_reqs > 0)
+        ret = nl_requests_send_batch(req_rth, reqs, n_reqs, errors);
+    // acks left unread would be taken for the replies of the next requests.
+    netns_cache_put(req_rth, ret != EXIT_SUCCESS);
+    for (int i = 0; i < n_cmds; i++) {
+        if (errors[i] != 0)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief native netlink commands of one netns, applied in order by a worker thread.
+ */
+struct nl_partition {
+    struct cmd_info **cmds; /* NULL terminated, in the transaction order */
+    int *run_idx; /* index of each command in the run */
+    int n_cmds;
+};
+
+/**
+ * @brief worker thread applying every stride-th partition of a run.
+ */
+struct nl_worker {
+    struct nl_partition *parts;
+    int n_parts;
+    int first;
+    int stride;
+    int *errors; /* errno of each command of the run */
+    pthread_t thread;
+};
+
+/**
+ * apply the partitions of a worker, a failed batch cancels the rest of its partition.
+ * @param [in] arg worker, see struct nl_worker.
+ * @return NULL.
+ */
+static void *apply_nl_partitions(void *arg)
+{
+    struct nl_worker *worker = arg;
+    int errors[NL_BATCH_MAX_REQS];
+
+    for (int p = worker->first; p < worker->n_parts; p += worker->stride) {
+        struct nl_partition *part = &worker->parts[p];
+        int i = 0, failed = -1;
+
+        while (i < part->n_cmds && failed < 0) {
+            int n_batch = nl_batch_len(&part->cmds[i]);
+
+            failed = talk_nl_batch(&part->cmds[i], n_batch, errors);
+            for (int j = 0; j < n_batch; j++)
+                worker->errors[part->run_idx[i + j]] = errors[j];
+            i += n_batch;
+        }
+        for (; i < part->n_cmds; i++)
+            worker->errors[part->run_idx[i]] = ECANCELED;
+    }
+    return NULL;
+}
+
+/**
+ * count the consecutive commands having a native netlink request.
+ * @param [in] cmds commands, starting at the first command of the run.
+ * @return number of commands in the run.
+ */
+static int nl_run_len(struct cmd_info **cmds)
+{
+    int n = 0;
+
+    while (cmds[n] != NULL && cmds[n]->nl_req != NULL)
+        n++;
+    return n;
+}
+
+/**
+ * apply a run of native netlink commands. The routes and nexthops of different netns never depend
+ * on each other, the run is partitioned per netns and the partitions are applied concurrently by
+ * worker threads, each one switched to the netns it applies. The order of the commands of a netns
+ * is kept.
+ * @param [in] cmds commands of the run, see nl_run_len().
+ * @param [in] n_cmds number of commands in the run.
+ * @param [out] errors errno of each command, 0 if the command is applied.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the run could not be partitioned.
+ */
+static int apply_nl_run(struct cmd_info **cmds, int n_cmds, int *errors)
+{
+    struct nl_partition *parts = calloc(n_cmds, sizeof(*parts));
+    struct cmd_info **part_cmds = calloc(2 * n_cmds, sizeof(*part_cmds));
+    int *run_idx = calloc(n_cmds, sizeof(*run_idx));
+    int *cmd_part = calloc(n_cmds, sizeof(*cmd_part));
+    struct lh_table *netns_parts = lh_kchar_table_new(16, NULL); /* netns -> partition */
+    struct nl_worker workers[NL_WORKERS_MAX];
+    int n_parts = 0, n_workers, offset = 0;
+
+    if (parts == NULL || part_cmds == NULL || run_idx == NULL || cmd_part == NULL ||
+        netns_parts == NULL) {
+        fprintf(stderr, "%s: memory allocation failed\n", __func__);
+        goto error;
+    }
+    // bucket the commands by netns, one lookup per command.
+    for (int i = 0; i < n_cmds; i++) {
+        void *part;
+
+        if (lh_table_lookup_ex(netns_parts, cmds[i]->nl_req->netns, &part)) {
+            cmd_part[i] = (struct nl_partition *)part - parts;
+        } else {
+            if (lh_table_insert(netns_parts, cmds[i]->nl_req->netns, &parts[n_parts]) != 0) {
+                fprintf(stderr, "%s: memory allocation failed\n", __func__);
+                goto error;
+            }
+            cmd_part[i] = n_parts++;
+        }
+        parts[cmd_part[i]].n_cmds++;
+    }
+    // lay the partitions out contiguously, each NULL terminated for nl_batch_len().
+    for (int p = 0; p < n_parts; p++) {
+        parts[p].cmds = &part_cmds[offset];
+        parts[p].run_idx = &run_idx[offset - p];
+        offset += parts[p].n_cmds + 1;
+        parts[p].n_cmds = 0;
+    }
+    for (int i = 0; i < n_cmds; i++) {
+        struct nl_partition *part = &parts[cmd_part[i]];
+
+        part->cmds[part->n_cmds] = cmds[i];
+        part->run_idx[part->n_cmds++] = i;
+    }
+
+    n_workers = n_parts < NL_WORKERS_MAX ? n_parts : NL_WORKERS_MAX;
+    for (int w = 0; w < n_workers; w++) {
+        workers[w] = (struct nl_worker){
+            .parts = parts,
+            .n_parts = n_parts,
+            .first = w,
+            .stride = n_workers,
+            .errors = errors,
+        };
+        // the first worker runs on the calling thread, a single netns run spawns no thread.
+        if (w > 0 && pthread_create(&workers[w].thread, NULL, apply_nl_partitions,
+                                    &workers[w]) != 0) {
+            fprintf(stderr, "%s: failed to create worker thread\n", __func__);
+            workers[w].thread = 0;
+            apply_nl_partitions(&workers[w]);
+        }
+    }
+    apply_nl_partitions(&workers[0]);
+    for (int w = 1; w < n_workers; w++) {
+        if (workers[w].thread)
+            pthread_join(workers[w].thread, NULL);
+    }
+
+    free(parts);
+    free(part_cmds);
+    free(run_idx);
+    free(cmd_part);
+    lh_table_free(netns_parts);
+    return EXIT_SUCCESS;
+
+error:
+    free(parts);
+    free(part_cmds);
+    free(run_idx);
+    free(cmd_part);
+    if (netns_parts)
+        lh_table_free(netns_parts);
+    return EXIT_FAILURE;
+}
+
+/**
+ * execute the rollback of an applied command, failures are reported and ignored.
+ * @param [in] cmd applied command.
+ */
+static void rollback_cmd(struct cmd_info *cmd)
+{
+    fprintf(stderr, "%s: executing rollback cmd: ", __func__);
+    print_cmd_line(cmd->rollback_argc, cmd->rollback_argv);
+    if (cmd->rollback_nl_req) {
+        talk_nl_request(cmd->rollback_nl_req);
+        return;
+    }
+    if (setjmp(jbuf)) {
+        // rollback cmd failed, continue with the reset rollback cmds.
+        atexit(exit_cb);
+        return;
+    }
+    do_cmd(cmd->rollback_argc, cmd->rollback_argv);
+}
+
+/**
+ * roll back a run of native netlink commands as a whole, in reverse order. Every command whose
+ * request was applied or left unacked is undone, whatever partition it belongs to: the workers of
+ * the other netns keep applying their partitions after a failure in one of them. The commands
+ * never sent are skipped.
+ * @param [in] cmds commands of the run.
+ * @param [in] n_cmds number of commands in the run.
+ * @param [in] errors errno of each command, see apply_nl_run().
+ */
+static void rollback_nl_run(struct cmd_info **cmds, int n_cmds, const int *errors)
+{
+    for (int j = n_cmds - 1; j >= 0; j--) {
+        if (errors[j] == 0 || errors[j] == NL_REQUEST_UNACKED)
+            rollback_cmd(cmds[j]);
+    }
+}
+
 int ip_sr_config_change_cb_apply(const struct lyd_node *change_dnode)
 {
     int ret = SR_ERR_OK;
@@ -531,31 +854,57 @@ int ip_sr_config_change_cb_apply(const struct lyd_node *change_dnode)
         fprintf(stderr, "%s: failed to generate commands for the change \n", __func__);
         return SR_ERR_CALLBACK_FAILED;
     }
+    jump_set = 1;
     for (int i = 0; ipr2_cmds[i] != NULL; i++) {
-        fprintf(stdout, "%s: executing command: ", __func__);
-        print_cmd_line(ipr2_cmds[i]->argc, ipr2_cmds[i]->argv);
-        jump_set = 1;
-        if (setjmp(jbuf)) {
-            // iproute2 exited, go to rollback.
-            atexit(exit_cb);
-            goto rollback;
+        if (ipr2_cmds[i]->nl_req) {
+            // route and nexthop entries encoded natively skip the iproute2 argv parsing, the
+            // consecutive ones are applied per netns and pipelined on one socket per netns.
+            int n_run = nl_run_len(&ipr2_cmds[i]);
+            int failed = -1;
+            int *errors = calloc(n_run, sizeof(*errors));
+
+            for (int j = 0; j < n_run; j++) {
+                fprintf(stdout, "%s: sending netlink request of command: ", __func__);
+                print_cmd_line(ipr2_cmds[i + j]->argc, ipr2_cmds[i + j]->argv);
+            }
+            if (errors == NULL || apply_nl_run(&ipr2_cmds[i], n_run, errors) != EXIT_SUCCESS) {
+                free(errors);
+                goto rollback;
+            }
+            for (int j = 0; j < n_run && failed < 0; j++) {
+                if (errors[j] != 0)
+                    failed = j;
+            }
+            if (failed < 0) {
+                free(errors);
+                i += n_run - 1;
+                continue;
+            }
+            fprintf(stderr, "%s: netlink request failed, cmd = ", __func__);
+            print_cmd_line(ipr2_cmds[i + failed]->argc, ipr2_cmds[i + failed]->argv);
+            // the sent requests left unacked by a socket error may be applied too, rolling back
+            // an absent object is harmless.
+            rollback_nl_run(&ipr2_cmds[i], n_run, errors);
+            free(errors);
+            goto rollback_previous;
+        } else {
+            fprintf(stdout, "%s: executing command: ", __func__);
+            print_cmd_line(ipr2_cmds[i]->argc, ipr2_cmds[i]->argv);
+            if (setjmp(jbuf)) {
+                // iproute2 exited, go to rollback.
+                atexit(exit_cb);
+                goto rollback;
+            }
+            ret = do_cmd(ipr2_cmds[i]->argc, ipr2_cmds[i]->argv);
         }
-        ret = do_cmd(ipr2_cmds[i]->argc, ipr2_cmds[i]->argv);
         if (ret != EXIT_SUCCESS) {
 rollback:
             fprintf(stderr, "%s: iproute2 command failed, cmd = ", __func__);
             print_cmd_line(ipr2_cmds[i]->argc, ipr2_cmds[i]->argv);
-            // rollback on failure.
-            for (i--; i >= 0; i--) {
-                if (setjmp(jbuf)) {
-                    // rollback cmd failed, continue with the reset rollback cmds.
-                    atexit(exit_cb);
-                    continue;
-                }
-                fprintf(stderr, "%s: executing rollback cmd: ", __func__);
-                print_cmd_line(ipr2_cmds[i]->rollback_argc, ipr2_cmds[i]->rollback_argv);
-                do_cmd(ipr2_cmds[i]->rollback_argc, ipr2_cmds[i]->rollback_argv);
-            }
+rollback_previous:
+            // rollback on failure, the commands before the failed one or run.
+            for (i--; i >= 0; i--)
+                rollback_cmd(ipr2_cmds[i]);
             ret = SR_ERR_CALLBACK_FAILED;
             break;
         }
@@ -672,6 +1021,466 @@ exit_check_done:
     return ret;
 }
 
+/**
+ * parse a comma separated --own-* option value into the config ownership scope.
+ * @param [in] option option name.
+ * @param [in] value option value.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on invalid value.
+ */
+static int parse_config_scope(const char *option, const char *value)
+{
+    char *values = strdup(value), *saveptr = NULL;
+    int ret = EXIT_SUCCESS;
+
+    if (values == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return EXIT_FAILURE;
+    }
+    if (strcmp(option, "--own-protocols") && strcmp(option, "--own-tables") &&
+        strcmp(option, "--own-netns") && strcmp(option, "--own-link-kinds")) {
+        fprintf(stderr, "Unknown argument \"%s\"\n", option);
+        free(values);
+        return EXIT_FAILURE;
+    }
+    for (char *token = strtok_r(values, ",", &saveptr); token;
+         token = strtok_r(NULL, ",", &saveptr)) {
+        if (!strcmp(option, "--own-protocols") && config_scope.n_protocols < CONFIG_SCOPE_MAX) {
+            if (rtnl_rtprot_a2n(&config_scope.protocols[config_scope.n_protocols], token))
+                ret = EXIT_FAILURE;
+            else
+                config_scope.n_protocols++;
+        } else if (!strcmp(option, "--own-tables") && config_scope.n_tables < CONFIG_SCOPE_MAX) {
+            char *last = strchr(token, '-');
+            if (last)
+                *last++ = '\0';
+            if (rtnl_rttable_a2n(&config_scope.tables[config_scope.n_tables].first, token) ||
+                rtnl_rttable_a2n(&config_scope.tables[config_scope.n_tables].last,
+                                 last ? last : token))
+                ret = EXIT_FAILURE;
+            else
+                config_scope.n_tables++;
+        } else if (!strcmp(option, "--own-netns") && config_scope.n_netns < CONFIG_SCOPE_MAX) {
+            config_scope.netns[config_scope.n_netns] = strdup(token);
+            if (config_scope.netns[config_scope.n_netns] == NULL) {
+                fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+                ret = EXIT_FAILURE;
+            } else {
+                config_scope.n_netns++;
+            }
+        } else if (!strcmp(option, "--own-link-kinds") && config_scope.n_kinds < CONFIG_SCOPE_MAX) {
+            config_scope.kinds[config_scope.n_kinds] = strdup(strcmp(token, "none") ? token : "");
+            if (config_scope.kinds[config_scope.n_kinds] == NULL) {
+                fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+                ret = EXIT_FAILURE;
+            } else {
+                config_scope.n_kinds++;
+            }
+        } else {
+            fprintf(stderr, "%s: Too many %s values\n", __func__, option);
+            ret = EXIT_FAILURE;
+        }
+        if (ret != EXIT_SUCCESS) {
+            fprintf(stderr, "%s: Invalid %s value \"%s\"\n", __func__, option, token);
+            break;
+        }
+    }
+    free(values);
+    return ret;
+}
+
+/**
+ * check if a named netns is in the config ownership scope.
+ * @param [in] nsname netns name.
+ * @return true if the netns is loaded and monitored.
+ */
+static bool config_netns_owned(const char *nsname)
+{
+    if (config_scope.n_netns == 0)
+        return true;
+    for (int i = 0; i < config_scope.n_netns; i++) {
+        if (config_scope.netns[i] && !strcmp(config_scope.netns[i], nsname))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * check if a route or link netlink message is in the config ownership scope, the other messages
+ * are always owned.
+ * @param [in] n netlink message.
+ * @return true if the message object is represented in the running datastore.
+ */
+static bool config_msg_owned(struct nlmsghdr *n)
+{
+    if ((n->nlmsg_type == RTM_NEWROUTE || n->nlmsg_type == RTM_DELROUTE) &&
+        (config_scope.n_protocols || config_scope.n_tables) &&
+        n->nlmsg_len >= NLMSG_LENGTH(sizeof(struct rtmsg))) {
+        struct rtmsg *r = NLMSG_DATA(n);
+        struct rtattr *tb[RTA_MAX + 1];
+        bool owned = config_scope.n_protocols == 0;
+
+        for (int i = 0; i < config_scope.n_protocols && !owned; i++)
+            owned = r->rtm_protocol == config_scope.protocols[i];
+        if (!owned || config_scope.n_tables == 0)
+            return owned;
+        parse_rtattr(tb, RTA_MAX, RTM_RTA(r), n->nlmsg_len - NLMSG_LENGTH(sizeof(*r)));
+        __u32 table = rtm_get_table(r, tb);
+        for (int i = 0; i < config_scope.n_tables; i++) {
+            if (table >= config_scope.tables[i].first && table <= config_scope.tables[i].last)
+                return true;
+        }
+        return false;
+    } else if ((n->nlmsg_type == RTM_NEWLINK || n->nlmsg_type == RTM_DELLINK) &&
+               config_scope.n_kinds && n->nlmsg_len >= NLMSG_LENGTH(sizeof(struct ifinfomsg))) {
+        struct ifinfomsg *ifi = NLMSG_DATA(n);
+        struct rtattr *tb[IFLA_MAX + 1], *linkinfo[IFLA_INFO_MAX + 1];
+        const char *kind = "";
+
+        parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), IFLA_PAYLOAD(n));
+        if (tb[IFLA_LINKINFO]) {
+            parse_rtattr_nested(linkinfo, IFLA_INFO_MAX, tb[IFLA_LINKINFO]);
+            if (linkinfo[IFLA_INFO_KIND])
+                kind = rta_getattr_str(linkinfo[IFLA_INFO_KIND]);
+        }
+        for (int i = 0; i < config_scope.n_kinds; i++) {
+            if (config_scope.kinds[i] && !strcmp(config_scope.kinds[i], kind))
+                return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+/* netlink dump exclusion of the command being executed, see apply_ipr2_cmd_filtered() */
+struct dump_exclusion {
+    bool group_by_family;
+    bool owned_only;
+    int n_values;
+    struct {
+        dump_filter_attr_t attr;
+        __u32 id; /* table, protocol or type id */
+        const char *kind;
+    } values[DUMP_FILTER_MAX_VALUES];
+};
+static __thread const struct dump_exclusion *cur_dump_exclusion;
+
+struct dump_exclusion_arg {
+    rtnl_filter_t filter;
+    void *arg;
+    int family; /* family of the open rows group, -1 if none */
+};
+
+/**
+ * check if a dumped netlink message matches one of the current dump excluded values.
+ * @param [in] n netlink message.
+ * @return true if the message is to be dropped.
+ */
+static bool dump_msg_excluded(struct nlmsghdr *n)
+{
+    const struct dump_exclusion *exclusion = cur_dump_exclusion;
+
+    if (exclusion->owned_only && !config_msg_owned(n))
+        return true;
+    if (n->nlmsg_type == RTM_NEWROUTE && n->nlmsg_len >= NLMSG_LENGTH(sizeof(struct rtmsg))) {
+        struct rtmsg *r = NLMSG_DATA(n);
+        struct rtattr *tb[RTA_MAX + 1];
+
+        parse_rtattr(tb, RTA_MAX, RTM_RTA(r), n->nlmsg_len - NLMSG_LENGTH(sizeof(*r)));
+        __u32 table = rtm_get_table(r, tb);
+        for (int i = 0; i < exclusion->n_values; i++) {
+            __u32 id = exclusion->values[i].id;
+            if ((exclusion->values[i].attr == DUMP_FILTER_TABLE && table == id) ||
+                (exclusion->values[i].attr == DUMP_FILTER_PROTOCOL && r->rtm_protocol == id) ||
+                (exclusion->values[i].attr == DUMP_FILTER_TYPE && r->rtm_type == id))
+                return true;
+        }
+    } else if (n->nlmsg_type == RTM_NEWLINK &&
+               n->nlmsg_len >= NLMSG_LENGTH(sizeof(struct ifinfomsg))) {
+        struct ifinfomsg *ifi = NLMSG_DATA(n);
+        struct rtattr *tb[IFLA_MAX + 1], *linkinfo[IFLA_INFO_MAX + 1];
+
+        parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), IFLA_PAYLOAD(n));
+        if (!tb[IFLA_LINKINFO])
+            return false;
+        parse_rtattr_nested(linkinfo, IFLA_INFO_MAX, tb[IFLA_LINKINFO]);
+        if (!linkinfo[IFLA_INFO_KIND])
+            return false;
+        const char *kind = rta_getattr_str(linkinfo[IFLA_INFO_KIND]);
+        for (int i = 0; i < exclusion->n_values; i++) {
+            if (exclusion->values[i].attr == DUMP_FILTER_KIND &&
+                !strcmp(exclusion->values[i].kind, kind))
+                return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * close the open rows group of a family grouped dump.
+ * @param [in,out] exclusion_arg dump filter argument.
+ */
+static void close_family_group(struct dump_exclusion_arg *exclusion_arg)
+{
+    if (exclusion_arg->family < 0)
+        return;
+    close_json_array(PRINT_JSON, NULL);
+    close_json_object();
+    exclusion_arg->family = -1;
+}
+
+static int filter_excluded_msg(struct nlmsghdr *n, void *arg)
+{
+    struct dump_exclusion_arg *exclusion_arg = arg;
+
+    if (dump_msg_excluded(n))
+        return 0;
+    if (cur_dump_exclusion->group_by_family &&
+        n->nlmsg_len >= NLMSG_LENGTH(sizeof(struct rtgenmsg))) {
+        /* an AF_UNSPEC dump returns the families one after the other, group rows on change */
+        int family = ((struct rtgenmsg *)NLMSG_DATA(n))->rtgen_family;
+        if (family != exclusion_arg->family) {
+            close_family_group(exclusion_arg);
+            open_json_object(NULL);
+            print_string(PRINT_JSON, "family", NULL, family_name(family));
+            open_json_array(PRINT_JSON, "rows");
+            exclusion_arg->family = family;
+        }
+    }
+    return exclusion_arg->filter(n, exclusion_arg->arg);
+}
+
+/*
+ * iproute2 dumps go through rtnl_dump_filter_nc(), the binary is linked with
+ * --wrap=rtnl_dump_filter_nc so excluded messages are dropped before iproute2 stores or prints
+ * them.
+ */
+int __real_rtnl_dump_filter_nc(struct rtnl_handle *rth, rtnl_filter_t filter, void *arg,
+                               __u16 nc_flags);
+
+int __wrap_rtnl_dump_filter_nc(struct rtnl_handle *rth, rtnl_filter_t filter, void *arg,
+                               __u16 nc_flags)
+{
+    struct dump_exclusion_arg exclusion_arg = { filter, arg, -1 };
+    int ret;
+
+    if (cur_dump_exclusion == NULL)
+        return __real_rtnl_dump_filter_nc(rth, filter, arg, nc_flags);
+    ret = __real_rtnl_dump_filter_nc(rth, filter_excluded_msg, &exclusion_arg, nc_flags);
+    close_family_group(&exclusion_arg);
+    return ret;
+}
+
+/**
+ * convert a dump filter excluded value names to the netlink message attribute values.
+ * @param [in] filter dump filter, unknown excluded value names are ignored.
+ * @param [out] exclusion converted dump exclusion.
+ * @return true if the dump needs to go through the exclusion filter.
+ */
+static bool build_dump_exclusion(const struct dump_filter *filter, struct dump_exclusion *exclusion)
+{
+    const struct dump_filter_value *excluded = filter->excluded;
+
+    memset(exclusion, 0, sizeof(*exclusion));
+    exclusion->group_by_family = filter->group_by_family;
+    exclusion->owned_only = filter->owned_only;
+    for (int i = 0; i < filter->n_excluded && i < DUMP_FILTER_MAX_VALUES; i++) {
+        int type;
+
+        exclusion->values[exclusion->n_values].attr = excluded[i].attr;
+        switch (excluded[i].attr) {
+        case DUMP_FILTER_TABLE:
+            if (rtnl_rttable_a2n(&exclusion->values[exclusion->n_values].id, excluded[i].value))
+                continue;
+            break;
+        case DUMP_FILTER_PROTOCOL:
+            if (rtnl_rtprot_a2n(&exclusion->values[exclusion->n_values].id, excluded[i].value))
+                continue;
+            break;
+        case DUMP_FILTER_TYPE:
+            if (rtnl_rtntype_a2n(&type, (char *)excluded[i].value))
+                continue;
+            exclusion->values[exclusion->n_values].id = type;
+            break;
+        case DUMP_FILTER_KIND:
+            exclusion->values[exclusion->n_values].kind = excluded[i].value;
+            break;
+        }
+        exclusion->n_values++;
+    }
+    return exclusion->n_values || exclusion->group_by_family || exclusion->owned_only;
+}
+
+/**
+ * apply an iproute2 show command, dropping the dumped messages matching the excluded values.
+ * netlink dump requests can only select a single attribute value, so the exclusions are applied
+ * on the received messages, before iproute2 decodes and prints them.
+ * With group_by_family, the printed rows are grouped in {"family": name, "rows": [...]} objects,
+ * so one AF_UNSPEC dump can feed the lists of several address families.
+ * @param [in] ipr2_show_cmd iproute2 show command.
+ * @param [in] filter dump filter, unknown excluded value names are ignored.
+ * @return SR_ERR_OK on success, SR_ERR_CALLBACK_FAILED on failure.
+ */
+int apply_ipr2_cmd_filtered(char *ipr2_show_cmd, const struct dump_filter *filter)
+{
+    struct dump_exclusion exclusion;
+    int ret;
+
+    cur_dump_exclusion = build_dump_exclusion(filter, &exclusion) ? &exclusion : NULL;
+    ret = apply_ipr2_cmd(ipr2_show_cmd);
+    cur_dump_exclusion = NULL;
+    return ret;
+}
+
+/**
+ * send the dump request of one rtnetlink object type, the route and nexthop dumps need their own
+ * request header as the kernel strictly checks them.
+ * @param [in] dump_rth rtnl handle of the dump netns.
+ * @param [in] dump_type RTM_GET* dump request type.
+ * @return the send result, negative on failure.
+ */
+static int send_dump_request(struct rtnl_handle *dump_rth, int dump_type)
+{
+    switch (dump_type) {
+    case RTM_GETROUTE:
+        return rtnl_routedump_req(dump_rth, AF_UNSPEC, NULL);
+    case RTM_GETNEXTHOP:
+        return rtnl_nexthopdump_req(dump_rth, AF_UNSPEC, NULL);
+    default:
+        return rtnl_wilddump_request(dump_rth, AF_UNSPEC, dump_type);
+    }
+}
+
+/**
+ * dump rtnetlink objects of several types back to back on the cached rtnl socket of the requested
+ * netns, passing the raw messages to a decoder instead of the iproute2 printers.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [in] filter dump filter applied on the messages before msg_cb, NULL for none.
+ * @param [in] dump_types RTM_GET* dump request types.
+ * @param [in] n_types number of dump request types.
+ * @param [in] msg_cb called for each dumped message.
+ * @param [in] cb_arg msg_cb argument.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if a dump failed.
+ */
+int dump_rtnl_objects(const char *netns, const struct dump_filter *filter, const int *dump_types,
+                      int n_types, rtnl_filter_t msg_cb, void *cb_arg)
+{
+    struct dump_exclusion exclusion;
+    struct rtnl_handle *dump_rth = netns_cache_rth(netns);
+    int ret = EXIT_SUCCESS;
+
+    if (dump_rth == NULL)
+        return EXIT_FAILURE;
+
+    if (filter && build_dump_exclusion(filter, &exclusion))
+        cur_dump_exclusion = &exclusion;
+    for (int i = 0; i < n_types; i++) {
+        if (send_dump_request(dump_rth, dump_types[i]) < 0) {
+            fprintf(stderr, "%s: Cannot send dump request: %s\n", __func__, strerror(errno));
+            ret = EXIT_FAILURE;
+            break;
+        }
+        if (rtnl_dump_filter(dump_rth, msg_cb, cb_arg) < 0) {
+            fprintf(stderr, "%s: Dump terminated\n", __func__);
+            ret = EXIT_FAILURE;
+            break;
+        }
+    }
+    cur_dump_exclusion = NULL;
+
+    // a failed dump might leave replies unread, the handle is reopened on next use.
+    netns_cache_put(dump_rth, ret != EXIT_SUCCESS);
+    return ret;
+}
+
+/**
+ * the kernel reports the chain and priority head of each filter before its rules, the head has
+ * no handle and holds no rule, skip it so every dumped row is a filter rule.
+ */
+static int print_tc_filter_rule(struct nlmsghdr *n, void *arg)
+{
+    struct tcmsg *t = NLMSG_DATA(n);
+
+    if (n->nlmsg_len < NLMSG_LENGTH(sizeof(*t)) || t->tcm_handle == 0)
+        return 0;
+    return print_filter(n, arg);
+}
+
+/**
+ * dump tc filters or classes of several devices and shared blocks, the dumps are done back to back
+ * on the cached rtnl socket of the requested netns, instead of one iproute2 command each.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [in] reqs dump requests.
+ * @param [in] n_reqs number of dump requests.
+ * @param [in] dump_cb called with json_buffer holding the dumped objects of each request.
+ * @param [in] cb_arg dump_cb argument.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if a dump or a callback failed.
+ */
+int dump_tc_objects(const char *netns, const struct tc_dump_req *reqs, int n_reqs,
+                    tc_dump_cb_t dump_cb, void *cb_arg)
+{
+    struct {
+        struct nlmsghdr n;
+        struct tcmsg t;
+    } req;
+    struct rtnl_handle *dump_rth = netns_cache_rth(netns);
+    int ret = EXIT_SUCCESS, dump_ret = 0;
+
+    if (dump_rth == NULL)
+        return EXIT_FAILURE;
+
+    for (int i = 0; i < n_reqs; i++) {
+        memset(&req, 0, sizeof(req));
+        req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct tcmsg));
+        req.n.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+        req.n.nlmsg_type = reqs[i].type == TC_DUMP_FILTERS ? RTM_GETTFILTER : RTM_GETTCLASS;
+        req.t.tcm_family = AF_UNSPEC;
+
+        if (reqs[i].dev) {
+            /* resolved in the dump netns, the iproute2 link cache is not netns aware */
+            req.t.tcm_ifindex = if_nametoindex(reqs[i].dev);
+            if (req.t.tcm_ifindex == 0) {
+                fprintf(stderr, "%s: Cannot find device \"%s\"\n", __func__, reqs[i].dev);
+                ret = EXIT_FAILURE;
+                continue;
+            }
+        } else {
+            if (get_u32(&req.t.tcm_block_index, reqs[i].block, 0)) {
+                fprintf(stderr, "%s: Invalid block index \"%s\"\n", __func__, reqs[i].block);
+                ret = EXIT_FAILURE;
+                continue;
+            }
+            req.t.tcm_ifindex = TCM_IFINDEX_MAGIC_BLOCK;
+        }
+        if (reqs[i].direction && !strcmp(reqs[i].direction, "ingress"))
+            req.t.tcm_parent = TC_H_MAKE(TC_H_CLSACT, TC_H_MIN_INGRESS);
+        else if (reqs[i].direction && !strcmp(reqs[i].direction, "egress"))
+            req.t.tcm_parent = TC_H_MAKE(TC_H_CLSACT, TC_H_MIN_EGRESS);
+
+        if (rtnl_dump_request_n(dump_rth, &req.n) < 0) {
+            fprintf(stderr, "%s: Cannot send dump request: %s\n", __func__, strerror(errno));
+            dump_ret = -1;
+            ret = EXIT_FAILURE;
+            break;
+        }
+        /* every request output is a json array of its own in json_buffer */
+        new_json_obj(json);
+        dump_ret = rtnl_dump_filter(
+            dump_rth, reqs[i].type == TC_DUMP_FILTERS ? print_tc_filter_rule : print_class, stdout);
+        delete_json_obj();
+        if (dump_ret < 0) {
+            fprintf(stderr, "%s: Dump terminated\n", __func__);
+            ret = EXIT_FAILURE;
+            break;
+        }
+        if (dump_cb(&reqs[i], cb_arg) != EXIT_SUCCESS)
+            ret = EXIT_FAILURE;
+    }
+
+    // a failed dump might leave replies unread, the handle is reopened on next use.
+    netns_cache_put(dump_rth, dump_ret < 0);
+    return ret;
+}
+
 int ipr2_oper_get_items_cb(sr_session_ctx_t *session, uint32_t sub_id, const char *module_name,
                            const char *xpath, const char *request_xpath, uint32_t request_id,
                            struct lyd_node **parent, void *private_data)
@@ -687,6 +1496,8 @@ struct load_linux_runcfg_arg {
 int load_linux_runcfg_ns_cb(char *nsname, void *arg)
 {
     struct load_linux_runcfg_arg *runcfg_arg = (struct load_linux_runcfg_arg *)arg;
+    if (!config_netns_owned(nsname))
+        return 0;
     load_module_data(sr_session, runcfg_arg->module_name, LYS_CONFIG_W, runcfg_arg->root_node,
                      nsname);
     return 0;
@@ -781,6 +1592,10 @@ static int accept_msg2(struct rtnl_ctrl_data *ctrl, struct nlmsghdr *n, void *ar
     int ret;
     struct lyd_node *root_node = NULL;
 
+    /* changes of objects outside the config ownership scope leave running unchanged */
+    if (!config_msg_owned(n))
+        return 0;
+
     sr_session_ctx_t *sr_session2;
     sr_acquire_context(sr_connection);
 
@@ -896,6 +1711,8 @@ void *do_monitor2_thd(void *args)
 int load_linux_confg_monitor_ns_cb(char *nsname, void *arg)
 {
     pthread_t thread;
+    if (!config_netns_owned(nsname))
+        return 0;
     if (pthread_create(&thread, NULL, do_monitor2_thd, nsname) != 0) {
         fprintf(stderr, "Error creating thread\n");
     }
@@ -963,14 +1780,34 @@ int main(int argc, char **argv)
     int ret;
     int monitor = 1;
     tc_core_init(); /* to initilize tick_in_usec needed by tc*/
-    if (argc <= 2) {
-        if (argc == 2) {
-            if (!strcmp(argv[1], "--no-monitor")) {
+    if (argc <= 2 || !strncmp(argv[1], "--", 2)) {
+        for (int i = 1; i < argc; i++) {
+            if (!strcmp(argv[i], "--no-monitor")) {
                 monitor = 0;
-            } else if (!strcmp(argv[1], "help")) {
+            } else if (!strcmp(argv[i], "--oper-json")) {
+                set_oper_data_backend(OPER_DATA_BACKEND_JSON);
+            } else if (!strcmp(argv[i], "--oper-netlink") && i + 1 < argc) {
+                char *saveptr = NULL;
+                for (char *module = strtok_r(argv[++i], ",", &saveptr); module;
+                     module = strtok_r(NULL, ",", &saveptr)) {
+                    if (set_oper_data_source(module, OPER_DATA_SOURCE_NETLINK) != EXIT_SUCCESS)
+                        return EXIT_FAILURE;
+                }
+            } else if (!strcmp(argv[i], "--config-netlink") && i + 1 < argc) {
+                char *saveptr = NULL;
+                for (char *module = strtok_r(argv[++i], ",", &saveptr); module;
+                     module = strtok_r(NULL, ",", &saveptr)) {
+                    if (set_nl_encoder(module, true) != EXIT_SUCCESS)
+                        return EXIT_FAILURE;
+                }
+            } else if (!strncmp(argv[i], "--own-", strlen("--own-")) && i + 1 < argc) {
+                if (parse_config_scope(argv[i], argv[i + 1]) != EXIT_SUCCESS)
+                    return EXIT_FAILURE;
+                i++;
+            } else if (!strcmp(argv[i], "help")) {
                 usage();
             } else {
-                fprintf(stderr, "Unknown argument \"%s\"\n", argv[1]);
+                fprintf(stderr, "Unknown argument \"%s\"\n", argv[i]);
                 return EXIT_FAILURE;
             }
         }
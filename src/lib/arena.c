@@ -0,0 +1,134 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+/*
+ * Authors:     Ali Aqrabawi, <aaqrbaw@okdanetworks.com>
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU Affero General Public
+ *              License Version 3.0 as published by the Free Software Foundation;
+ *              either version 3.0 of the License, or (at your option) any later
+ *              version.
+ *
+ * Copyright (C) 2024 Okda Networks, <aaqrbaw@okdanetworks.com>
+ */
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#define ARENA_ALIGN alignof(max_align_t)
+
+/**
+ * @brief arena memory block, the allocations follow the header.
+ */
+struct arena_block {
+    struct arena_block *next;
+    size_t size; /* usable bytes after the header */
+    size_t used;
+    max_align_t data[];
+};
+
+/**
+ * allocate a new current block for an arena.
+ * @param [in,out] arena arena.
+ * @param [in] min_size minimum usable size, blocks larger than the default are used for large
+ * allocations.
+ * @return new block, NULL on failure.
+ */
+static struct arena_block *arena_new_block(struct arena *arena, size_t min_size)
+{
+    size_t size = min_size > ARENA_BLOCK_SIZE ? min_size : ARENA_BLOCK_SIZE;
+    struct arena_block *block = malloc(sizeof(*block) + size);
+
+    if (block == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+    block->size = size;
+    block->used = 0;
+    block->next = arena->blocks;
+    arena->blocks = block;
+    return block;
+}
+
+void *arena_alloc(struct arena *arena, size_t size)
+{
+    struct arena_block *block = arena->blocks;
+    size_t aligned = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    void *ptr;
+
+    if (aligned < size)
+        return NULL;
+    if (block == NULL || block->size - block->used < aligned) {
+        block = arena_new_block(arena, aligned);
+        if (block == NULL)
+            return NULL;
+    }
+    ptr = (char *)block->data + block->used;
+    block->used += aligned;
+    return ptr;
+}
+
+void *arena_calloc(struct arena *arena, size_t size)
+{
+    void *ptr = arena_alloc(arena, size);
+
+    if (ptr != NULL)
+        memset(ptr, 0, size);
+    return ptr;
+}
+
+char *arena_strndup(struct arena *arena, const char *str, size_t len)
+{
+    char *copy;
+
+    len = strnlen(str, len);
+    copy = arena_alloc(arena, len + 1);
+    if (copy == NULL)
+        return NULL;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+char *arena_strdup(struct arena *arena, const char *str)
+{
+    return arena_strndup(arena, str, strlen(str));
+}
+
+void arena_release(struct arena *arena)
+{
+    struct arena_block *block = arena->blocks;
+
+    if (block == NULL)
+        return;
+    // keep the oldest default sized block, the next operation reuses it without a malloc.
+    while (block->next != NULL) {
+        struct arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    if (block->size != ARENA_BLOCK_SIZE) {
+        free(block);
+        arena->blocks = NULL;
+        return;
+    }
+    block->used = 0;
+    arena->blocks = block;
+}
+
+void arena_free(struct arena *arena)
+{
+    struct arena_block *block = arena->blocks;
+
+    while (block != NULL) {
+        struct arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+#ifndef IPROUTE2_SYSREPO_ARENA_H
+#define IPROUTE2_SYSREPO_ARENA_H
+
+#include <stddef.h>
+
+struct arena_block;
+
+/**
+ * @brief bump allocator for the transient data of one operation, a config change callback or an
+ * oper data load. The allocations are not freed one by one, they are all released together by
+ * arena_release(). A zero initialized arena is empty and ready for use.
+ */
+struct arena {
+    struct arena_block *blocks; /* current block first */
+};
+
+/**
+ * allocate memory from an arena, aligned for any type.
+ * @param [in,out] arena arena.
+ * @param [in] size allocation size.
+ * @return allocated memory, NULL on failure.
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * allocate zeroed memory from an arena.
+ * @param [in,out] arena arena.
+ * @param [in] size allocation size.
+ * @return allocated memory, NULL on failure.
+ */
+void *arena_calloc(struct arena *arena, size_t size);
+
+/**
+ * copy the first bytes of a string to an arena.
+ * @param [in,out] arena arena.
+ * @param [in] str string to copy.
+ * @param [in] len maximum number of bytes copied, the copy is NUL terminated.
+ * @return string copy, NULL on failure.
+ */
+char *arena_strndup(struct arena *arena, const char *str, size_t len);
+
+/**
+ * copy a string to an arena.
+ * @param [in,out] arena arena.
+ * @param [in] str string to copy.
+ * @return string copy, NULL on failure.
+ */
+char *arena_strdup(struct arena *arena, const char *str);
+
+/**
+ * release all the allocations of an arena. The first block is kept for the next operation, the
+ * arena is empty and ready for use.
+ * @param [in,out] arena arena.
+ */
+void arena_release(struct arena *arena);
+
+/**
+ * free all the blocks of an arena, for an arena not used anymore. The arena is left empty.
+ * @param [in,out] arena arena.
+ */
+void arena_free(struct arena *arena);
+
+#endif // IPROUTE2_SYSREPO_ARENA_H
@@ -12,17 +12,27 @@
  */
 
 #include <ctype.h>
+#ifdef CMDGEN_SORT_TIMING
+#include <time.h>
+#endif
 
+#include "json-c/linkhash.h"
+#include "arena.h"
 #include "cmdgen.h"
+#include "nl_encoder.h"
 
 extern sr_session_ctx_t *sr_session;
 
+/* transient data of the transaction being generated by lyd2cmds(): extension values, argument
+ * names, startcmd infos. released in one shot once the commands are generated. */
+static struct arena cmdgen_arena;
+
 /**
  * @brief data struct to store start_cmd meta data.
  *
  */
 struct startcmd_info {
-    int processed;
+    uint32_t idx; /* index of the startcmd in the transaction startcmds set */
 };
 
 /**
@@ -99,23 +109,6 @@ char *yang_ext_map[] = { [CMD_START_EXT] = "cmd-start",
                          [INCLUDE_ALL_ON_DELETE] = "include-all-on-delete",
                          [NOT_DEPENDENCY_EXT] = "not-dependency" };
 
-void dup_argv(char ***dest, char **src, int argc)
-{
-    *dest = (char **)malloc((argc + 1) * sizeof(char *));
-    if (*dest == NULL) {
-        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
-        exit(EXIT_FAILURE);
-    }
-    for (int i = 0; i < argc; i++) {
-        (*dest)[i] = strdup(src[i]);
-        if ((*dest)[i] == NULL) {
-            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
-            exit(EXIT_FAILURE);
-        }
-    }
-    (*dest)[argc] = NULL; // NULL terminator
-}
-
 void free_argv(char **argv, int argc)
 {
     // Free memory for each string
@@ -129,27 +122,206 @@ void free_argv(char **argv, int argc)
 
 void free_cmds_info(struct cmd_info **cmds_info)
 {
-    // Free the memory allocated for cmds
-    for (int i = 0; i < CMDS_ARRAY_SIZE; i++) {
-        if (cmds_info[i] != NULL) {
-            // Free the argv array for cmd_args[i]
-            for (int j = 0; j < cmds_info[i]->argc; j++) {
-                free(cmds_info[i]->argv[j]);
-            }
-            for (int j = 0; j < cmds_info[i]->rollback_argc; j++) {
-                free(cmds_info[i]->rollback_argv[j]);
-            }
-            // Free the argv array itself
-            free(cmds_info[i]->argv);
-            free(cmds_info[i]->rollback_argv);
-            // Free the cmd_args struct itself
-            free(cmds_info[i]);
+    // Free the memory allocated for cmds, up to the NULL terminator.
+    for (int i = 0; cmds_info[i] != NULL; i++) {
+        // Free the argv array for cmd_args[i]
+        for (int j = 0; j < cmds_info[i]->argc; j++) {
+            free(cmds_info[i]->argv[j]);
+        }
+        for (int j = 0; j < cmds_info[i]->rollback_argc; j++) {
+            free(cmds_info[i]->rollback_argv[j]);
         }
+        // Free the argv array itself
+        free(cmds_info[i]->argv);
+        free(cmds_info[i]->rollback_argv);
+        free_nl_request(cmds_info[i]->nl_req);
+        free_nl_request(cmds_info[i]->rollback_nl_req);
+        // Free the cmd_args struct itself
+        free(cmds_info[i]);
     }
     // Free the cmds array itself
     free(cmds_info);
 }
 
+/**
+ * @brief length tracking command line builder, appends never truncate the line.
+ */
+struct cmd_buf {
+    char *str;
+    size_t len;
+    size_t size;
+    int failed; /* an allocation failed, the line is incomplete */
+};
+
+/**
+ * insert a string in a command line builder, the buffer grows as needed.
+ * @param [in,out] buf command line builder, zero initialized before the first use.
+ * @param [in] pos insert position, up to buf->len.
+ * @param [in] str string to insert.
+ */
+static void cmd_buf_insert(struct cmd_buf *buf, size_t pos, const char *str)
+{
+    size_t str_len = strlen(str);
+
+    if (buf->failed)
+        return;
+    if (buf->len + str_len + 1 > buf->size) {
+        size_t size = buf->size ? buf->size : 128;
+        char *grown;
+
+        while (buf->len + str_len + 1 > size)
+            size *= 2;
+        grown = realloc(buf->str, size);
+        if (grown == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            buf->failed = 1;
+            return;
+        }
+        buf->str = grown;
+        buf->size = size;
+    }
+    memmove(buf->str + pos + str_len, buf->str + pos, buf->len - pos);
+    memcpy(buf->str + pos, str, str_len);
+    buf->len += str_len;
+    buf->str[buf->len] = '\0';
+}
+
+/**
+ * append a string to a command line builder.
+ * @param [in,out] buf command line builder.
+ * @param [in] str string to append.
+ */
+static void cmd_buf_append(struct cmd_buf *buf, const char *str)
+{
+    cmd_buf_insert(buf, buf->len, str);
+}
+
+/**
+ * take the built command line out of the builder.
+ * @param [in,out] buf command line builder, reset.
+ * @return command line, "" if nothing was appended, NULL if an allocation failed.
+ */
+static char *cmd_buf_release(struct cmd_buf *buf)
+{
+    char *str = buf->str;
+
+    if (buf->failed) {
+        free(str);
+        str = NULL;
+    } else if (str == NULL) {
+        str = strdup("");
+    }
+    *buf = (struct cmd_buf){ 0 };
+    return str;
+}
+
+/**
+ * @brief iproute2 command argument vector, each data value is kept as one argument.
+ */
+struct cmd_args {
+    char **argv; /* always NULL terminated once allocated */
+    int argc;
+    int size; /* allocated slots, the terminator included */
+    int failed; /* an allocation failed, the command is incomplete */
+};
+
+/**
+ * insert an argument in a command argument vector, the vector grows as needed.
+ * @param [in,out] args argument vector, zero initialized before the first use.
+ * @param [in] pos insert position, up to args->argc.
+ * @param [in] arg argument to insert, copied.
+ */
+static void cmd_args_insert(struct cmd_args *args, int pos, const char *arg)
+{
+    char *copy;
+
+    if (args->failed)
+        return;
+    if (args->argc + 2 > args->size) {
+        int size = args->size ? 2 * args->size : 16;
+        char **grown = realloc(args->argv, size * sizeof(*grown));
+
+        if (grown == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            args->failed = 1;
+            return;
+        }
+        args->argv = grown;
+        args->size = size;
+    }
+    copy = strdup(arg);
+    if (copy == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        args->failed = 1;
+        return;
+    }
+    memmove(args->argv + pos + 1, args->argv + pos, (args->argc - pos) * sizeof(char *));
+    args->argv[pos] = copy;
+    args->argv[++args->argc] = NULL;
+}
+
+/**
+ * append one argument to a command argument vector, spaces in the argument are kept.
+ * @param [in,out] args argument vector.
+ * @param [in] arg argument to append, a data node value for example.
+ */
+static void cmd_args_push(struct cmd_args *args, const char *arg)
+{
+    cmd_args_insert(args, args->argc, arg);
+}
+
+/**
+ * append the space separated words of an extension argument, for example "ip link add" or
+ * "type vxlan", as separate arguments.
+ * @param [in,out] args argument vector.
+ * @param [in] words extension argument.
+ */
+static void cmd_args_push_words(struct cmd_args *args, const char *words)
+{
+    char word[CMD_LINE_SIZE];
+
+    while (*words != '\0') {
+        size_t len = strcspn(words, " ");
+
+        if (len > 0) {
+            if (len >= sizeof(word)) {
+                fprintf(stderr, "%s: argument \"%.*s\" is too long\n", __func__, (int)len, words);
+                args->failed = 1;
+                return;
+            }
+            memcpy(word, words, len);
+            word[len] = '\0';
+            cmd_args_push(args, word);
+        }
+        words += len;
+        words += strspn(words, " ");
+    }
+}
+
+/**
+ * move all the arguments of a vector to the end of another one.
+ * @param [in,out] args argument vector.
+ * @param [in,out] tail moved arguments, reset.
+ */
+static void cmd_args_move(struct cmd_args *args, struct cmd_args *tail)
+{
+    for (int i = 0; i < tail->argc; i++)
+        cmd_args_push(args, tail->argv[i]);
+    args->failed |= tail->failed;
+    free_argv(tail->argv, tail->argc);
+    *tail = (struct cmd_args){ 0 };
+}
+
+/**
+ * free the arguments of a command argument vector and reset it.
+ * @param [in,out] args argument vector.
+ */
+static void cmd_args_free(struct cmd_args *args)
+{
+    free_argv(args->argv, args->argc);
+    *args = (struct cmd_args){ 0 };
+}
+
 void insert_netns(char *cmd, const char *netns)
 {
     char to_insert[100]; // Buffer to hold the "-n name" string
@@ -199,28 +371,19 @@ void extract_static_and_xpath_args(char *input, char **static_arg, char **xpath_
         size_t first_len = start - input;
         size_t second_len = end - start - 1;
 
-        *static_arg = malloc(first_len + 1);
-        *xpath_arg = malloc(second_len + 1);
+        *static_arg = arena_strndup(&cmdgen_arena, input, first_len);
+        *xpath_arg = arena_strndup(&cmdgen_arena, start + 1, second_len);
         if (*static_arg == NULL || *xpath_arg == NULL) {
             printf("Memory allocation failed\n");
             exit(1);
         }
-
-        strncpy(*static_arg, input, first_len);
-        (*static_arg)[first_len] = '\0';
-        strncpy(*xpath_arg, start + 1, second_len);
-        (*xpath_arg)[second_len] = '\0';
     } else {
         // If '(' and ')' are not found or '(' comes after ')', treat the whole string as the first part
-        size_t input_len = strlen(input);
-        *static_arg = malloc(input_len + 1);
+        *static_arg = arena_strdup(&cmdgen_arena, input);
         if (*static_arg == NULL) {
             printf("Memory allocation failed\n");
             exit(1);
         }
-
-        strncpy(*static_arg, input, input_len);
-        (*static_arg)[input_len] = '\0';
         *xpath_arg = NULL; // No second part
     }
 }
@@ -228,7 +391,7 @@ void extract_static_and_xpath_args(char *input, char **static_arg, char **xpath_
 /**
  * if input is "iproute2-ip-link:dummy" it return "dummy"
  * @param [in] input string to be stripped.
- * @return the extracted string
+ * @return the extracted string, allocated from the transaction arena
  */
 char *strip_yang_iden_prefix(const char *input)
 {
@@ -237,16 +400,13 @@ char *strip_yang_iden_prefix(const char *input)
         // Calculate the length of the substring after the colon
         size_t len = strlen(colon_pos + 1);
 
-        // Allocate memory for output string
-        char *output = malloc(len + 1);
+        // Copy the substring after the colon.
+        char *output = arena_strndup(&cmdgen_arena, colon_pos + 1, len);
         if (output == NULL) {
             fprintf(stderr, "%s: Memory allocation failed\n", __func__);
             exit(EXIT_FAILURE);
         }
 
-        // Copy the substring after the colon.
-        strlcpy(output, colon_pos + 1, len + 1);
-
         // Remove leading and trailing whitespace
         char *end = output + len - 1;
         while (end > output && isspace((unsigned char)*end)) {
@@ -258,7 +418,7 @@ char *strip_yang_iden_prefix(const char *input)
         return output;
     } else {
         // No colon found, return the original string
-        return strdup(input);
+        return arena_strdup(&cmdgen_arena, input);
     }
 }
 
@@ -289,7 +449,7 @@ oper_t get_operation(const struct lyd_node *dnode)
  * get the extension from lyd_node,
  * @param [in] ex_t extension_t to be captured from lyd_node.
  * @param [in] dnode lyd_node where to search for provided ext.
- * @param [out] value extension value if found. can be null.
+ * @param [out] value extension value if found, allocated from the transaction arena. can be null.
  * @return EXIT_SUCCESS if ext found, EXIT_FAILURE if not found
  */
 int get_extension(extension_t ex_t, const struct lyd_node *dnode, char **value)
@@ -303,7 +463,7 @@ int get_extension(extension_t ex_t, const struct lyd_node *dnode, char **value)
     {
         if (!strcmp(ys_extenstions[i].def->name, yang_ext_map[ex_t])) {
             if (value != NULL)
-                *value = strdup(ys_extenstions[i].argument);
+                *value = arena_strdup(&cmdgen_arena, ys_extenstions[i].argument);
             return EXIT_SUCCESS;
         }
     }
@@ -322,8 +482,12 @@ struct startcmd_info *get_startcmd_info(struct lyd_node *startcmd)
 
 void initialize_startcmdinfo(struct lyd_node *startcmd)
 {
-    struct startcmd_info *sdnode_info = malloc(sizeof(struct startcmd_info));
-    sdnode_info->processed = 0;
+    struct startcmd_info *sdnode_info = arena_alloc(&cmdgen_arena, sizeof(struct startcmd_info));
+    if (sdnode_info == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        exit(EXIT_FAILURE);
+    }
+    sdnode_info->idx = UINT32_MAX;
     startcmd->priv = sdnode_info;
 }
 
@@ -340,38 +504,165 @@ int is_startcmd_node(struct lyd_node *dnode)
     return 0;
 }
 
+/* startcmd paths fetched from the running ds with one sr_get_data() xpath union. */
+#define RUNNING_FETCH_PATHS 64
+
+/**
+ * @brief running datastore data fetched for the transaction startcmds.
+ */
+struct running_snapshot {
+    sr_data_t **data; /* fetched data, released at the end of the transaction */
+    int n_data;
+    struct lh_table *trees; /* fetched data tree, by the fetched xpath */
+};
+
+static struct running_snapshot running_snapshot;
+
+static void running_path_entry_free(struct lh_entry *entry)
+{
+    free((char *)lh_entry_k(entry));
+}
+
 /**
- * get the target node from sysrepo running ds,
+ * release the running datastore data of the transaction.
+ */
+static void free_running_snapshots(void)
+{
+    for (int i = 0; i < running_snapshot.n_data; i++)
+        sr_release_data(running_snapshot.data[i]);
+    free(running_snapshot.data);
+    if (running_snapshot.trees)
+        lh_table_free(running_snapshot.trees);
+    running_snapshot = (struct running_snapshot){ 0 };
+}
+
+/**
+ * fetch data from the running datastore, the data is kept until the end of the transaction.
+ * @param [in] xpath xpath to fetch, can be a union of paths.
+ * @param [out] tree fetched data tree, NULL if the xpath has no running data.
+ * @return EXIT_SUCCESS, EXIT_FAILURE if the data could not be fetched.
+ */
+static int fetch_running_data(const char *xpath, struct lyd_node **tree)
+{
+    sr_data_t *sr_data = NULL, **grown;
+    int ret;
+
+    *tree = NULL;
+    if (running_snapshot.trees == NULL) {
+        running_snapshot.trees = lh_kchar_table_new(256, running_path_entry_free);
+        if (running_snapshot.trees == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return EXIT_FAILURE;
+        }
+    }
+    ret = sr_get_data(sr_session, xpath, 0, 0, 0, &sr_data);
+    if (ret != SR_ERR_OK && ret != SR_ERR_NOT_FOUND) {
+        fprintf(stderr, "%s: failed to get data from sysrepo ds. xpath = \"%s\": %s\n", __func__,
+                xpath, sr_strerror(ret));
+        return EXIT_FAILURE;
+    }
+    if (sr_data == NULL)
+        return EXIT_SUCCESS;
+    grown = realloc(running_snapshot.data, (running_snapshot.n_data + 1) * sizeof(*grown));
+    if (grown == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        sr_release_data(sr_data);
+        return EXIT_FAILURE;
+    }
+    running_snapshot.data = grown;
+    running_snapshot.data[running_snapshot.n_data++] = sr_data;
+    *tree = sr_data->tree;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * record the data tree fetched for an xpath, later lookups under the xpath use it.
+ * @param [in] xpath fetched xpath.
+ * @param [in] tree fetched data tree, can be NULL.
+ */
+static void add_running_tree(const char *xpath, struct lyd_node *tree)
+{
+    char *key = strdup(xpath);
+
+    if (key == NULL || lh_table_insert(running_snapshot.trees, key, tree)) {
+        // not fatal, the lookups under the xpath fetch it again.
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(key);
+    }
+}
+
+/**
+ * fetch the running datastore subtrees of the transaction startcmds, the startcmd paths are
+ * fetched with xpath unions of RUNNING_FETCH_PATHS paths, instead of one fetch per lookup.
+ * added startcmds are skipped, they have no running data.
+ * @param [in] startcmds startcmds of the transaction.
+ */
+static void fetch_startcmds_running_data(const struct ly_set *startcmds)
+{
+    char *paths[RUNNING_FETCH_PATHS];
+    struct cmd_buf xpath = { 0 };
+    struct lyd_node *tree;
+    uint32_t i = 0;
+
+    while (i < startcmds->count) {
+        int n_paths = 0;
+        char *union_xpath;
+
+        for (; i < startcmds->count && n_paths < RUNNING_FETCH_PATHS; i++) {
+            if (get_operation(startcmds->dnodes[i]) == ADD_OPR)
+                continue;
+            paths[n_paths] = lyd_path(startcmds->dnodes[i], LYD_PATH_STD, NULL, 0);
+            if (paths[n_paths] == NULL)
+                continue;
+            if (n_paths)
+                cmd_buf_append(&xpath, " | ");
+            cmd_buf_append(&xpath, paths[n_paths++]);
+        }
+        union_xpath = cmd_buf_release(&xpath);
+        // on failure the paths are left out of the index, their lookups fetch them one by one.
+        if (n_paths && union_xpath && fetch_running_data(union_xpath, &tree) == EXIT_SUCCESS) {
+            for (int p = 0; p < n_paths; p++)
+                add_running_tree(paths[p], tree);
+        }
+        for (int p = 0; p < n_paths; p++)
+            free(paths[p]);
+        free(union_xpath);
+    }
+}
+
+/**
+ * get the target node from the sysrepo running ds data of the transaction, the startcmd
+ * subtree is fetched on the first lookup if it was not fetched with the transaction startcmds.
  * @param  [in] startcmd_node start cmd_node,
  * @param  [in] node_name node name to be fetched from sr.
- * @return [out] lyd_node found.
+ * @return [out] lyd_node found, owned by the transaction data. NULL if not found.
  */
 struct lyd_node *get_node_from_sr(const struct lyd_node *startcmd_node, char *node_name)
 {
     char xpath[1024] = { 0 };
-    int ret;
+    struct lyd_node *running_tree = NULL, *found = NULL;
+    void *indexed = NULL;
+    bool fetched = false;
+
     lyd_path(startcmd_node, LYD_PATH_STD, xpath, 1024);
+    if (running_snapshot.trees)
+        fetched = lh_table_lookup_ex(running_snapshot.trees, xpath, &indexed);
     if (node_name) {
         strlcat(xpath, "/", sizeof(xpath));
         strlcat(xpath, node_name, sizeof(xpath));
     }
-    sr_data_t *sr_data;
-
-    // get the dnode from sr
-    if (node_name)
-        ret = sr_get_node(sr_session, xpath, 0, &sr_data);
-    else
-        ret = sr_get_data(sr_session, xpath, 0, 0, 0, &sr_data);
-    if (ret != SR_ERR_OK) {
-        if (ret != SR_ERR_NOT_FOUND) {
-            fprintf(stderr,
-                    "%s: failed to get node data from sysrepo ds."
-                    " xpath = \"%s\": %s\n",
-                    __func__, xpath, sr_strerror(ret));
-        }
+    // not part of the fetched startcmds, e.g. the parent startcmd of a changed node.
+    if (!fetched && running_snapshot.trees)
+        fetched = lh_table_lookup_ex(running_snapshot.trees, xpath, &indexed);
+    if (fetched)
+        running_tree = indexed;
+    else if (fetch_running_data(xpath, &running_tree) == EXIT_SUCCESS)
+        add_running_tree(xpath, running_tree);
+    if (running_tree == NULL)
         return NULL;
-    }
-    return sr_data->tree;
+    if (lyd_find_path(running_tree, xpath, 0, &found) != LY_SUCCESS)
+        return NULL;
+    return found;
 }
 
 struct lyd_node *get_parent_startcmd(struct lyd_node *dnode)
@@ -444,19 +735,18 @@ int find_netns(struct lyd_node *startcmd, char **netns)
                         __func__);
                 return EXIT_FAILURE;
             }
-            *netns = strdup(network_namespace);
+            *netns = arena_strdup(&cmdgen_arena, network_namespace);
         } else {
             network_namespace = lyd_get_value(netns_dnode);
             if (network_namespace)
-                *netns = strdup(network_namespace);
+                *netns = arena_strdup(&cmdgen_arena, network_namespace);
         }
 
     } else {
         netns_dnode = get_node_from_sr(link_startcmd, "netns");
         if (netns_dnode) {
             network_namespace = lyd_get_value(netns_dnode);
-            *netns = strdup(network_namespace);
-            lyd_free_all(netns_dnode);
+            *netns = arena_strdup(&cmdgen_arena, network_namespace);
         }
     }
     return EXIT_SUCCESS;
@@ -505,45 +795,91 @@ void parse_command(const char *command, int *argc, char ***argv)
 }
 
 /**
- * this function take cmd_line string, convert it to argc, argv and then append it to the cmds array
- *  @param [in,out] cmds array of cmd_info.
- * @param [in,out] cmd_idx current index of cmds.
- * @param [in] cmd_line command line string "ip link add name lo0 type dummy"
- * @param [in] cmd_line_rb the rollback command line string.
+ * @brief growable vector of the commands of a transaction.
+ */
+struct cmds_vec {
+    struct cmd_info **cmds; /* always NULL terminated */
+    int count;
+    int size; /* allocated slots, the terminator included */
+};
+
+/**
+ * allocate the commands vector storage.
+ * @param [out] cmds commands vector.
+ * @param [in] size initial number of slots, the NULL terminator included.
  * @return EXIST_SUCCESS
  * @return EXIST_FAILURE
  */
-int add_command(struct cmd_info **cmds, int *cmd_idx, char *cmd_line, char *cmd_line_rb)
+static int cmds_vec_init(struct cmds_vec *cmds, int size)
 {
-    int argc, argc_rb;
-    char **argv, **argv_rb;
-    if (*cmd_idx >= CMDS_ARRAY_SIZE) {
-        fprintf(stderr,
-                "%s: cmds exceeded MAX allowed commands per transaction, MAX_ALLOWED_CMDS=%d\n",
-                __func__, CMDS_ARRAY_SIZE);
+    cmds->cmds = calloc(size, sizeof(*cmds->cmds));
+    if (cmds->cmds == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
         return EXIT_FAILURE;
     }
-    parse_command(cmd_line, &argc, &argv);
-    parse_command(cmd_line_rb, &argc_rb, &argv_rb);
+    cmds->count = 0;
+    cmds->size = size;
+    return EXIT_SUCCESS;
+}
 
-    (cmds)[*cmd_idx] = malloc(sizeof(struct cmd_info));
+/**
+ * append a command and its rollback command to the cmds array, their argument vectors are moved
+ * to the new cmd_info.
+ * @param [in,out] cmds commands vector, grown as needed.
+ * @param [in,out] cmd_args command arguments "ip link add name lo0 type dummy", reset on success.
+ * @param [in,out] rollback_args the rollback command arguments, reset on success.
+ * @return EXIST_SUCCESS
+ * @return EXIST_FAILURE
+ */
+int add_command(struct cmds_vec *cmds, struct cmd_args *cmd_args, struct cmd_args *rollback_args)
+{
+    struct cmd_info *cmd;
+    if (cmds->count + 1 >= cmds->size) {
+        int size = 2 * cmds->size;
+        struct cmd_info **grown = realloc(cmds->cmds, size * sizeof(*grown));
+        if (grown == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return EXIT_FAILURE;
+        }
+        memset(grown + cmds->size, 0, (size - cmds->size) * sizeof(*grown));
+        cmds->cmds = grown;
+        cmds->size = size;
+    }
+    cmd = malloc(sizeof(struct cmd_info));
 
-    if ((cmds)[*cmd_idx] == NULL) {
+    if (cmd == NULL) {
         fprintf(stderr, "%s: Memory allocation failed\n", __func__);
-        free_argv(argv, argc);
-        free_argv(argv_rb, argc_rb);
         return EXIT_FAILURE;
     }
-    dup_argv(&((cmds)[*cmd_idx]->argv), argv, argc);
-    dup_argv(&((cmds)[*cmd_idx]->rollback_argv), argv_rb, argc_rb);
-    (cmds)[*cmd_idx]->argc = argc;
-    (cmds)[*cmd_idx]->rollback_argc = argc_rb;
-    (*cmd_idx)++;
-    free_argv(argv, argc);
-    free_argv(argv_rb, argc_rb);
+    cmd->argv = cmd_args->argv;
+    cmd->argc = cmd_args->argc;
+    cmd->rollback_argv = rollback_args->argv;
+    cmd->rollback_argc = rollback_args->argc;
+    cmd->nl_req = NULL;
+    cmd->rollback_nl_req = NULL;
+    cmds->cmds[cmds->count++] = cmd;
+    *cmd_args = (struct cmd_args){ 0 };
+    *rollback_args = (struct cmd_args){ 0 };
     return EXIT_SUCCESS;
 }
 
+/**
+ * encode a startcmd node to a native netlink request, for its operation.
+ * @param [in] startcmd startcmd node.
+ * @return netlink request, NULL if the node is applied by its iproute2 command.
+ */
+static struct nl_request *encode_startcmd_nl_req(const struct lyd_node *startcmd)
+{
+    static const nl_request_op_t nl_ops[] = { [ADD_OPR] = NL_REQUEST_ADD,
+                                              [DELETE_OPR] = NL_REQUEST_DELETE,
+                                              [UPDATE_OPR] = NL_REQUEST_REPLACE };
+    oper_t op_val = get_operation(startcmd);
+
+    if (op_val == UNKNOWN_OPR)
+        return NULL;
+    return nl_encode_startcmd(startcmd, nl_ops[op_val]);
+}
+
 /**
  * create argument name from dnoe
  * @param [in] dnode lyd_node
@@ -587,7 +923,7 @@ int create_cmd_arg_name(struct lyd_node *dnode, oper_t startcmd_op_val, char **a
 
     if (get_extension(FLAG_EXT, dnode, NULL) == EXIT_SUCCESS) {
         if (!strcmp("true", lyd_get_value(dnode)))
-            *arg_name = strdup(dnode->schema->name);
+            *arg_name = arena_strdup(&cmdgen_arena, dnode->schema->name);
         else if (!strcmp("false", lyd_get_value(dnode))) {
             char *on_node_delete = NULL;
             if (get_extension(ON_NODE_DELETE_EXT, dnode, &on_node_delete) == EXIT_SUCCESS) {
@@ -615,7 +951,7 @@ int create_cmd_arg_name(struct lyd_node *dnode, oper_t startcmd_op_val, char **a
             return EXIT_FAILURE;
         }
     } else
-        *arg_name = strdup(dnode->schema->name);
+        *arg_name = arena_strdup(&cmdgen_arena, dnode->schema->name);
     return EXIT_SUCCESS;
 }
 
@@ -623,9 +959,9 @@ int create_cmd_arg_name(struct lyd_node *dnode, oper_t startcmd_op_val, char **a
  * create argument value from dnoe
  * @param [in] dnode lyd_node
  * @param [in] curr_op_val starnode op_val
- * @param [out] value the captured arg value value
+ * @param [in,out] args argument vector the captured arg value is appended to.
  */
-int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, char **arg_value)
+int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, struct cmd_args *args)
 {
     // if the node is not_cmd_arg, skip it
     if (get_extension(NOT_CMD_ARG_EXT, dnode, NULL) == EXIT_SUCCESS)
@@ -651,8 +987,6 @@ int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, char **
     if (get_extension(FLAG_EXT, dnode, NULL) == EXIT_SUCCESS) {
         return EXIT_SUCCESS;
     }
-    if (arg_value == NULL)
-        arg_value = malloc(sizeof(char *));
     // if list and grouping extension, collect the values and group them according to separator.
     if (dnode->schema->nodetype == LYS_LIST) {
         char *group_list_separator = NULL;
@@ -661,10 +995,7 @@ int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, char **
              EXIT_SUCCESS) &&
             (get_extension(GROUP_LEAFS_VALUES_SEPARATOR_EXT, dnode,
                            &group_leafs_values_separator) == EXIT_SUCCESS)) {
-            // add space
-            char temp_value[50] = { 0 };
-
-            strlcat(temp_value, " ", sizeof(temp_value));
+            struct cmd_buf temp_value = { 0 };
             struct lyd_node *list_first_entry = lyd_first_sibling(dnode);
             struct lyd_node *list_next;
 
@@ -678,43 +1009,44 @@ int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, char **
                     // loop through the list entries and add them to cmd_line with the specified separator
                     LY_LIST_FOR(list_first_leaf, leaf_next)
                     {
-                        strlcat(temp_value, lyd_get_value(leaf_next), sizeof(temp_value));
+                        cmd_buf_append(&temp_value, lyd_get_value(leaf_next));
                         if (leaf_next->next != NULL)
-                            strlcat(temp_value, group_leafs_values_separator, sizeof(temp_value));
+                            cmd_buf_append(&temp_value, group_leafs_values_separator);
                     }
                     // add the list separator.
                     if (list_next->next != NULL &&
                         !strcmp(list_next->next->schema->name, list_next->schema->name))
-                        strlcat(temp_value, group_list_separator, sizeof(temp_value));
+                        cmd_buf_append(&temp_value, group_list_separator);
                 }
             }
-            *arg_value = strdup(temp_value);
+            // the grouped entries are one argument, none if all the entries are deleted.
+            char *grouped_value = cmd_buf_release(&temp_value);
+            if (grouped_value == NULL)
+                return EXIT_FAILURE;
+            if (*grouped_value != '\0')
+                cmd_args_push(args, grouped_value);
+            free(grouped_value);
         }
     } else {
         // if INDENT type remove the module name from the value (example: ip-link-type:dummy)
         // this strip ip-link-type.
         LY_DATA_TYPE type = ((struct lysc_node_leaf *)dnode->schema)->type->basetype;
-        if (type == LY_TYPE_IDENT)
-            *arg_value = strip_yang_iden_prefix(lyd_get_value(dnode));
-        else
-            *arg_value = (char *)strdup(lyd_get_value(dnode));
+        if (type == LY_TYPE_IDENT) {
+            cmd_args_push(args, strip_yang_iden_prefix(lyd_get_value(dnode)));
+        } else
+            cmd_args_push(args, lyd_get_value(dnode));
         char *add_static_arg;
         if (get_extension(AFTER_NODE_ADD_STATIC_ARG_EXT, dnode, &add_static_arg) == EXIT_SUCCESS) {
             char *static_arg = NULL, *xpath_arg = NULL;
-            char fin_arg_value[1024] = { 0 };
 
             extract_static_and_xpath_args(add_static_arg, &static_arg, &xpath_arg);
-            strlcat(fin_arg_value, *arg_value, sizeof(fin_arg_value));
-            strlcat(fin_arg_value, " ", sizeof(fin_arg_value));
-            strlcat(fin_arg_value, static_arg, sizeof(fin_arg_value));
+            cmd_args_push_words(args, static_arg);
 
             if (xpath_arg != NULL) {
                 struct ly_set *match_set = NULL;
                 int ret = lyd_find_xpath(dnode, xpath_arg, &match_set);
                 if (match_set != NULL) {
-                    free(xpath_arg);
-                    xpath_arg = strdup(lyd_get_value(match_set->dnodes[0]));
-                    strlcat(fin_arg_value, xpath_arg, sizeof(fin_arg_value));
+                    cmd_args_push(args, lyd_get_value(match_set->dnodes[0]));
                     //                    ly_set_free(match_set, NULL);
                 } else {
                     fprintf(
@@ -725,11 +1057,6 @@ int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, char **
                     return EXIT_FAILURE;
                 }
             }
-            free(xpath_arg);
-            free(add_static_arg);
-            free(static_arg);
-            free(*arg_value);
-            *arg_value = strdup(fin_arg_value);
         }
     }
     return EXIT_SUCCESS;
@@ -739,12 +1066,12 @@ int create_cmd_arg_value(struct lyd_node *dnode, oper_t startcmd_op_val, char **
  * create iproute2 arguments out of lyd2 node, this will take the op_val into consideration,
  * @param startcmd_node lyd_node to generate arg for, example link, nexthop, filter ... etc
  * @param op_val operation value
- * @return
+ * @param args argument vector the arguments are appended to.
+ * @return EXIT_SUCCESS or EXIT_FAILURE
  */
-char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
+int lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val, struct cmd_args *args)
 {
-    char cmd_line[CMD_LINE_SIZE] = { 0 };
-    char tail_arg[64] = { 0 };
+    struct cmd_args tail_args = { 0 };
 
     int ret;
     struct lyd_node *next;
@@ -753,7 +1080,8 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
         char *on_update_include = NULL, *add_static_arg = NULL;
         char *group_list_separator = NULL;
         char *group_leafs_values_separator = NULL;
-        char *arg_name = NULL, *arg_value = NULL;
+        char *arg_name = NULL;
+        struct cmd_args *arg_target = args;
         switch (next->schema->nodetype) {
         case LYS_LIST:
             // if the list (is inner startcmd) or (inner list with delete) skip it.
@@ -782,16 +1110,14 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
                             "but failed to retrieve the the static arg extension value "
                             "for node \"%s\" \n",
                             __func__, next->schema->name);
-                    return NULL;
+                    goto error;
                 }
                 // check if the container has child nodes, when container has extension, libyang
                 // create an empty node container. if the container has children then add the
                 // static arg
                 if (lyd_child(next)) {
-                    strlcat(cmd_line, " ", sizeof(cmd_line));
-                    strlcat(cmd_line, add_static_arg, sizeof(cmd_line));
+                    cmd_args_push_words(args, add_static_arg);
                 }
-                free(add_static_arg);
             }
             if (op_val == UPDATE_OPR &&
                 get_extension(ON_UPDATE_INCLUDE_EXT, next, &on_update_include) == EXIT_SUCCESS) {
@@ -802,7 +1128,7 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
                             "but failed to retrieve the arg-name list from ON_UPDATE_INCLUDE "
                             "extension for node \"%s\" \n",
                             __func__, next->schema->name);
-                    return NULL;
+                    goto error;
                 }
                 // get all the on_update_include arg-names, fetch them from sr, and add them to the cmd_line.
                 // args-names format = arg1, arg2, ... argn
@@ -811,12 +1137,11 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
                 // Get the first arg
                 token = strtok(on_update_include, ",");
                 while (token != NULL) {
-                    arg_name = NULL;
-                    arg_value = NULL;
-                    // get the node from sysrepo
+                    // get the node from sysrepo, the change tree takes a copy of it.
                     struct lyd_node *include_node = get_node_from_sr(startcmd_node, token);
-                    if (include_node == NULL)
-                        return NULL;
+                    if (include_node == NULL ||
+                        lyd_dup_single(include_node, NULL, 0, &include_node) != LY_SUCCESS)
+                        goto error;
                     // add the "create" meta, needed for rollback creation function lyd_diff_reverse_all()
                     ret =
                         lyd_new_meta(NULL, include_node, NULL, "yang:operation", "create", 0, NULL);
@@ -825,7 +1150,7 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
                             stderr,
                             "%s: failed to add \"create\" meta to include_node \"%s\" in parent start_cmd node \"%s\".\n",
                             __func__, include_node->schema->name, startcmd_node->schema->name);
-                        return NULL;
+                        goto error;
                     }
                     // insert the node as child to the next node where the include ext is defined.
                     ret = lyd_insert_child((struct lyd_node *)next, include_node);
@@ -834,7 +1159,7 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
                             stderr,
                             "%s: failed to insert on_update_include node \"%s\" in parent start_cmd node \"%s\".\n",
                             __func__, include_node->schema->name, startcmd_node->schema->name);
-                        return NULL;
+                        goto error;
                     }
                     // get next token.
                     token = strtok(NULL, ",");
@@ -850,36 +1175,29 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
                             "%s: failed to get group_list_separator"
                             " for node \"%s\".\n",
                             __func__, next->schema->name);
-                    return NULL;
+                    goto error;
                 }
                 if (group_leafs_values_separator == NULL) {
                     fprintf(stderr,
                             "%s: failed to get group_leafs_values_separator"
                             " for node \"%s\".\n",
                             __func__, next->schema->name);
-                    return NULL;
+                    goto error;
                 }
                 ret = create_cmd_arg_name(next, op_val, &arg_name);
                 if (ret != EXIT_SUCCESS) {
                     fprintf(stderr, "%s: failed to create create_cmd_arg_name for node \"%s\".\n",
                             __func__, next->schema->name);
-                    return NULL;
+                    goto error;
+                }
+                if (arg_name != NULL) {
+                    cmd_args_push_words(args, arg_name);
                 }
-                ret = create_cmd_arg_value(next, op_val, &arg_value);
+                ret = create_cmd_arg_value(next, op_val, args);
                 if (ret != EXIT_SUCCESS) {
                     fprintf(stderr, "%s: failed to create create_cmd_arg_value for node \"%s\".\n",
                             __func__, next->schema->name);
-                    return NULL;
-                }
-                if (arg_name != NULL) {
-                    strlcat(cmd_line, " ", sizeof(cmd_line));
-                    strlcat(cmd_line, arg_name, sizeof(cmd_line));
-                    free(arg_name);
-                }
-                if (arg_value != NULL) {
-                    strlcat(cmd_line, " ", sizeof(cmd_line));
-                    strlcat(cmd_line, arg_value, sizeof(cmd_line));
-                    free(arg_value);
+                    goto error;
                 }
                 const char *grouped_schema_name = next->schema->name;
                 // skip the collected list info. while the next is not null and the next node is
@@ -926,48 +1244,33 @@ char *lyd2cmdline_args(const struct lyd_node *startcmd_node, oper_t op_val)
 
         case LYS_LEAF:
             arg_name = NULL;
-            arg_value = NULL;
             ret = create_cmd_arg_name(next, op_val, &arg_name);
             if (ret != EXIT_SUCCESS) {
                 fprintf(stderr, "%s: failed to create create_cmd_arg_name for node \"%s\".\n",
                         __func__, next->schema->name);
-                return NULL;
-            }
-            ret = create_cmd_arg_value(next, op_val, &arg_value);
-            if (ret != EXIT_SUCCESS) {
-                fprintf(stderr, "%s: failed to create create_cmd_arg_value for node \"%s\".\n",
-                        __func__, next->schema->name);
-                return NULL;
+                goto error;
             }
-            int is_tail_arg = 0;
             if (get_extension(ADD_LEAF_AT_END, next, NULL) == EXIT_SUCCESS)
-                is_tail_arg = 1;
+                arg_target = &tail_args;
             if (arg_name != NULL) {
-                if (is_tail_arg) {
-                    strlcat(tail_arg, " ", sizeof(tail_arg));
-                    strlcat(tail_arg, arg_name, sizeof(tail_arg));
-                } else {
-                    strlcat(cmd_line, " ", sizeof(cmd_line));
-                    strlcat(cmd_line, arg_name, sizeof(cmd_line));
-                }
-                free(arg_name);
+                cmd_args_push_words(arg_target, arg_name);
             }
-            if (arg_value != NULL) {
-                if (is_tail_arg) {
-                    strlcat(tail_arg, " ", sizeof(tail_arg));
-                    strlcat(tail_arg, arg_value, sizeof(tail_arg));
-                } else {
-                    strlcat(cmd_line, " ", sizeof(cmd_line));
-                    strlcat(cmd_line, arg_value, sizeof(cmd_line));
-                }
-                free(arg_value);
+            ret = create_cmd_arg_value(next, op_val, arg_target);
+            if (ret != EXIT_SUCCESS) {
+                fprintf(stderr, "%s: failed to create create_cmd_arg_value for node \"%s\".\n",
+                        __func__, next->schema->name);
+                goto error;
             }
             break;
         }
         LYD_TREE_DFS_END(startcmd_node, next)
     }
-    strlcat(cmd_line, tail_arg, sizeof(cmd_line)); // add the tail arg to the line.
-    return strdup(cmd_line);
+    cmd_args_move(args, &tail_args); // add the tail args to the command.
+    return args->failed ? EXIT_FAILURE : EXIT_SUCCESS;
+
+error:
+    cmd_args_free(&tail_args);
+    return EXIT_FAILURE;
 }
 
 /**
@@ -1005,7 +1308,6 @@ int ext_onupdate_include_all_hdlr(struct lyd_node **dnode)
             if (ret != LY_SUCCESS) {
                 fprintf(stderr, "%s: failed to add missing node = \"%s\" to the tree. \n", __func__,
                         dnext->schema->name);
-                lyd_free_all(original_dnode);
                 return EXIT_FAILURE;
             }
             ret = lyd_new_meta(NULL, new_dnode, NULL, "yang:operation", "create", 0, NULL);
@@ -1013,21 +1315,26 @@ int ext_onupdate_include_all_hdlr(struct lyd_node **dnode)
                 fprintf(stderr,
                         "%s: failed to set meta data 'yang:operation=create' for node. \"%s\" \n",
                         __func__, (*dnode)->schema->name);
-                lyd_free_all(original_dnode);
                 return EXIT_FAILURE;
             }
         }
         LYD_TREE_DFS_END(original_dnode, dnext)
     }
-    lyd_free_all(original_dnode);
 
     return EXIT_SUCCESS;
 }
 
-char *lyd2cmd_line(struct lyd_node *startcmd_node, char *oper2cmd_prefix[3])
+/**
+ * generate the iproute2 command arguments of a startcmd node.
+ * @param [in] startcmd_node startcmd node.
+ * @param [in] oper2cmd_prefix command prefix of each operation, "ip link add" for example.
+ * @param [out] args command arguments, the netns is inserted as "-n name" after the program name.
+ * @return EXIT_SUCCESS or EXIT_FAILURE, args is freed on failure.
+ */
+int lyd2cmd_args(struct lyd_node *startcmd_node, char *oper2cmd_prefix[3], struct cmd_args *args)
 {
     oper_t op_val;
-    char cmd_line[CMD_LINE_SIZE] = { 0 };
+    *args = (struct cmd_args){ 0 };
     // prepare for new command
     op_val = get_operation(startcmd_node);
 
@@ -1035,89 +1342,304 @@ char *lyd2cmd_line(struct lyd_node *startcmd_node, char *oper2cmd_prefix[3])
         (get_extension(INCLUDE_ALL_ON_UPDATE_EXT, startcmd_node, NULL) == EXIT_SUCCESS)) {
         ext_onupdate_include_all_hdlr(&startcmd_node);
     }
-    // add cmd prefix to the cmd_line
-    strlcpy(cmd_line, oper2cmd_prefix[op_val], sizeof(cmd_line));
+    // add cmd prefix to the args
+    cmd_args_push_words(args, oper2cmd_prefix[op_val]);
     // check if this starcmd is including the parent leafs (tc filter case)
-    if (get_extension(INCLUDE_PARENT_LEAFS, startcmd_node, NULL) == EXIT_SUCCESS) {
-        struct lyd_node *start_cmd_parent = lyd_parent(startcmd_node);
-        char *parent_cmd_args = lyd2cmdline_args(start_cmd_parent, op_val);
-        strlcat(cmd_line, parent_cmd_args, sizeof(cmd_line));
-        free(parent_cmd_args);
+    if (get_extension(INCLUDE_PARENT_LEAFS, startcmd_node, NULL) == EXIT_SUCCESS &&
+        lyd2cmdline_args(lyd_parent(startcmd_node), op_val, args) != EXIT_SUCCESS) {
+        fprintf(stderr, "%s: failed to create parent cmdline arguments for node \"%s\" \n",
+                __func__, startcmd_node->schema->name);
+        cmd_args_free(args);
+        return EXIT_FAILURE;
     }
     // get the cmd args for the startcmd_node
-    char *cmd_args = lyd2cmdline_args(startcmd_node, op_val);
-    if (cmd_args == NULL) {
+    if (lyd2cmdline_args(startcmd_node, op_val, args) != EXIT_SUCCESS) {
         fprintf(stderr, "%s: failed to create cmdline arguments for node \"%s\" \n", __func__,
                 startcmd_node->schema->name);
-        return NULL;
+        cmd_args_free(args);
+        return EXIT_FAILURE;
     }
-    strlcat(cmd_line, cmd_args, sizeof(cmd_line));
-    free(cmd_args);
     // check if netns found, then inset it in cmd "ip -netns red ..." , "1" is the global netns.
     char *netns = "1";
     int ret = find_netns(startcmd_node, &netns);
     if (ret != EXIT_SUCCESS) {
         fprintf(stderr, "%s: failed to get netns for node \"%s\" \n", __func__,
                 startcmd_node->schema->name);
-        return NULL;
+        cmd_args_free(args);
+        return EXIT_FAILURE;
     }
-    if (strcmp(netns, "1") != 0) {
-        insert_netns(cmd_line, netns);
+    if (strcmp(netns, "1") != 0 && args->argc > 0) {
+        cmd_args_insert(args, 1, "-n");
+        cmd_args_insert(args, 2, netns);
     }
+    if (args->failed) {
+        cmd_args_free(args);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief startcmds owning the leafref target nodes of one schema node and value.
+ */
+struct lref_target {
+    const struct lysc_node *s_node; /* target schema node */
+    char *value;
+    struct ly_set *startcmds;
+    int n_orphans; /* target nodes outside any startcmd */
+};
+
+/**
+ * @brief target schema node of a leafref type, the leafref path is relative to the leaf schema
+ * node so a type shared by several leafs, through a typedef or a grouping, resolves per leaf.
+ */
+struct lref_snode {
+    const struct lysc_node *schema; /* leafref leaf schema node */
+    const struct lysc_type_leafref *type; /* the leaf type, or one of its union types */
+    const struct lysc_node *target;
+};
 
-    return strdup(cmd_line);
+/**
+ * @brief leafref targets of a transaction change nodes, indexed by target schema node and value.
+ * the target nodes of a schema node are indexed by one xpath search, on the first leafref to it.
+ */
+struct lref_index {
+    const struct lyd_node *all_change_nodes;
+    struct lh_table *lref_snodes; /* struct lref_snode, by schema and type */
+    struct lh_table *indexed_snodes; /* target schema nodes with indexed target nodes */
+    struct lh_table *targets; /* struct lref_target, by s_node and value */
+};
+
+static unsigned long lref_target_hash(const void *k)
+{
+    const struct lref_target *target = k;
+    unsigned long hash = (unsigned long)(uintptr_t)target->s_node;
+
+    for (const char *c = target->value; *c; c++)
+        hash = hash * 33 + (unsigned char)*c;
+    return hash;
 }
 
-int find_matching_target_lrefs(const struct lyd_node *all_change_nodes, struct lyd_node *startcmd,
-                               struct lysc_type_leafref *lref_t, struct ly_set **found_leafrefs_set)
+static int lref_target_equal(const void *k1, const void *k2)
 {
-    char xpath[1024] = { 0 };
-    struct ly_set *target_set, *s_set = NULL;
-    struct lysc_node *target_startcmd_y_node = NULL;
+    const struct lref_target *target1 = k1, *target2 = k2;
+
+    return target1->s_node == target2->s_node && !strcmp(target1->value, target2->value);
+}
+
+static unsigned long lref_snode_hash(const void *k)
+{
+    const struct lref_snode *snode = k;
+
+    return (unsigned long)(uintptr_t)snode->schema * 31 + (unsigned long)(uintptr_t)snode->type;
+}
+
+static int lref_snode_equal(const void *k1, const void *k2)
+{
+    const struct lref_snode *snode1 = k1, *snode2 = k2;
+
+    return snode1->schema == snode2->schema && snode1->type == snode2->type;
+}
+
+static void lref_snode_entry_free(struct lh_entry *entry)
+{
+    /* the entry key and value are the same lref_snode */
+    free(lh_entry_v(entry));
+}
+
+static void lref_target_entry_free(struct lh_entry *entry)
+{
+    /* the entry key and value are the same lref_target */
+    struct lref_target *target = lh_entry_v(entry);
+
+    ly_set_free(target->startcmds, NULL);
+    free(target->value);
+    free(target);
+}
+
+/**
+ * free a leafref target index.
+ * @param index [in] leafref target index, can be NULL.
+ */
+static void free_lref_index(struct lref_index *index)
+{
+    if (index == NULL)
+        return;
+    if (index->lref_snodes)
+        lh_table_free(index->lref_snodes);
+    if (index->indexed_snodes)
+        lh_table_free(index->indexed_snodes);
+    if (index->targets)
+        lh_table_free(index->targets);
+    free(index);
+}
+
+/**
+ * create an empty leafref target index of a transaction.
+ * @param all_change_nodes [in] all change nodes of the transaction.
+ * @return leafref target index, NULL on failure.
+ */
+static struct lref_index *new_lref_index(const struct lyd_node *all_change_nodes)
+{
+    struct lref_index *index = calloc(1, sizeof(*index));
+
+    if (index == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+    index->all_change_nodes = all_change_nodes;
+    index->lref_snodes = lh_table_new(64, lref_snode_entry_free, lref_snode_hash, lref_snode_equal);
+    index->indexed_snodes = lh_kptr_table_new(64, NULL);
+    index->targets =
+        lh_table_new(1024, lref_target_entry_free, lref_target_hash, lref_target_equal);
+    if (index->lref_snodes == NULL || index->indexed_snodes == NULL || index->targets == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free_lref_index(index);
+        return NULL;
+    }
+    return index;
+}
+
+/**
+ * get the target schema node of a leafref type, resolved once per transaction and leaf schema
+ * node.
+ * @param index [in] leafref target index.
+ * @param lref_node [in] leafref data node.
+ * @param lref_t [in] leafref type of the node.
+ * @return target schema node, NULL on failure.
+ */
+static const struct lysc_node *get_lref_target_snode(struct lref_index *index,
+                                                     struct lyd_node *lref_node,
+                                                     struct lysc_type_leafref *lref_t)
+{
+    struct lref_snode lookup = { .schema = lref_node->schema, .type = lref_t }, *snode;
+    const struct lysc_node *target_snode;
+    struct ly_set *s_set = NULL;
     int ret;
+
+    if (lh_table_lookup_ex(index->lref_snodes, &lookup, (void **)&snode))
+        return snode->target;
     // get the schema node of the leafref.
-    ret = lys_find_expr_atoms(startcmd->schema, startcmd->schema->module, lref_t->path,
+    ret = lys_find_expr_atoms(lref_node->schema, lref_node->schema->module, lref_t->path,
                               lref_t->prefixes, 0, &s_set);
     if (s_set == NULL || ret != LY_SUCCESS) {
         fprintf(stderr, "%s: failed to get target leafref for node \"%s\": %s\n", __func__,
-                startcmd->schema->name, ly_strerrcode(ret));
-        return EXIT_FAILURE;
+                lref_node->schema->name, ly_strerrcode(ret));
+        ly_set_free(s_set, NULL);
+        return NULL;
     }
+    target_snode = s_set->snodes[s_set->count - 1];
+    ly_set_free(s_set, NULL);
+    snode = malloc(sizeof(*snode));
+    if (snode == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+    *snode = lookup;
+    snode->target = target_snode;
+    if (lh_table_insert(index->lref_snodes, snode, snode)) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(snode);
+        return NULL;
+    }
+    return target_snode;
+}
 
-    target_startcmd_y_node = s_set->snodes[s_set->count - 1];
+/**
+ * index the target nodes of a schema node found in the change nodes, by their value.
+ * @param index [in,out] leafref target index.
+ * @param target_snode [in] target schema node.
+ * @return EXIT_SUCCESS
+ * @return EXIT_FAILURE
+ */
+static int index_lref_targets(struct lref_index *index, const struct lysc_node *target_snode)
+{
+    char xpath[1024] = { 0 };
+    struct ly_set *target_set = NULL;
+    int ret;
+
+    if (lh_table_lookup_ex(index->indexed_snodes, target_snode, NULL))
+        return EXIT_SUCCESS;
     // get the xpath of the schema node.
-    lysc_path(target_startcmd_y_node, LYSC_PATH_DATA, xpath, 1024);
+    lysc_path(target_snode, LYSC_PATH_DATA, xpath, 1024);
     // get all target nodes.
-    ret = lyd_find_xpath(all_change_nodes, xpath, &target_set);
+    ret = lyd_find_xpath(index->all_change_nodes, xpath, &target_set);
     if (ret != LY_SUCCESS) {
         fprintf(stderr, "%s: failed to found target startcmd nodes for xpath `%s`: %s.\n", __func__,
                 xpath, ly_strerrcode(ret));
         return EXIT_FAILURE;
     }
-    // loop through all found target dnodes and get the matching one to the current
-    // next dnode.
     for (uint32_t i = 0; i < target_set->count; i++) {
-        if (!strcmp(lyd_get_value(startcmd), lyd_get_value(target_set->dnodes[i]))) {
-            // get the parnet startcmd node for the matched target dnode.
-            struct lyd_node *target_parent = lyd_parent(target_set->dnodes[i]);
-            while (target_parent != NULL) {
-                if (is_startcmd_node(target_parent))
-                    break;
-                target_parent = lyd_parent(target_parent);
-            }
-            if (target_parent == NULL) {
-                fprintf(stderr, "%s: no matching startcmd node found, target_node`%s`.\n", __func__,
-                        target_set->dnodes[i]->schema->name);
-                return EXIT_FAILURE;
-            }
-            // add the target startcmd to the found_leafrefs_set.
-            ret = ly_set_add(*found_leafrefs_set, target_parent, 0, NULL);
-            if (ret != LY_SUCCESS) {
-                fprintf(stderr,
-                        "%s: failed to add target startcmd to found_leafrefs_set `%s`: %s.\n",
-                        __func__, target_set->dnodes[i]->schema->name, ly_strerrcode(ret));
+        struct lref_target lookup = { .s_node = target_snode,
+                                      .value = (char *)lyd_get_value(target_set->dnodes[i]) };
+        struct lref_target *target = NULL;
+        // get the parnet startcmd node for the target dnode.
+        struct lyd_node *target_parent = get_parent_startcmd(lyd_parent(target_set->dnodes[i]));
+
+        if (!lh_table_lookup_ex(index->targets, &lookup, (void **)&target)) {
+            target = calloc(1, sizeof(*target));
+            if (target == NULL || (target->value = strdup(lookup.value)) == NULL ||
+                ly_set_new(&target->startcmds) != LY_SUCCESS ||
+                lh_table_insert(index->targets, target, target)) {
+                fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+                if (target) {
+                    ly_set_free(target->startcmds, NULL);
+                    free(target->value);
+                }
+                free(target);
+                ly_set_free(target_set, NULL);
                 return EXIT_FAILURE;
             }
+            target->s_node = target_snode;
+        }
+        if (target_parent == NULL)
+            target->n_orphans++;
+        else
+            ly_set_add(target->startcmds, target_parent, 0, NULL);
+    }
+    ly_set_free(target_set, NULL);
+    if (lh_table_insert(index->indexed_snodes, target_snode, NULL)) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * add the startcmds owning the target nodes of a leafref node to found_leafrefs_set.
+ * @param index [in] leafref target index of the transaction.
+ * @param startcmd [in] leafref data node.
+ * @param lref_t [in] leafref type of the node.
+ * @param found_leafrefs_set [in,out] target startcmds found.
+ * @return EXIT_SUCCESS
+ * @return EXIT_FAILURE
+ */
+static int find_matching_target_lrefs(struct lref_index *index, struct lyd_node *startcmd,
+                                      struct lysc_type_leafref *lref_t,
+                                      struct ly_set **found_leafrefs_set)
+{
+    const struct lysc_node *target_snode = get_lref_target_snode(index, startcmd, lref_t);
+    struct lref_target lookup, *target = NULL;
+    int ret;
+
+    if (target_snode == NULL || index_lref_targets(index, target_snode) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    lookup = (struct lref_target){ .s_node = target_snode,
+                                   .value = (char *)lyd_get_value(startcmd) };
+    if (!lh_table_lookup_ex(index->targets, &lookup, (void **)&target))
+        return EXIT_SUCCESS;
+    if (target->n_orphans) {
+        fprintf(stderr, "%s: no matching startcmd node found, target_node`%s`.\n", __func__,
+                target_snode->name);
+        return EXIT_FAILURE;
+    }
+    // add the target startcmds to the found_leafrefs_set.
+    for (uint32_t i = 0; i < target->startcmds->count; i++) {
+        ret = ly_set_add(*found_leafrefs_set, target->startcmds->dnodes[i], 0, NULL);
+        if (ret != LY_SUCCESS) {
+            fprintf(stderr, "%s: failed to add target startcmd to found_leafrefs_set `%s`: %s.\n",
+                    __func__, target_snode->name, ly_strerrcode(ret));
+            return EXIT_FAILURE;
         }
     }
     return EXIT_SUCCESS;
@@ -1125,14 +1647,14 @@ int find_matching_target_lrefs(const struct lyd_node *all_change_nodes, struct l
 
 /**
  * @brief get all leafrefs of startcmd node, and add them to found_leafrefs
- * @param all_change_nodes [in]  all change nodes
+ * @param index [in]  leafref target index of all change nodes
  * @param startcmd_node     [in]  lyd_node to create cmd_info for and add it to cmds.
  * @param found_leafrefs   [out] all leafrefs founded, the leafrefs will be duplicates of the
  *                               original leafref, and their parents will linked together.
  * @return EXIST_SUCCESS
  * @return EXIST_FAILURE
  */
-int get_node_leafrefs(const struct lyd_node *all_change_nodes, struct lyd_node *startcmd,
+int get_node_leafrefs(struct lref_index *index, struct lyd_node *startcmd,
                       struct ly_set **found_leafrefs_set)
 {
     int ret;
@@ -1140,7 +1662,7 @@ int get_node_leafrefs(const struct lyd_node *all_change_nodes, struct lyd_node *
     struct lyd_node *next = NULL;
     // check if this startcmd is also including parent node's leafs.
     if (get_extension(INCLUDE_PARENT_LEAFS, startcmd, NULL) == EXIT_SUCCESS)
-        get_node_leafrefs(all_change_nodes, lyd_parent(startcmd), found_leafrefs_set);
+        get_node_leafrefs(index, lyd_parent(startcmd), found_leafrefs_set);
 
     LYD_TREE_DFS_BEGIN(startcmd, next)
     {
@@ -1162,8 +1684,7 @@ int get_node_leafrefs(const struct lyd_node *all_change_nodes, struct lyd_node *
                         continue;
                     struct lysc_type_leafref *lref_t =
                         (struct lysc_type_leafref *)y_union_t->types[i_sized];
-                    ret = find_matching_target_lrefs(all_change_nodes, next, lref_t,
-                                                     found_leafrefs_set);
+                    ret = find_matching_target_lrefs(index, next, lref_t, found_leafrefs_set);
                     if (ret != EXIT_SUCCESS) {
                         fprintf(stderr,
                                 "%s: fail to find and add matching target for node `%s`: %s.\n",
@@ -1175,8 +1696,7 @@ int get_node_leafrefs(const struct lyd_node *all_change_nodes, struct lyd_node *
                 // get the schema node of the leafref.
                 struct lysc_type_leafref *lref_t =
                     (struct lysc_type_leafref *)(((struct lysc_node_leaf *)next->schema)->type);
-                ret =
-                    find_matching_target_lrefs(all_change_nodes, next, lref_t, found_leafrefs_set);
+                ret = find_matching_target_lrefs(index, next, lref_t, found_leafrefs_set);
                 if (ret != EXIT_SUCCESS) {
                     fprintf(stderr, "%s: fail to find and add matching target for node `%s`: %s.\n",
                             __func__, next->schema->name, ly_strerrcode(ret));
@@ -1191,13 +1711,12 @@ int get_node_leafrefs(const struct lyd_node *all_change_nodes, struct lyd_node *
 
 /**
  * @brief create cmd_info for startcmd_node and add it to cmds.
- * @param cmds [in,out] array of cmd_info
- * @param cmd_idx [in,out] current index pointer for cmds
+ * @param cmds [in,out] commands vector
  * @param startcmd_node [in] lyd_node to create cmd_info for and add it to cmds.
  * @return EXIST_SUCCESS
  * @return EXIST_FAILURE
  */
-int add_cmd_info_core(struct cmd_info **cmds, int *cmd_idx, struct lyd_node *startcmd_node)
+int add_cmd_info_core(struct cmds_vec *cmds, struct lyd_node *startcmd_node)
 {
     // if the parent is startcmd, and the parent is delete, skip this inner startcmd.
     struct lyd_node *startcmd_parent = lyd_parent(startcmd_node);
@@ -1206,7 +1725,7 @@ int add_cmd_info_core(struct cmd_info **cmds, int *cmd_idx, struct lyd_node *sta
 
     int ret = EXIT_SUCCESS;
     char *oper2cmd_prefix[3] = { NULL };
-    char *cmd_line = NULL, *rollback_cmd_line = NULL;
+    struct cmd_args cmd_args = { 0 }, rollback_args = { 0 };
     struct lyd_node *rollback_dnode = NULL;
     struct lyd_node *del_startcmd_node = NULL;
     // first get the add, update, delete cmds prefixis from schema extensions
@@ -1301,17 +1820,21 @@ int add_cmd_info_core(struct cmd_info **cmds, int *cmd_idx, struct lyd_node *sta
             ret = EXIT_FAILURE;
             goto cleanup;
         }
-        char *del_cmd_line = NULL;
         initialize_startcmdinfo(del_startcmd_node);
 
-        del_cmd_line = lyd2cmd_line(del_startcmd_node, oper2cmd_prefix);
-        if (del_cmd_line == NULL) {
+        if (lyd2cmd_args(del_startcmd_node, oper2cmd_prefix, &cmd_args) != EXIT_SUCCESS) {
             fprintf(stderr, "%s: failed to generate cmd for del_startcmd node \"%s\" \n", __func__,
                     startcmd_node->schema->name);
             ret = EXIT_FAILURE;
             goto cleanup;
         }
-        add_command(cmds, cmd_idx, del_cmd_line, del_cmd_line);
+        // the delete command is its own rollback.
+        for (int i = 0; i < cmd_args.argc; i++)
+            cmd_args_push(&rollback_args, cmd_args.argv[i]);
+        if (rollback_args.failed || add_command(cmds, &cmd_args, &rollback_args) != EXIT_SUCCESS) {
+            ret = EXIT_FAILURE;
+            goto cleanup;
+        }
     }
 
     // before calling diff_reserve we need to do dup_single, otherwise all sibling startcmds,
@@ -1345,163 +1868,192 @@ int add_cmd_info_core(struct cmd_info **cmds, int *cmd_idx, struct lyd_node *sta
     initialize_startcmdinfo(rollback_dnode);
 
     // generate the iproute2 command
-    cmd_line = lyd2cmd_line(startcmd_node, oper2cmd_prefix);
-    if (cmd_line == NULL) {
+    if (lyd2cmd_args(startcmd_node, oper2cmd_prefix, &cmd_args) != EXIT_SUCCESS) {
         fprintf(stderr, "%s: failed to generate ipr2 cmd for node \"%s\" \n", __func__,
                 startcmd_node->schema->name);
         ret = EXIT_FAILURE;
         goto cleanup;
     }
     // generate the iproute2 rollback command
-    rollback_cmd_line = lyd2cmd_line(rollback_dnode, oper2cmd_prefix);
-    if (rollback_cmd_line == NULL) {
+    if (lyd2cmd_args(rollback_dnode, oper2cmd_prefix, &rollback_args) != EXIT_SUCCESS) {
         fprintf(stderr, "%s: failed to generate ipr2 rollback cmd for node \"%s\" \n", __func__,
                 rollback_dnode->schema->name);
         ret = EXIT_FAILURE;
         goto cleanup;
     }
-    ret = add_command(cmds, cmd_idx, cmd_line, rollback_cmd_line);
+    ret = add_command(cmds, &cmd_args, &rollback_args);
+    if (ret != EXIT_SUCCESS)
+        goto cleanup;
+
+    // encode the route and nexthop entries to netlink requests when their module has a native
+    // encoder enabled, the nodes hold all their leaves once lyd2cmd_args() handled them.
+    cmds->cmds[cmds->count - 1]->nl_req = encode_startcmd_nl_req(startcmd_node);
+    cmds->cmds[cmds->count - 1]->rollback_nl_req = encode_startcmd_nl_req(rollback_dnode);
 
 cleanup:
-    if (cmd_line)
-        free(cmd_line);
-    if (rollback_cmd_line)
-        free(rollback_cmd_line);
+    cmd_args_free(&cmd_args);
+    cmd_args_free(&rollback_args);
     if (rollback_dnode)
         lyd_free_all(rollback_dnode);
     if (del_startcmd_node)
         lyd_free_all(del_startcmd_node);
-    if (oper2cmd_prefix[ADD_OPR])
-        free(oper2cmd_prefix[ADD_OPR]);
-    if (oper2cmd_prefix[UPDATE_OPR])
-        free(oper2cmd_prefix[UPDATE_OPR]);
-    if (oper2cmd_prefix[DELETE_OPR])
-        free(oper2cmd_prefix[DELETE_OPR]);
     return ret;
 }
 
 /**
- * this function will ensure that the lyd_node first is added before the lyd_node second,
- * weather  the lyd_nodes are already added to the set or not.
- * @param ordered_set [in,out] the ly_set to insert the nodes in.
- * @param first [in] the first lyd_node to be inserted.
- * @param second [in] the second lyd_node to be inserted.
+ * @brief dependency edge between two startcmds, the from startcmd is applied first.
+ */
+struct startcmd_edge {
+    uint32_t from;
+    uint32_t to;
+};
+
+/**
+ * get the index of a startcmd node in the transaction startcmds set, from its startcmd_info.
+ * @param start_cmds_set [in] ly_set of the transaction startcmds.
+ * @param startcmd [in] startcmd node.
+ * @param idx [out] index of the node in start_cmds_set.
+ * @return EXIT_SUCCESS
+ * @return EXIT_FAILURE if the node is not part of start_cmds_set.
  */
-void ly_set_insert_before(struct ly_set **ordered_set, struct lyd_node *first,
-                          struct lyd_node *second)
+static int get_startcmd_idx(const struct ly_set *start_cmds_set, struct lyd_node *startcmd,
+                            uint32_t *idx)
 {
-    uint32_t i_first, i_second;
-    struct ly_set *temp_set;
-    ly_set_new(&temp_set);
-    // check if first is exist in the set
-    if (ly_set_contains(*ordered_set, second, &i_second)) {
-        if (ly_set_contains(*ordered_set, first, &i_first)) {
-            // first already added before second.
-            if (i_first < i_second)
-                return;
-        }
-        // we need to swap.
-        // [1] move the second node and all nodes after it to the temp set.
-        for (uint32_t i = i_second; i < (*ordered_set)->count; i++) {
-            ly_set_add(temp_set, (*ordered_set)->dnodes[i], 0, NULL);
-            // this remove will keep moving the nodes after the index, so we keep deleting the i_second
-        }
-        while (i_second < (*ordered_set)->count) {
-            // till the end of the list.
-            ly_set_rm_index_ordered(*ordered_set, i_second, NULL);
-        }
-        // [2] add the first node
-        ly_set_add(*ordered_set, first, 0, NULL);
-        // [3] add the copied nodes back to the set
-        for (uint32_t i = 0; i < temp_set->count; i++) {
-            ly_set_add(*ordered_set, temp_set->dnodes[i], 0, NULL);
+    struct startcmd_info *sdnode_info = get_startcmd_info(startcmd);
+
+    if (sdnode_info == NULL || sdnode_info->idx >= start_cmds_set->count ||
+        start_cmds_set->dnodes[sdnode_info->idx] != startcmd)
+        return EXIT_FAILURE;
+    *idx = sdnode_info->idx;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * append a dependency edge to the edges array.
+ * @param edges [in,out] dependency edges array, grown as needed.
+ * @param n_edges [in,out] number of edges in the array.
+ * @param edges_size [in,out] allocated size of the array.
+ * @param from [in] index of the startcmd applied first.
+ * @param to [in] index of the startcmd applied after it.
+ * @return EXIT_SUCCESS
+ * @return EXIT_FAILURE
+ */
+static int add_startcmd_edge(struct startcmd_edge **edges, uint32_t *n_edges, uint32_t *edges_size,
+                             uint32_t from, uint32_t to)
+{
+    if (*n_edges == *edges_size) {
+        uint32_t size = *edges_size ? 2 * *edges_size : 64;
+        struct startcmd_edge *grown = realloc(*edges, size * sizeof(**edges));
+        if (grown == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return EXIT_FAILURE;
         }
-        ly_set_add(*ordered_set, second, 0, NULL);
-        return;
+        *edges = grown;
+        *edges_size = size;
     }
-    // second does not exist then,  add first and then second. NOTE: set handle duplication.
-    ly_set_add(*ordered_set, first, 0, NULL);
-    ly_set_add(*ordered_set, second, 0, NULL);
+    (*edges)[(*n_edges)++] = (struct startcmd_edge){ from, to };
+    return EXIT_SUCCESS;
 }
 
 /**
- * add all dependencies for node startcmd_node, this add dependencies recursively.
- * @param all_change_nodes [in] all change nodes
- * @param startcmd_node [in] startcmd_node to find and add its dependencies.
- * @param sorted_dependecies [in,out] the ly_set to be sorted.
- * @return EXIST_SUCCESS
- * @return EXIST_FAILURE
+ * add the dependency edges of a startcmd node:
+ * - an inner startcmd goes after its parent startcmd.
+ * - if the startcmd node's operation is delete, it goes before its leafrefs.
+ * - if the startcmd node's operation is add or update, its leafrefs go before it.
+ * @param index [in] leafref target index of all change nodes
+ * @param start_cmds_set [in] ly_set of the transaction startcmds.
+ * @param idx [in] index of the startcmd node in start_cmds_set.
+ * @param edges [in,out] dependency edges array, grown as needed.
+ * @param n_edges [in,out] number of edges in the array.
+ * @param edges_size [in,out] allocated size of the array.
+ * @return EXIT_SUCCESS
+ * @return EXIT_FAILURE
  */
-int add_node_dependencies(const struct lyd_node *all_change_nodes, struct lyd_node *startcmd_node,
-                          struct ly_set *sorted_dependecies)
+static int add_startcmd_edges(struct lref_index *index, const struct ly_set *start_cmds_set,
+                              uint32_t idx,
+                              struct startcmd_edge **edges, uint32_t *n_edges,
+                              uint32_t *edges_size)
 {
+    struct lyd_node *startcmd_node = start_cmds_set->dnodes[idx];
+    struct lyd_node *parent_scmd = get_parent_startcmd(lyd_parent(startcmd_node));
+    struct ly_set *node_leafrefs = NULL;
+    int is_delete = get_operation(startcmd_node) == DELETE_OPR ||
+                    get_operation(lyd_parent(startcmd_node)) == DELETE_OPR;
+    uint32_t lref_idx;
     int ret = EXIT_SUCCESS;
-    struct startcmd_info *sdnode_info = get_startcmd_info(startcmd_node);
-    if (sdnode_info->processed)
-        return ret;
 
-    struct ly_set *node_leafrefs = NULL;
-    ly_set_new(&node_leafrefs);
+    if (parent_scmd && get_startcmd_idx(start_cmds_set, parent_scmd, &lref_idx) == EXIT_SUCCESS &&
+        add_startcmd_edge(edges, n_edges, edges_size, lref_idx, idx) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
 
-    // get the node leafrefs
-    ret = get_node_leafrefs(all_change_nodes, startcmd_node, &node_leafrefs);
-    if (ret != EXIT_SUCCESS) {
+    ly_set_new(&node_leafrefs);
+    if (get_node_leafrefs(index, startcmd_node, &node_leafrefs) != EXIT_SUCCESS) {
         fprintf(stderr, "%s: failed to get the leafref depenedecnies for node \"%s\"\n ", __func__,
                 startcmd_node->schema->name);
+        ly_set_free(node_leafrefs, NULL);
         return EXIT_FAILURE;
     }
 
-    // check if dependencies found.
-    if (node_leafrefs != NULL) {
-        // - if the start_cmd node's operation is delete, then add it before it's leafrefs.
-        // - if the start_cmd node's operation is add, then add leafref before
-        if (get_operation(startcmd_node) == DELETE_OPR ||
-            get_operation(lyd_parent(startcmd_node)) == DELETE_OPR) {
-            // check if the startcmd's leafrefs already exist in sorted_dependecies,
-            // if it exist then insert the startcmd before the lowest lref index in sorted_dependecies.
-            // [1] process all the depenencies recurcivly
-            for (uint32_t i = 0; i < node_leafrefs->count; i++) {
-                struct lyd_node *leafref_node = node_leafrefs->dnodes[i];
-                add_node_dependencies(all_change_nodes, leafref_node, sorted_dependecies);
-            }
-            // [2] find the lref with lowest index in sorted_dependecies.
-            uint32_t lowest_lref_index = sorted_dependecies->count;
-            struct lyd_node *lowest_lref_node = NULL;
-            for (uint32_t i = 0; i < node_leafrefs->count; i++) {
-                struct lyd_node *leafref_node = node_leafrefs->dnodes[i];
-                uint32_t lref_i = 0;
-                if (ly_set_contains(sorted_dependecies, leafref_node, &lref_i)) {
-                    if (lowest_lref_index > lref_i) {
-                        lowest_lref_index = lref_i;
-                        lowest_lref_node = leafref_node;
-                    }
-                }
-            }
-            // [2] insert the startcmd before the lowest_lref_node in the sorted_dependecies
-            if (lowest_lref_node) {
-                ly_set_insert_before(&sorted_dependecies, startcmd_node, lowest_lref_node);
-            }
-        } else {
-            // the operations is add, so we need to add all startcmd's lrefs before the startcmd.
-            for (uint32_t i = 0; i < node_leafrefs->count; i++) {
-                struct lyd_node *leafref_node = node_leafrefs->dnodes[i];
-                add_node_dependencies(all_change_nodes, leafref_node, sorted_dependecies);
-            }
-        }
+    for (uint32_t i = 0; i < node_leafrefs->count && ret == EXIT_SUCCESS; i++) {
+        // a leafref to the startcmd itself is not a dependency.
+        if (get_startcmd_idx(start_cmds_set, node_leafrefs->dnodes[i], &lref_idx) !=
+                EXIT_SUCCESS ||
+            lref_idx == idx)
+            continue;
+        if (is_delete)
+            ret = add_startcmd_edge(edges, n_edges, edges_size, idx, lref_idx);
+        else
+            ret = add_startcmd_edge(edges, n_edges, edges_size, lref_idx, idx);
     }
+    ly_set_free(node_leafrefs, NULL);
+    return ret;
+}
 
-    // finally, add the current startcmd_node to the sorted set. if you try to add an existing node,
-    // no problem.
-    ly_set_add(sorted_dependecies, startcmd_node, 0, NULL);
-    sdnode_info->processed = 1;
+/**
+ * push a startcmd index to the ready startcmds min-heap.
+ * @param heap [in,out] heap array.
+ * @param heap_len [in,out] number of indexes in the heap.
+ * @param idx [in] startcmd index.
+ */
+static void ready_heap_push(uint32_t *heap, uint32_t *heap_len, uint32_t idx)
+{
+    uint32_t i = (*heap_len)++;
 
-    return ret;
+    while (i > 0 && heap[(i - 1) / 2] > idx) {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = idx;
+}
+
+/**
+ * pop the lowest startcmd index from the ready startcmds min-heap.
+ * @param heap [in,out] heap array.
+ * @param heap_len [in,out] number of indexes in the heap, greater than 0.
+ * @return lowest startcmd index.
+ */
+static uint32_t ready_heap_pop(uint32_t *heap, uint32_t *heap_len)
+{
+    uint32_t top = heap[0], last = heap[--(*heap_len)], i = 0;
+
+    while (2 * i + 1 < *heap_len) {
+        uint32_t child = 2 * i + 1;
+        if (child + 1 < *heap_len && heap[child + 1] < heap[child])
+            child++;
+        if (heap[child] >= last)
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = last;
+    return top;
 }
 
 /**
  * sort lyd_nodes dependencies based on the startcmd_node leafrefs.
  * if the startcmd_node is delete, it's added before its leafrefs, if it's add, it's added after
- * its leafrefs.
+ * its leafrefs. The dependency graph is sorted with Kahn's algorithm, the ready startcmds are
+ * taken in the change tree order so independent startcmds keep it.
  * @param start_cmds_set [in] ly_set of unsorted startcmds.
  * @param all_change_nodes  [in] lyd_node for all changed nodes in this trax. need for find/search
  * @param sorted_startcmds [out] sorted startcmds.
@@ -1511,36 +2063,111 @@ int add_node_dependencies(const struct lyd_node *all_change_nodes, struct lyd_no
 int sort_lyd_dependencies(struct ly_set *start_cmds_set, const struct lyd_node *all_change_nodes,
                           struct ly_set *sorted_startcmds)
 {
-    for (int i = 0; i < start_cmds_set->count; i++) {
-        int ret =
-            add_node_dependencies(all_change_nodes, start_cmds_set->dnodes[i], sorted_startcmds);
+    uint32_t n = start_cmds_set->count;
+    struct startcmd_edge *edges = NULL;
+    uint32_t n_edges = 0, edges_size = 0, n_ready = 0, n_sorted = 0;
+    // adjacency lists in compressed rows, the startcmds after startcmd i are
+    // next_cmds[first_next[i]] to next_cmds[first_next[i + 1] - 1].
+    uint32_t *first_next = calloc(n + 1, sizeof(*first_next));
+    uint32_t *in_degree = calloc(n, sizeof(*in_degree));
+    uint32_t *ready = calloc(n, sizeof(*ready));
+    uint32_t *next_cmds = NULL;
+    struct lref_index *index = new_lref_index(all_change_nodes);
+    int ret = EXIT_FAILURE;
+
+    if (index == NULL || first_next == NULL || in_degree == NULL || ready == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        goto done;
+    }
+    // the startcmd_info holds the node index, leafref targets are mapped to it in O(1).
+    for (uint32_t i = 0; i < n; i++)
+        get_startcmd_info(start_cmds_set->dnodes[i])->idx = i;
+    for (uint32_t i = 0; i < n; i++) {
+        if (add_startcmd_edges(index, start_cmds_set, i, &edges, &n_edges, &edges_size) !=
+            EXIT_SUCCESS)
+            goto done;
+    }
 
-        if (ret != EXIT_SUCCESS) {
-            return ret;
+    next_cmds = malloc((n_edges ? n_edges : 1) * sizeof(*next_cmds));
+    if (next_cmds == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        goto done;
+    }
+    for (uint32_t e = 0; e < n_edges; e++) {
+        first_next[edges[e].from + 1]++;
+        in_degree[edges[e].to]++;
+    }
+    for (uint32_t i = 0; i < n; i++)
+        first_next[i + 1] += first_next[i];
+    // fill the rows using ready as the per row fill position.
+    for (uint32_t i = 0; i < n; i++)
+        ready[i] = first_next[i];
+    for (uint32_t e = 0; e < n_edges; e++)
+        next_cmds[ready[edges[e].from]++] = edges[e].to;
+
+    // the indexes are pushed in increasing order, the heap is already ordered.
+    for (uint32_t i = 0; i < n; i++) {
+        if (in_degree[i] == 0)
+            ready[n_ready++] = i;
+    }
+    while (n_ready > 0) {
+        uint32_t i = ready_heap_pop(ready, &n_ready);
+        ly_set_add(sorted_startcmds, start_cmds_set->dnodes[i], 1, NULL);
+        n_sorted++;
+        for (uint32_t k = first_next[i]; k < first_next[i + 1]; k++) {
+            if (--in_degree[next_cmds[k]] == 0)
+                ready_heap_push(ready, &n_ready, next_cmds[k]);
         }
     }
-    return EXIT_SUCCESS;
+    if (n_sorted < n) {
+        // leafrefs cycle, the startcmds left are added in the change tree order.
+        fprintf(stderr, "%s: leafref dependency cycle between %u startcmds\n", __func__,
+                n - n_sorted);
+        for (uint32_t i = 0; i < n; i++) {
+            if (in_degree[i] != 0)
+                ly_set_add(sorted_startcmds, start_cmds_set->dnodes[i], 1, NULL);
+        }
+    }
+    ret = EXIT_SUCCESS;
+
+done:
+    free_lref_index(index);
+    free(edges);
+    free(first_next);
+    free(in_degree);
+    free(ready);
+    free(next_cmds);
+    return ret;
+}
+
+/**
+ * release the cmdgen arena and the startcmd sets once the commands are generated, the startcmd
+ * infos set on the change tree nodes are detached first so no node keeps a pointer into the
+ * released memory.
+ * @param [in] start_cmds_set startcmd nodes holding a startcmd_info.
+ * @param [in] sorted_startcmds sorted startcmd nodes, can be NULL.
+ */
+static void release_cmdgen_pass(struct ly_set *start_cmds_set, struct ly_set *sorted_startcmds)
+{
+    for (uint32_t i = 0; i < start_cmds_set->count; i++)
+        start_cmds_set->dnodes[i]->priv = NULL;
+    arena_release(&cmdgen_arena);
+    ly_set_free(sorted_startcmds, NULL);
+    ly_set_free(start_cmds_set, NULL);
 }
 
 struct cmd_info **lyd2cmds(const struct lyd_node *all_change_nodes)
 {
     char *node_print_text;
-    int cmd_idx = 0;
-    struct cmd_info **cmds = malloc(CMDS_ARRAY_SIZE * sizeof(struct cmd_info *));
-    if (cmds == NULL) {
-        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
-        return NULL;
-    }
-
-    // Set all elements of the array to NULL
-    for (int i = 0; i < CMDS_ARRAY_SIZE; i++) {
-        cmds[i] = NULL;
-    }
+    struct cmds_vec cmds;
 
     const struct lyd_node *change_node;
     struct lyd_node *next = NULL;
-    struct ly_set *start_cmds_set;
-    ly_set_new(&start_cmds_set);
+    struct ly_set *start_cmds_set = NULL, *sorted_startcmds = NULL;
+    if (ly_set_new(&start_cmds_set) != LY_SUCCESS) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
     // collect start cmds from the change tree.
     LY_LIST_FOR(all_change_nodes, change_node)
     {
@@ -1559,7 +2186,13 @@ struct cmd_info **lyd2cmds(const struct lyd_node *all_change_nodes)
                         goto next_iter;
                 }
                 initialize_startcmdinfo(next);
-                ly_set_add(start_cmds_set, next, 0, 0);
+                // each node is visited once, skip the set duplicates lookup.
+                if (ly_set_add(start_cmds_set, next, 1, NULL) != LY_SUCCESS) {
+                    next->priv = NULL;
+                    fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+                    release_cmdgen_pass(start_cmds_set, NULL);
+                    return NULL;
+                }
             }
 next_iter:
             LYD_TREE_DFS_END(change_node, next)
@@ -1567,17 +2200,48 @@ next_iter:
     }
 
     // first sort the dependencies.
-    struct ly_set *sorted_startcmds;
-    ly_set_new(&sorted_startcmds);
-    sort_lyd_dependencies(start_cmds_set, all_change_nodes, sorted_startcmds);
+    if (ly_set_new(&sorted_startcmds) != LY_SUCCESS) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        release_cmdgen_pass(start_cmds_set, NULL);
+        return NULL;
+    }
+#ifdef CMDGEN_SORT_TIMING
+    // benchmark builds only, see scripts/benchmark_config_commit.sh.
+    struct timespec sort_start, sort_end;
+    clock_gettime(CLOCK_MONOTONIC, &sort_start);
+#endif
+    if (sort_lyd_dependencies(start_cmds_set, all_change_nodes, sorted_startcmds) != EXIT_SUCCESS) {
+        release_cmdgen_pass(start_cmds_set, sorted_startcmds);
+        return NULL;
+    }
+#ifdef CMDGEN_SORT_TIMING
+    clock_gettime(CLOCK_MONOTONIC, &sort_end);
+    fprintf(stdout, "%s: sorted %u startcmds in %lld us\n", __func__, start_cmds_set->count,
+            (long long)(sort_end.tv_sec - sort_start.tv_sec) * 1000000 +
+                (sort_end.tv_nsec - sort_start.tv_nsec) / 1000);
+#endif
+
+    // most startcmds generate one command, a replaced one generates a delete command as well.
+    if (cmds_vec_init(&cmds, sorted_startcmds->count + 1) != EXIT_SUCCESS) {
+        release_cmdgen_pass(start_cmds_set, sorted_startcmds);
+        return NULL;
+    }
 
-    // generated command for the sorted dependencies
+    // generated command for the sorted dependencies, their running ds lookups use the subtrees
+    // fetched for the changed startcmds.
+    fetch_startcmds_running_data(sorted_startcmds);
     for (int i = 0; i < sorted_startcmds->count; i++) {
-        if (add_cmd_info_core(cmds, &cmd_idx, sorted_startcmds->dnodes[i]) != EXIT_SUCCESS) {
-            free_cmds_info(cmds);
+        if (add_cmd_info_core(&cmds, sorted_startcmds->dnodes[i]) != EXIT_SUCCESS) {
+            free_running_snapshots();
+            release_cmdgen_pass(start_cmds_set, sorted_startcmds);
+            free_cmds_info(cmds.cmds);
             return NULL;
         }
     }
+    free_running_snapshots();
+    // the startcmd infos of the change tree nodes are released as well, they are not used past
+    // the commands generation.
+    release_cmdgen_pass(start_cmds_set, sorted_startcmds);
 
-    return cmds;
+    return cmds.cmds;
 }
@@ -6,9 +6,10 @@
 #include <sysrepo.h>
 #include <bsd/string.h>
 
-#define CMDS_ARRAY_SIZE 1024
 #define CMD_LINE_SIZE 1024
 
+struct nl_request;
+
 /**
  * @brief data struct to store command information.
  */
@@ -17,11 +18,13 @@ struct cmd_info {
     char **argv;
     int rollback_argc;
     char **rollback_argv;
+    struct nl_request *nl_req; /* native netlink request of argv, NULL if none */
+    struct nl_request *rollback_nl_req; /* native netlink request of rollback_argv, NULL if none */
 };
 
 /**
  * free the all the cmd_info.
- * @param cmds_info array of cmd_info struct.
+ * @param cmds_info NULL terminated array of cmd_info struct.
  */
 void free_cmds_info(struct cmd_info **cmds_info);
 
@@ -46,7 +49,7 @@ void insert_netns(char *cmd, const char *netns);
  *
  *
  * @param[in] all_change_nodes lyd_node change data for all modules.
- * @return cmd_info array.
+ * @return NULL terminated cmd_info array, sized to the transaction.
  */
 struct cmd_info **lyd2cmds(const struct lyd_node *all_change_nodes);
 
@@ -0,0 +1,535 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+/*
+ * Authors:     Amjad Daraiseh, adaraiseh@okdanetworks.com>
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU Affero General Public
+ *              License Version 3.0 as published by the Free Software Foundation;
+ *              either version 3.0 of the License, or (at your option) any later
+ *              version.
+ *
+ * Copyright (C) 2024 Okda Networks, <contact@okdanetworks.com>
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "json_scan.h"
+
+#define JSON_SCAN_KEY_MAX 256
+#define JSON_SCAN_NUMBER_MAX 64
+
+struct json_scan {
+    const char *p;
+    const char *end;
+    struct json_object *wanted_keys;
+    int error;
+};
+
+static struct json_object *parse_value(struct json_scan *s, int filter);
+
+static int is_ws(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static void skip_ws(struct json_scan *s)
+{
+    while (s->p < s->end && is_ws(*s->p))
+        s->p++;
+}
+
+/* returns the first '"' or '\\' at or after p, or end */
+static const char *find_quote_or_escape(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i escape = _mm_set1_epi8('\\');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        int mask = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, escape)));
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\')
+        p++;
+    return p;
+}
+
+/* returns the first string quote or bracket at or after p, or end */
+static const char *find_structural(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)p);
+        /* '[' and ']' only differ from '{' and '}' by the 0x20 bit */
+        __m128i folded = _mm_or_si128(chunk, case_bit);
+        __m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                     _mm_or_si128(_mm_cmpeq_epi8(folded, open),
+                                                  _mm_cmpeq_epi8(folded, close)));
+        int mask = _mm_movemask_epi8(match);
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+#endif
+    while (p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']')
+        p++;
+    return p;
+}
+
+/* returns the closing quote of a string starting at p, or end if the string isn't closed */
+static const char *find_string_end(const char *p, const char *end)
+{
+    for (;;) {
+        p = find_quote_or_escape(p, end);
+        if (p == end || *p == '"')
+            return p;
+        /* skip the escaped character */
+        if (end - p < 2)
+            return end;
+        p += 2;
+    }
+}
+
+static int is_wanted_key(struct json_scan *s, const char *key, size_t len)
+{
+    char key_buf[JSON_SCAN_KEY_MAX];
+
+    /* keys that can't be checked are kept */
+    if (s->wanted_keys == NULL || len >= sizeof(key_buf))
+        return 1;
+    memcpy(key_buf, key, len);
+    key_buf[len] = '\0';
+    return json_object_object_get_ex(s->wanted_keys, key_buf, NULL);
+}
+
+/**
+ * skip a json value without materializing it, and check whether it contains a wanted key.
+ * @param [in,out] s scan state, s->p is moved after the value.
+ * @param [out] contains_wanted set to 1 if a wanted key is found in the value.
+ * @return 0 on success, -1 on parse error.
+ */
+static int skip_value(struct json_scan *s, int *contains_wanted)
+{
+    const char *p = s->p;
+    int depth = 0;
+
+    if (p < s->end && *p != '{' && *p != '[' && *p != '"') {
+        /* number, true, false or null */
+        while (p < s->end && *p != ',' && *p != '}' && *p != ']' && !is_ws(*p))
+            p++;
+        if (p == s->p)
+            return -1;
+        s->p = p;
+        return 0;
+    }
+
+    do {
+        p = find_structural(p, s->end);
+        if (p == s->end)
+            return -1;
+        if (*p == '"') {
+            const char *str = p + 1;
+            p = find_string_end(str, s->end);
+            if (p == s->end)
+                return -1;
+            p++;
+            if (!*contains_wanted && depth > 0) {
+                const char *c = p;
+                while (c < s->end && is_ws(*c))
+                    c++;
+                /* an escaped key is checked as wanted */
+                if (c < s->end && *c == ':' &&
+                    (memchr(str, '\\', p - 1 - str) || is_wanted_key(s, str, p - 1 - str)))
+                    *contains_wanted = 1;
+            }
+        } else if (*p == '{' || *p == '[') {
+            depth++;
+            p++;
+        } else {
+            depth--;
+            p++;
+        }
+    } while (depth > 0);
+
+    s->p = p;
+    return 0;
+}
+
+static int parse_hex4(const char *p, unsigned int *value)
+{
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = p[i];
+        *value <<= 4;
+        if (c >= '0' && c <= '9')
+            *value |= c - '0';
+        else if (c >= 'a' && c <= 'f')
+            *value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            *value |= c - 'A' + 10;
+        else
+            return -1;
+    }
+    return 0;
+}
+
+static size_t utf8_encode(unsigned int cp, char *out)
+{
+    if (cp < 0x80) {
+        out[0] = cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = 0xC0 | (cp >> 6);
+        out[1] = 0x80 | (cp & 0x3F);
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = 0xE0 | (cp >> 12);
+        out[1] = 0x80 | ((cp >> 6) & 0x3F);
+        out[2] = 0x80 | (cp & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (cp >> 18);
+    out[1] = 0x80 | ((cp >> 12) & 0x3F);
+    out[2] = 0x80 | ((cp >> 6) & 0x3F);
+    out[3] = 0x80 | (cp & 0x3F);
+    return 4;
+}
+
+/**
+ * parse a json string, strings without escapes are returned in place.
+ * @param [in,out] s scan state, s->p on the opening quote, moved after the closing quote.
+ * @param [out] str string start.
+ * @param [out] len string length.
+ * @param [out] allocated unescaped string copy to be freed by the caller, NULL if str is in place.
+ * @return 0 on success, -1 on parse error.
+ */
+static int parse_string(struct json_scan *s, const char **str, size_t *len, char **allocated)
+{
+    const char *start = s->p + 1;
+    const char *close = find_string_end(start, s->end);
+    char *out;
+    size_t n = 0;
+
+    *allocated = NULL;
+    if (close == s->end)
+        return -1;
+    s->p = close + 1;
+    if (!memchr(start, '\\', close - start)) {
+        *str = start;
+        *len = close - start;
+        return 0;
+    }
+
+    /* an unescaped string is never longer than the escaped one */
+    out = malloc(close - start + 1);
+    if (out == NULL)
+        return -1;
+    for (const char *c = start; c < close; c++) {
+        if (*c != '\\') {
+            out[n++] = *c;
+            continue;
+        }
+        c++;
+        switch (*c) {
+        case '"':
+        case '\\':
+        case '/':
+            out[n++] = *c;
+            break;
+        case 'b':
+            out[n++] = '\b';
+            break;
+        case 'f':
+            out[n++] = '\f';
+            break;
+        case 'n':
+            out[n++] = '\n';
+            break;
+        case 'r':
+            out[n++] = '\r';
+            break;
+        case 't':
+            out[n++] = '\t';
+            break;
+        case 'u': {
+            unsigned int cp, low;
+            if (close - c < 5 || parse_hex4(c + 1, &cp))
+                goto error;
+            c += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF && close - c >= 7 && c[1] == '\\' && c[2] == 'u' &&
+                !parse_hex4(c + 3, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                c += 6;
+            }
+            n += utf8_encode(cp, out + n);
+            break;
+        }
+        default:
+            goto error;
+        }
+    }
+    out[n] = '\0';
+    *str = out;
+    *len = n;
+    *allocated = out;
+    return 0;
+
+error:
+    free(out);
+    return -1;
+}
+
+static struct json_object *parse_number(struct json_scan *s)
+{
+    char num[JSON_SCAN_NUMBER_MAX];
+    const char *start = s->p;
+    char *endptr;
+    int is_double = 0;
+
+    while (s->p < s->end && ((*s->p >= '0' && *s->p <= '9') || *s->p == '-' || *s->p == '+' ||
+                             *s->p == '.' || *s->p == 'e' || *s->p == 'E')) {
+        if (*s->p == '.' || *s->p == 'e' || *s->p == 'E')
+            is_double = 1;
+        s->p++;
+    }
+    if (s->p == start || s->p - start >= sizeof(num))
+        return NULL;
+    memcpy(num, start, s->p - start);
+    num[s->p - start] = '\0';
+
+    errno = 0;
+    if (is_double) {
+        double d = strtod(num, &endptr);
+        if (*endptr != '\0')
+            return NULL;
+        /* keep the printed text, as json_tokener does */
+        return json_object_new_double_s(d, num);
+    }
+    int64_t i = strtoll(num, &endptr, 10);
+    if (*endptr != '\0')
+        return NULL;
+    if (errno == ERANGE) {
+        if (num[0] == '-')
+            return NULL;
+        errno = 0;
+        uint64_t u = strtoull(num, &endptr, 10);
+        return errno == ERANGE ? NULL : json_object_new_uint64(u);
+    }
+    return json_object_new_int64(i);
+}
+
+static struct json_object *parse_object(struct json_scan *s, int filter)
+{
+    struct json_object *obj = json_object_new_object();
+    char key_buf[JSON_SCAN_KEY_MAX];
+
+    s->p++;
+    skip_ws(s);
+    if (s->p < s->end && *s->p == '}') {
+        s->p++;
+        return obj;
+    }
+    for (;;) {
+        const char *key;
+        size_t key_len;
+        char *key_alloc = NULL;
+        struct json_object *value = NULL;
+        int keep = 1;
+
+        skip_ws(s);
+        if (s->p >= s->end || *s->p != '"' || parse_string(s, &key, &key_len, &key_alloc))
+            goto error;
+        skip_ws(s);
+        if (s->p >= s->end || *s->p != ':') {
+            free(key_alloc);
+            goto error;
+        }
+        s->p++;
+        skip_ws(s);
+
+        if (!filter || is_wanted_key(s, key, key_len)) {
+            value = parse_value(s, 0);
+        } else {
+            /* materialize the member only if it leads to a wanted key */
+            const char *value_start = s->p;
+            int contains_wanted = 0;
+            if (skip_value(s, &contains_wanted))
+                s->error = 1;
+            else if (contains_wanted) {
+                s->p = value_start;
+                value = parse_value(s, 1);
+            } else
+                keep = 0;
+        }
+        if (s->error) {
+            free(key_alloc);
+            goto error;
+        }
+
+        if (keep) {
+            const char *key_str = key_alloc;
+            char *key_long = NULL;
+            if (key_str == NULL && key_len < sizeof(key_buf)) {
+                memcpy(key_buf, key, key_len);
+                key_buf[key_len] = '\0';
+                key_str = key_buf;
+            } else if (key_str == NULL) {
+                key_long = strndup(key, key_len);
+                key_str = key_long;
+            }
+            if (key_str == NULL || json_object_object_add(obj, key_str, value)) {
+                json_object_put(value);
+                free(key_long);
+                free(key_alloc);
+                goto error;
+            }
+            free(key_long);
+        }
+        free(key_alloc);
+
+        skip_ws(s);
+        if (s->p < s->end && *s->p == ',') {
+            s->p++;
+            continue;
+        }
+        if (s->p < s->end && *s->p == '}') {
+            s->p++;
+            return obj;
+        }
+        goto error;
+    }
+
+error:
+    s->error = 1;
+    json_object_put(obj);
+    return NULL;
+}
+
+static struct json_object *parse_array(struct json_scan *s, int filter)
+{
+    struct json_object *arr = json_object_new_array();
+
+    s->p++;
+    skip_ws(s);
+    if (s->p < s->end && *s->p == ']') {
+        s->p++;
+        return arr;
+    }
+    for (;;) {
+        skip_ws(s);
+        struct json_object *value = parse_value(s, filter);
+        if (s->error || json_object_array_add(arr, value)) {
+            json_object_put(value);
+            goto error;
+        }
+        skip_ws(s);
+        if (s->p < s->end && *s->p == ',') {
+            s->p++;
+            continue;
+        }
+        if (s->p < s->end && *s->p == ']') {
+            s->p++;
+            return arr;
+        }
+        goto error;
+    }
+
+error:
+    s->error = 1;
+    json_object_put(arr);
+    return NULL;
+}
+
+static int match_literal(struct json_scan *s, const char *literal, size_t len)
+{
+    if (s->end - s->p < len || strncmp(s->p, literal, len))
+        return 0;
+    s->p += len;
+    return 1;
+}
+
+/**
+ * parse a json value at s->p.
+ * @param [in,out] s scan state, s->error is set on parse error.
+ * @param [in] filter if set, object members are filtered by the wanted keys.
+ * @return parsed json object, NULL for the null value or on error.
+ */
+static struct json_object *parse_value(struct json_scan *s, int filter)
+{
+    struct json_object *value = NULL;
+    const char *str;
+    size_t len;
+    char *allocated;
+
+    if (s->p >= s->end) {
+        s->error = 1;
+        return NULL;
+    }
+    switch (*s->p) {
+    case '{':
+        return parse_object(s, filter);
+    case '[':
+        return parse_array(s, filter);
+    case '"':
+        if (parse_string(s, &str, &len, &allocated)) {
+            s->error = 1;
+            return NULL;
+        }
+        value = json_object_new_string_len(str, len);
+        free(allocated);
+        return value;
+    case 't':
+        if (match_literal(s, "true", 4))
+            return json_object_new_boolean(1);
+        break;
+    case 'f':
+        if (match_literal(s, "false", 5))
+            return json_object_new_boolean(0);
+        break;
+    case 'n':
+        if (match_literal(s, "null", 4))
+            return NULL;
+        break;
+    default:
+        value = parse_number(s);
+        if (value)
+            return value;
+        break;
+    }
+    s->error = 1;
+    return NULL;
+}
+
+struct json_object *json_scan_parse(const char *text, struct json_object *wanted_keys)
+{
+    struct json_scan s = {
+        .p = text,
+        .end = text + strlen(text),
+        .wanted_keys = wanted_keys,
+        .error = 0,
+    };
+    struct json_object *jobj;
+
+    skip_ws(&s);
+    jobj = parse_value(&s, wanted_keys != NULL);
+    skip_ws(&s);
+    if (s.error || s.p != s.end) {
+        json_object_put(jobj);
+        return NULL;
+    }
+    return jobj;
+}
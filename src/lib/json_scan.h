@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+#ifndef IPROUTE2_SYSREPO_JSON_SCAN_H
+#define IPROUTE2_SYSREPO_JSON_SCAN_H
+
+#include "json-c/json.h"
+
+/**
+ * parse a json text into json-c objects, materializing only the object members the caller
+ * reads. A member is materialized if its key is in wanted_keys (with all its value), or if its
+ * value contains a wanted key at any depth (with only the members leading to wanted keys).
+ * Other members are skipped by a structural scan of the text, without any allocation.
+ * @param [in] text NUL terminated json text.
+ * @param [in] wanted_keys json object used as a set of keys, NULL to materialize all members.
+ * @return parsed json object, NULL on parse error.
+ */
+struct json_object *json_scan_parse(const char *text, struct json_object *wanted_keys);
+
+#endif // IPROUTE2_SYSREPO_JSON_SCAN_H
@@ -0,0 +1,272 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+/*
+ * Authors:     Ali Aqrabawi, <aaqrbaw@okdanetworks.com>
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU Affero General Public
+ *              License Version 3.0 as published by the Free Software Foundation;
+ *              either version 3.0 of the License, or (at your option) any later
+ *              version.
+ *
+ * Copyright (C) 2024 Okda Networks, <aaqrbaw@okdanetworks.com>
+ */
+
+#define _GNU_SOURCE /* setns() */
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <linux/netlink.h>
+
+/* common iproute2 */
+#include "utils.h"
+#include "namespace.h"
+
+#include "netns_cache.h"
+
+/**
+ * @brief cached netns fd and rtnl handle.
+ */
+struct netns_entry {
+    char *name; /* "1" for the default netns */
+    int fd;
+    dev_t dev; /* identity of the netns the fd was opened on */
+    ino_t ino;
+    struct rtnl_handle rth;
+    int refs; /* users of rth and waiters for it, see netns_cache_rth() */
+    bool busy; /* rth lent out */
+    bool unlinked; /* removed from the cache, freed by the last user */
+    struct netns_entry *next;
+};
+
+static struct netns_entry *netns_entries;
+/* the config apply workers of different netns use the cache concurrently */
+static pthread_mutex_t netns_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+/* signaled when a rtnl handle is given back */
+static pthread_cond_t netns_cache_cond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * get the path of a netns.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [out] path netns path.
+ * @param [in] size path buffer size.
+ */
+static void netns_path(const char *netns, char *path, size_t size)
+{
+    if (strcmp(netns, "1") == 0)
+        snprintf(path, size, "/proc/1/ns/net");
+    else
+        snprintf(path, size, "%s/%s", NETNS_RUN_DIR, netns);
+}
+
+static void free_netns_entry(struct netns_entry *entry)
+{
+    rtnl_close(&entry->rth);
+    if (entry->fd >= 0)
+        close(entry->fd);
+    free(entry->name);
+    free(entry);
+}
+
+/**
+ * free a netns entry removed from the cache, or leave it to its last user. Called with the cache
+ * lock held.
+ * @param [in] entry cached netns, already unlinked from the list.
+ */
+static void release_netns_entry(struct netns_entry *entry)
+{
+    if (entry->refs > 0)
+        entry->unlinked = true;
+    else
+        free_netns_entry(entry);
+}
+
+/**
+ * check a cached netns is still the one mounted under its name. The default netns is never
+ * deleted and skips the check.
+ * @param [in] entry cached netns.
+ * @return true if the cached netns is valid.
+ */
+static bool netns_entry_valid(const struct netns_entry *entry)
+{
+    char path[PATH_MAX];
+    struct stat st;
+
+    if (strcmp(entry->name, "1") == 0)
+        return true;
+    netns_path(entry->name, path, sizeof(path));
+    return stat(path, &st) == 0 && st.st_dev == entry->dev && st.st_ino == entry->ino;
+}
+
+/**
+ * find a netns in the cache, opening it if it is not cached or no longer valid. Called with the
+ * cache lock held.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @return cached netns, NULL on failure.
+ */
+static struct netns_entry *get_netns_entry(const char *netns)
+{
+    struct netns_entry **pentry, *entry;
+    char path[PATH_MAX];
+    struct stat st;
+
+    for (pentry = &netns_entries; *pentry != NULL; pentry = &(*pentry)->next) {
+        entry = *pentry;
+        if (strcmp(entry->name, netns) != 0)
+            continue;
+        if (netns_entry_valid(entry))
+            return entry;
+        *pentry = entry->next;
+        release_netns_entry(entry);
+        break;
+    }
+
+    netns_path(netns, path, sizeof(path));
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        fprintf(stderr, "%s: memory allocation failed\n", __func__);
+        return NULL;
+    }
+    entry->rth.fd = -1;
+    entry->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (entry->fd < 0 || fstat(entry->fd, &st) < 0) {
+        fprintf(stderr, "Cannot open network namespace \"%s\": %s\n", netns, strerror(errno));
+        free_netns_entry(entry);
+        return NULL;
+    }
+    entry->name = strdup(netns);
+    if (entry->name == NULL) {
+        fprintf(stderr, "%s: memory allocation failed\n", __func__);
+        free_netns_entry(entry);
+        return NULL;
+    }
+    entry->dev = st.st_dev;
+    entry->ino = st.st_ino;
+    entry->next = netns_entries;
+    netns_entries = entry;
+    return entry;
+}
+
+/**
+ * switch the calling thread to a cached netns.
+ * @param [in] entry cached netns.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int switch_netns_entry(const struct netns_entry *entry)
+{
+    if (setns(entry->fd, CLONE_NEWNET) < 0) {
+        fprintf(stderr, "setting the network namespace \"%s\" failed: %s\n", entry->name,
+                strerror(errno));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * open the rtnl handle of a cached netns, in the current netns. NETLINK_CAP_ACK is set for the
+ * socket lifetime: the acks of the pipelined netlink batches carry no copy of their request, so a
+ * batch of acks fits the receive buffer. iproute2 rtnl_talk() and its extack reporting, used by the
+ * commands the handle is lent to, handle the capped acks.
+ * @param [out] rth rtnl handle.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int open_netns_rth(struct rtnl_handle *rth)
+{
+    int one = 1;
+
+    if (rtnl_open(rth, 0) < 0)
+        return EXIT_FAILURE;
+    if (setsockopt(rth->fd, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one)) < 0) {
+        fprintf(stderr, "%s: failed to set NETLINK_CAP_ACK: %s\n", __func__, strerror(errno));
+        rtnl_close(rth);
+        rth->fd = -1;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int netns_cache_switch(const char *netns)
+{
+    struct netns_entry *entry;
+    int ret = EXIT_FAILURE;
+
+    pthread_mutex_lock(&netns_cache_lock);
+    entry = get_netns_entry(netns);
+    if (entry != NULL)
+        ret = switch_netns_entry(entry);
+    pthread_mutex_unlock(&netns_cache_lock);
+    return ret;
+}
+
+struct rtnl_handle *netns_cache_rth(const char *netns)
+{
+    struct netns_entry *entry;
+    struct rtnl_handle *entry_rth = NULL;
+
+    pthread_mutex_lock(&netns_cache_lock);
+    for (;;) {
+        entry = get_netns_entry(netns);
+        if (entry == NULL || !entry->busy)
+            break;
+        // the replies of two users would interleave on the socket, wait for the handle. The entry
+        // is referenced during the wait, and looked up again as the netns might be dropped.
+        entry->refs++;
+        while (entry->busy)
+            pthread_cond_wait(&netns_cache_cond, &netns_cache_lock);
+        if (--entry->refs == 0 && entry->unlinked)
+            free_netns_entry(entry);
+    }
+    // the socket is bound to the netns of the thread creating it.
+    if (entry != NULL && switch_netns_entry(entry) == EXIT_SUCCESS &&
+        (entry->rth.fd >= 0 || open_netns_rth(&entry->rth) == EXIT_SUCCESS)) {
+        entry->refs++;
+        entry->busy = true;
+        entry_rth = &entry->rth;
+    }
+    pthread_mutex_unlock(&netns_cache_lock);
+    return entry_rth;
+}
+
+void netns_cache_put(struct rtnl_handle *rth, bool reset)
+{
+    struct netns_entry *entry;
+
+    if (rth == NULL)
+        return;
+    entry = (struct netns_entry *)((char *)rth - offsetof(struct netns_entry, rth));
+    pthread_mutex_lock(&netns_cache_lock);
+    if (reset)
+        rtnl_close(&entry->rth);
+    entry->busy = false;
+    pthread_cond_broadcast(&netns_cache_cond);
+    if (--entry->refs == 0 && entry->unlinked)
+        free_netns_entry(entry);
+    pthread_mutex_unlock(&netns_cache_lock);
+}
+
+void netns_cache_drop(const char *netns)
+{
+    struct netns_entry **pentry = &netns_entries;
+
+    pthread_mutex_lock(&netns_cache_lock);
+    while (*pentry != NULL) {
+        struct netns_entry *entry = *pentry;
+
+        if (strcmp(entry->name, "1") == 0 || (netns != NULL && strcmp(entry->name, netns) != 0)) {
+            pentry = &entry->next;
+            continue;
+        }
+        *pentry = entry->next;
+        release_netns_entry(entry);
+    }
+    pthread_mutex_unlock(&netns_cache_lock);
+}
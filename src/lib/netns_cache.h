@@ -0,0 +1,41 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+#ifndef IPROUTE2_SYSREPO_NETNS_CACHE_H
+#define IPROUTE2_SYSREPO_NETNS_CACHE_H
+
+#include <stdbool.h>
+
+struct rtnl_handle;
+
+/**
+ * switch the calling thread to a netns, through a cached fd of the netns. A cached netns that was
+ * deleted or recreated under the same name is reopened.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+int netns_cache_switch(const char *netns);
+
+/**
+ * get the cached rtnl handle of a netns, opened on first use. The calling thread is switched to
+ * the netns. The handle is lent out for exclusive use until netns_cache_put(), the other users of
+ * the netns wait for it. It stays valid even if the netns is dropped meanwhile.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @return rtnl handle, NULL on failure.
+ */
+struct rtnl_handle *netns_cache_rth(const char *netns);
+
+/**
+ * give back a rtnl handle got from netns_cache_rth(), from any thread.
+ * @param [in] rth rtnl handle, NULL is ignored.
+ * @param [in] reset close the handle socket, it might hold unread replies. It is reopened on the
+ * next use.
+ */
+void netns_cache_put(struct rtnl_handle *rth, bool reset);
+
+/**
+ * close the cached fd and rtnl handle of a netns, to be called before deleting the netns so the
+ * cache does not keep it alive.
+ * @param [in] netns network namespace name, NULL for all the named netns.
+ */
+void netns_cache_drop(const char *netns);
+
+#endif // IPROUTE2_SYSREPO_NETNS_CACHE_H
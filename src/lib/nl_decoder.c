@@ -0,0 +1,816 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+/*
+ * Authors:     Amjad Daraiseh, adaraiseh@okdanetworks.com>
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU Affero General Public
+ *              License Version 3.0 as published by the Free Software Foundation;
+ *              either version 3.0 of the License, or (at your option) any later
+ *              version.
+ *
+ * Copyright (C) 2024 Okda Networks, <contact@okdanetworks.com>
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <net/if.h>
+#include <linux/if.h>
+#include <linux/icmpv6.h>
+#include <linux/nexthop.h>
+
+/* common iproute2 */
+#include "utils.h"
+#include "rt_names.h"
+#include "ip_common.h"
+
+#include "json-c/json.h"
+#include "json-c/linkhash.h"
+#include "nl_decoder.h"
+
+extern int dump_rtnl_objects(const char *netns, const struct dump_filter *filter,
+                             const int *dump_types, int n_types, rtnl_filter_t msg_cb,
+                             void *cb_arg);
+
+/* link decoded from a RTM_NEWLINK message */
+struct nl_link {
+    int ifindex;
+    unsigned int flags;
+    int iflink; /* IFLA_LINK, 0 if none */
+    bool iflink_netns; /* iflink is an ifindex of another netns */
+    int master; /* IFLA_MASTER, 0 if none */
+    struct json_object *row;
+};
+
+/* links decoded by one nl_decode_links() call */
+struct nl_links {
+    struct nl_link *links;
+    int count;
+    int size;
+    struct lh_table *by_index; /* ifindex -> links index + 1 */
+};
+
+static const char *const link_operstates[] = {
+    "UNKNOWN", "NOTPRESENT", "DOWN", "LOWERLAYERDOWN", "TESTING", "DORMANT", "UP",
+};
+static const char *const link_modes[] = { "DEFAULT", "DORMANT", "TESTING" };
+
+/* link flags names, in the order iproute2 prints them */
+static const struct {
+    unsigned int flag;
+    const char *name;
+} link_flags[] = {
+    { IFF_LOOPBACK, "LOOPBACK" },
+    { IFF_BROADCAST, "BROADCAST" },
+    { IFF_POINTOPOINT, "POINTOPOINT" },
+    { IFF_MULTICAST, "MULTICAST" },
+    { IFF_NOARP, "NOARP" },
+    { IFF_ALLMULTI, "ALLMULTI" },
+    { IFF_PROMISC, "PROMISC" },
+    { IFF_MASTER, "MASTER" },
+    { IFF_SLAVE, "SLAVE" },
+    { IFF_DEBUG, "DEBUG" },
+    { IFF_DYNAMIC, "DYNAMIC" },
+    { IFF_AUTOMEDIA, "AUTOMEDIA" },
+    { IFF_PORTSEL, "PORTSEL" },
+    { IFF_NOTRAILERS, "NOTRAILERS" },
+    { IFF_UP, "UP" },
+    { IFF_LOWER_UP, "LOWER_UP" },
+    { IFF_DORMANT, "DORMANT" },
+    { IFF_ECHO, "ECHO" },
+};
+
+/* rows decoded by one nl_decode_routes() or nl_decode_nexthops() call */
+struct nl_dump_rows {
+    struct json_object *rows;
+    struct lh_table *ifnames; /* ifindex -> name, of the dumped netns interfaces */
+};
+
+/* route and nexthop flags names, in the order iproute2 prints them */
+static const struct {
+    unsigned int flag;
+    const char *name;
+} rt_flags[] = {
+    { RTNH_F_DEAD, "dead" },
+    { RTNH_F_ONLINK, "onlink" },
+    { RTNH_F_PERVASIVE, "pervasive" },
+    { RTNH_F_OFFLOAD, "offload" },
+    { RTNH_F_TRAP, "trap" },
+    { RTNH_F_LINKDOWN, "linkdown" },
+    { RTNH_F_UNRESOLVED, "unresolved" },
+    { RTM_F_OFFLOAD, "rt_offload" },
+    { RTM_F_TRAP, "rt_trap" },
+    { RTM_F_OFFLOAD_FAILED, "rt_offload_failed" },
+};
+
+/* integer route metrics names, as iproute2 prints them */
+static const char *const route_metrics[RTAX_MAX + 1] = {
+    [RTAX_MTU] = "mtu",
+    [RTAX_WINDOW] = "window",
+    [RTAX_SSTHRESH] = "ssthresh",
+    [RTAX_CWND] = "cwnd",
+    [RTAX_ADVMSS] = "advmss",
+    [RTAX_REORDERING] = "reordering",
+    [RTAX_HOPLIMIT] = "hoplimit",
+    [RTAX_INITCWND] = "initcwnd",
+    [RTAX_INITRWND] = "initrwnd",
+    [RTAX_QUICKACK] = "quickack",
+    [RTAX_FASTOPEN_NO_COOKIE] = "fastopen_no_cookie",
+};
+
+static const char *const route_prefs[] = { [ICMPV6_ROUTER_PREF_LOW] = "low",
+                                           [ICMPV6_ROUTER_PREF_MEDIUM] = "medium",
+                                           [ICMPV6_ROUTER_PREF_HIGH] = "high" };
+
+static struct nl_link *find_nl_link(struct nl_links *links, int ifindex)
+{
+    void *idx = NULL;
+
+    if (!lh_table_lookup_ex(links->by_index, (void *)(uintptr_t)ifindex, &idx))
+        return NULL;
+    return &links->links[(uintptr_t)idx - 1];
+}
+
+static int add_nl_link(struct nl_links *links, const struct nl_link *link)
+{
+    if (links->count == links->size) {
+        int size = links->size ? links->size * 2 : 16;
+        struct nl_link *resized = realloc(links->links, size * sizeof(*resized));
+        if (resized == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return EXIT_FAILURE;
+        }
+        links->links = resized;
+        links->size = size;
+    }
+    links->links[links->count++] = *link;
+    if (lh_table_insert(links->by_index, (void *)(uintptr_t)link->ifindex,
+                        (void *)(uintptr_t)links->count)) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void add_string(struct json_object *jobj, const char *key, const char *value)
+{
+    json_object_object_add(jobj, key, json_object_new_string(value));
+}
+
+static void add_uint(struct json_object *jobj, const char *key, uint64_t value)
+{
+    json_object_object_add(jobj, key, json_object_new_uint64(value));
+}
+
+/**
+ * add a link name member, iproute2 names the links missing from the dump "if<ifindex>".
+ * @param [in,out] row link row.
+ * @param [in] key member key.
+ * @param [in] link named link, NULL if not found.
+ * @param [in] ifindex named link index.
+ */
+static void add_link_name(struct json_object *row, const char *key, struct nl_link *link,
+                          int ifindex)
+{
+    char name[IFNAMSIZ + 8];
+
+    if (link) {
+        struct json_object *ifname = json_object_object_get(link->row, "ifname");
+        json_object_object_add(row, key, json_object_get(ifname));
+        return;
+    }
+    snprintf(name, sizeof(name), "if%d", ifindex);
+    add_string(row, key, name);
+}
+
+static struct json_object *link_flags_jobj(unsigned int flags, bool mdown)
+{
+    struct json_object *flags_jobj = json_object_new_array();
+
+    if (flags & IFF_UP && !(flags & IFF_RUNNING))
+        json_object_array_add(flags_jobj, json_object_new_string("NO-CARRIER"));
+    for (size_t i = 0; i < sizeof(link_flags) / sizeof(link_flags[0]); i++) {
+        if (flags & link_flags[i].flag)
+            json_object_array_add(flags_jobj, json_object_new_string(link_flags[i].name));
+    }
+    if (mdown)
+        json_object_array_add(flags_jobj, json_object_new_string("M-DOWN"));
+    return flags_jobj;
+}
+
+static struct json_object *link_stats_jobj(const struct rtattr *stats_attr)
+{
+    struct rtnl_link_stats64 stats = { 0 };
+    struct json_object *stats_jobj = json_object_new_object();
+    struct json_object *rx = json_object_new_object(), *tx = json_object_new_object();
+
+    /* older kernels send a shorter struct, the missing counters stay 0 */
+    size_t len = RTA_PAYLOAD(stats_attr);
+    memcpy(&stats, RTA_DATA(stats_attr), len < sizeof(stats) ? len : sizeof(stats));
+    add_uint(rx, "bytes", stats.rx_bytes);
+    add_uint(rx, "packets", stats.rx_packets);
+    add_uint(rx, "errors", stats.rx_errors);
+    add_uint(rx, "dropped", stats.rx_dropped);
+    add_uint(rx, "over_errors", stats.rx_over_errors);
+    add_uint(rx, "multicast", stats.multicast);
+    add_uint(tx, "bytes", stats.tx_bytes);
+    add_uint(tx, "packets", stats.tx_packets);
+    add_uint(tx, "errors", stats.tx_errors);
+    add_uint(tx, "dropped", stats.tx_dropped);
+    add_uint(tx, "carrier_errors", stats.tx_carrier_errors);
+    add_uint(tx, "collisions", stats.collisions);
+    json_object_object_add(stats_jobj, "rx", rx);
+    json_object_object_add(stats_jobj, "tx", tx);
+    return stats_jobj;
+}
+
+/**
+ * print the kind specific link info with the iproute2 link kinds printers, into the json array
+ * opened by nl_decode_links(), one object per link.
+ * @param [in] linkinfo parsed IFLA_LINKINFO attribute, NULL if the link has none.
+ */
+static void print_link_kind_data(struct rtattr *linkinfo[])
+{
+    open_json_object(NULL);
+    if (linkinfo && linkinfo[IFLA_INFO_KIND] && linkinfo[IFLA_INFO_DATA]) {
+        struct link_util *lu = get_link_kind(rta_getattr_str(linkinfo[IFLA_INFO_KIND]));
+        if (lu && lu->print_opt) {
+            struct rtattr *attr[lu->maxattr + 1];
+            parse_rtattr_nested(attr, lu->maxattr, linkinfo[IFLA_INFO_DATA]);
+            open_json_object("info_data");
+            lu->print_opt(lu, stdout, attr);
+            close_json_object();
+        }
+    }
+    if (linkinfo && linkinfo[IFLA_INFO_SLAVE_KIND] && linkinfo[IFLA_INFO_SLAVE_DATA]) {
+        char slave_kind[64];
+        snprintf(slave_kind, sizeof(slave_kind), "%s_slave",
+                 rta_getattr_str(linkinfo[IFLA_INFO_SLAVE_KIND]));
+        struct link_util *lu = get_link_kind(slave_kind);
+        if (lu && lu->print_opt) {
+            struct rtattr *attr[lu->maxattr + 1];
+            parse_rtattr_nested(attr, lu->maxattr, linkinfo[IFLA_INFO_SLAVE_DATA]);
+            open_json_object("info_slave_data");
+            lu->print_opt(lu, stdout, attr);
+            close_json_object();
+        }
+    }
+    close_json_object();
+}
+
+static int link_msg_to_row(struct nlmsghdr *n, struct nl_links *links)
+{
+    struct ifinfomsg *ifi = NLMSG_DATA(n);
+    struct rtattr *tb[IFLA_MAX + 1], *linkinfo[IFLA_INFO_MAX + 1];
+    struct nl_link link = { .ifindex = ifi->ifi_index, .flags = ifi->ifi_flags };
+    char buf[256];
+
+    if (n->nlmsg_len < NLMSG_LENGTH(sizeof(*ifi)))
+        return -1;
+    parse_rtattr(tb, IFLA_MAX, IFLA_RTA(ifi), IFLA_PAYLOAD(n));
+    if (tb[IFLA_IFNAME] == NULL)
+        return 0;
+    if (tb[IFLA_LINKINFO])
+        parse_rtattr_nested(linkinfo, IFLA_INFO_MAX, tb[IFLA_LINKINFO]);
+    /* keep the kind data objects aligned with the link rows */
+    print_link_kind_data(tb[IFLA_LINKINFO] ? linkinfo : NULL);
+
+    link.row = json_object_new_object();
+    json_object_object_add(link.row, "ifindex", json_object_new_int(ifi->ifi_index));
+    add_string(link.row, "ifname", rta_getattr_str(tb[IFLA_IFNAME]));
+    if (tb[IFLA_LINK]) {
+        link.iflink = rta_getattr_u32(tb[IFLA_LINK]);
+        link.iflink_netns = tb[IFLA_LINK_NETNSID] != NULL;
+    }
+    if (tb[IFLA_MTU])
+        add_uint(link.row, "mtu", rta_getattr_u32(tb[IFLA_MTU]));
+    if (tb[IFLA_QDISC])
+        add_string(link.row, "qdisc", rta_getattr_str(tb[IFLA_QDISC]));
+    if (tb[IFLA_MASTER])
+        link.master = rta_getattr_u32(tb[IFLA_MASTER]);
+    if (tb[IFLA_OPERSTATE]) {
+        __u8 state = rta_getattr_u8(tb[IFLA_OPERSTATE]);
+        if (state < sizeof(link_operstates) / sizeof(link_operstates[0]))
+            add_string(link.row, "operstate", link_operstates[state]);
+        else
+            add_uint(link.row, "operstate", state);
+    }
+    if (tb[IFLA_LINKMODE]) {
+        __u8 mode = rta_getattr_u8(tb[IFLA_LINKMODE]);
+        if (mode < sizeof(link_modes) / sizeof(link_modes[0]))
+            add_string(link.row, "linkmode", link_modes[mode]);
+    }
+    if (tb[IFLA_GROUP])
+        add_string(link.row, "group",
+                   rtnl_group_n2a(rta_getattr_u32(tb[IFLA_GROUP]), buf, sizeof(buf)));
+    if (tb[IFLA_TXQLEN])
+        add_uint(link.row, "txqlen", rta_getattr_u32(tb[IFLA_TXQLEN]));
+    add_string(link.row, "link_type", ll_type_n2a(ifi->ifi_type, buf, sizeof(buf)));
+    if (tb[IFLA_ADDRESS])
+        add_string(link.row, "address",
+                   ll_addr_n2a(RTA_DATA(tb[IFLA_ADDRESS]), RTA_PAYLOAD(tb[IFLA_ADDRESS]),
+                               ifi->ifi_type, buf, sizeof(buf)));
+    if (tb[IFLA_BROADCAST]) {
+        if (ifi->ifi_flags & IFF_POINTOPOINT)
+            json_object_object_add(link.row, "link_pointtopoint", json_object_new_boolean(1));
+        add_string(link.row, "broadcast",
+                   ll_addr_n2a(RTA_DATA(tb[IFLA_BROADCAST]), RTA_PAYLOAD(tb[IFLA_BROADCAST]),
+                               ifi->ifi_type, buf, sizeof(buf)));
+    }
+    if (tb[IFLA_LINK_NETNSID])
+        json_object_object_add(link.row, "link_netnsid",
+                               json_object_new_int(rta_getattr_u32(tb[IFLA_LINK_NETNSID])));
+    if (tb[IFLA_PROTO_DOWN] && rta_getattr_u8(tb[IFLA_PROTO_DOWN]))
+        json_object_object_add(link.row, "proto_down", json_object_new_boolean(1));
+    if (tb[IFLA_PROMISCUITY])
+        add_uint(link.row, "promiscuity", rta_getattr_u32(tb[IFLA_PROMISCUITY]));
+    if (tb[IFLA_MIN_MTU])
+        add_uint(link.row, "min_mtu", rta_getattr_u32(tb[IFLA_MIN_MTU]));
+    if (tb[IFLA_MAX_MTU])
+        add_uint(link.row, "max_mtu", rta_getattr_u32(tb[IFLA_MAX_MTU]));
+    if (tb[IFLA_LINKINFO]) {
+        struct json_object *linkinfo_jobj = json_object_new_object();
+        if (linkinfo[IFLA_INFO_KIND])
+            add_string(linkinfo_jobj, "info_kind", rta_getattr_str(linkinfo[IFLA_INFO_KIND]));
+        if (linkinfo[IFLA_INFO_SLAVE_KIND])
+            add_string(linkinfo_jobj, "info_slave_kind",
+                       rta_getattr_str(linkinfo[IFLA_INFO_SLAVE_KIND]));
+        json_object_object_add(link.row, "linkinfo", linkinfo_jobj);
+    }
+    if (tb[IFLA_NUM_TX_QUEUES])
+        add_uint(link.row, "num_tx_queues", rta_getattr_u32(tb[IFLA_NUM_TX_QUEUES]));
+    if (tb[IFLA_NUM_RX_QUEUES])
+        add_uint(link.row, "num_rx_queues", rta_getattr_u32(tb[IFLA_NUM_RX_QUEUES]));
+    if (tb[IFLA_GSO_MAX_SIZE])
+        add_uint(link.row, "gso_max_size", rta_getattr_u32(tb[IFLA_GSO_MAX_SIZE]));
+    if (tb[IFLA_GSO_MAX_SEGS])
+        add_uint(link.row, "gso_max_segs", rta_getattr_u32(tb[IFLA_GSO_MAX_SEGS]));
+    if (tb[IFLA_GRO_MAX_SIZE])
+        add_uint(link.row, "gro_max_size", rta_getattr_u32(tb[IFLA_GRO_MAX_SIZE]));
+    if (tb[IFLA_GSO_IPV4_MAX_SIZE])
+        add_uint(link.row, "gso_ipv4_max_size", rta_getattr_u32(tb[IFLA_GSO_IPV4_MAX_SIZE]));
+    if (tb[IFLA_GRO_IPV4_MAX_SIZE])
+        add_uint(link.row, "gro_ipv4_max_size", rta_getattr_u32(tb[IFLA_GRO_IPV4_MAX_SIZE]));
+    if (tb[IFLA_IFALIAS])
+        add_string(link.row, "ifalias", rta_getattr_str(tb[IFLA_IFALIAS]));
+    if (tb[IFLA_STATS64])
+        json_object_object_add(link.row, "stats64", link_stats_jobj(tb[IFLA_STATS64]));
+    json_object_object_add(link.row, "addr_info", json_object_new_array());
+
+    if (add_nl_link(links, &link) != EXIT_SUCCESS) {
+        json_object_put(link.row);
+        return -1;
+    }
+    return 0;
+}
+
+static int addr_msg_to_row(struct nlmsghdr *n, struct nl_links *links)
+{
+    struct ifaddrmsg *ifa = NLMSG_DATA(n);
+    struct rtattr *tb[IFA_MAX + 1];
+    struct json_object *addr_info;
+    struct nl_link *link;
+    char buf[64];
+
+    if (n->nlmsg_len < NLMSG_LENGTH(sizeof(*ifa)))
+        return -1;
+    link = find_nl_link(links, ifa->ifa_index);
+    if (link == NULL || !json_object_object_get_ex(link->row, "addr_info", &addr_info))
+        return 0;
+    parse_rtattr(tb, IFA_MAX, IFA_RTA(ifa), n->nlmsg_len - NLMSG_LENGTH(sizeof(*ifa)));
+    if (!tb[IFA_LOCAL])
+        tb[IFA_LOCAL] = tb[IFA_ADDRESS];
+    if (!tb[IFA_ADDRESS])
+        tb[IFA_ADDRESS] = tb[IFA_LOCAL];
+    if (!tb[IFA_LOCAL])
+        return 0;
+
+    unsigned int flags = tb[IFA_FLAGS] ? rta_getattr_u32(tb[IFA_FLAGS]) : ifa->ifa_flags;
+    struct json_object *addr = json_object_new_object();
+    add_string(addr, "family", family_name(ifa->ifa_family));
+    add_string(addr, "local", rt_addr_n2a_rta(ifa->ifa_family, tb[IFA_LOCAL]));
+    if (RTA_PAYLOAD(tb[IFA_ADDRESS]) != RTA_PAYLOAD(tb[IFA_LOCAL]) ||
+        memcmp(RTA_DATA(tb[IFA_ADDRESS]), RTA_DATA(tb[IFA_LOCAL]), RTA_PAYLOAD(tb[IFA_LOCAL])))
+        add_string(addr, "address", rt_addr_n2a_rta(ifa->ifa_family, tb[IFA_ADDRESS]));
+    add_uint(addr, "prefixlen", ifa->ifa_prefixlen);
+    if (tb[IFA_BROADCAST])
+        add_string(addr, "broadcast", rt_addr_n2a_rta(ifa->ifa_family, tb[IFA_BROADCAST]));
+    if (tb[IFA_ANYCAST])
+        add_string(addr, "anycast", rt_addr_n2a_rta(ifa->ifa_family, tb[IFA_ANYCAST]));
+    add_string(addr, "scope", rtnl_rtscope_n2a(ifa->ifa_scope, buf, sizeof(buf)));
+    if (!(flags & IFA_F_PERMANENT))
+        json_object_object_add(addr, "dynamic", json_object_new_boolean(1));
+    if (flags & IFA_F_SECONDARY)
+        json_object_object_add(addr, ifa->ifa_family == AF_INET6 ? "temporary" : "secondary",
+                               json_object_new_boolean(1));
+    if (flags & IFA_F_TENTATIVE)
+        json_object_object_add(addr, "tentative", json_object_new_boolean(1));
+    if (flags & IFA_F_DEPRECATED)
+        json_object_object_add(addr, "deprecated", json_object_new_boolean(1));
+    if (flags & IFA_F_NOPREFIXROUTE)
+        json_object_object_add(addr, "noprefixroute", json_object_new_boolean(1));
+    if (tb[IFA_LABEL])
+        add_string(addr, "label", rta_getattr_str(tb[IFA_LABEL]));
+    if (tb[IFA_CACHEINFO]) {
+        struct ifa_cacheinfo *ci = RTA_DATA(tb[IFA_CACHEINFO]);
+        add_uint(addr, "valid_life_time", ci->ifa_valid);
+        add_uint(addr, "preferred_life_time", ci->ifa_prefered);
+    }
+    json_object_array_add(addr_info, addr);
+    return 0;
+}
+
+static int nl_links_msg(struct nlmsghdr *n, void *arg)
+{
+    struct nl_links *links = arg;
+
+    if (n->nlmsg_type == RTM_NEWLINK)
+        return link_msg_to_row(n, links);
+    if (n->nlmsg_type == RTM_NEWADDR)
+        return addr_msg_to_row(n, links);
+    return 0;
+}
+
+/**
+ * complete the link rows once all links are known: link and master names, flags and the kind
+ * specific objects printed by print_link_kind_data().
+ * @param [in,out] links decoded links.
+ * @param [in] kind_data json array of the kind specific objects, one per link.
+ */
+static void complete_link_rows(struct nl_links *links, struct json_object *kind_data)
+{
+    if (json_object_get_type(kind_data) != json_type_array) {
+        fprintf(stderr, "%s: failed to parse the link kinds data\n", __func__);
+        kind_data = NULL;
+    }
+    for (int i = 0; i < links->count; i++) {
+        struct nl_link *link = &links->links[i];
+        struct nl_link *parent = NULL;
+        struct json_object *linkinfo, *data;
+
+        if (link->iflink && link->iflink_netns) {
+            json_object_object_add(link->row, "link_index", json_object_new_int(link->iflink));
+        } else if (link->iflink && link->iflink != link->ifindex) {
+            parent = find_nl_link(links, link->iflink);
+            add_link_name(link->row, "link", parent, link->iflink);
+        }
+        json_object_object_add(link->row, "flags",
+                               link_flags_jobj(link->flags, parent && !(parent->flags & IFF_UP)));
+        if (link->master)
+            add_link_name(link->row, "master", find_nl_link(links, link->master), link->master);
+
+        if (kind_data == NULL || !json_object_object_get_ex(link->row, "linkinfo", &linkinfo))
+            continue;
+        struct json_object *link_kind_data = json_object_array_get_idx(kind_data, i);
+        if (json_object_object_get_ex(link_kind_data, "info_data", &data))
+            json_object_object_add(linkinfo, "info_data", json_object_get(data));
+        if (json_object_object_get_ex(link_kind_data, "info_slave_data", &data))
+            json_object_object_add(linkinfo, "info_slave_data", json_object_get(data));
+    }
+}
+
+struct json_object *nl_decode_links(const char *netns, const struct dump_filter *filter)
+{
+    static const int dump_types[] = { RTM_GETLINK, RTM_GETADDR };
+    struct nl_links links = { 0 };
+    struct json_object *rows = NULL, *kind_data = NULL;
+    int ret;
+
+    links.by_index = lh_kptr_table_new(64, NULL);
+    if (links.by_index == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+
+    /* the kind printers write to the iproute2 json writer, its output lands in json_buffer */
+    new_json_obj(json);
+    ret = dump_rtnl_objects(netns, filter, dump_types, sizeof(dump_types) / sizeof(dump_types[0]),
+                            nl_links_msg, &links);
+    delete_json_obj();
+    if (ret != EXIT_SUCCESS) {
+        fprintf(stderr, "%s: failed to dump links of netns %s\n", __func__, netns);
+        goto cleanup;
+    }
+
+    kind_data = json_tokener_parse(json_buffer);
+    complete_link_rows(&links, kind_data);
+    rows = json_object_new_array_ext(links.count);
+    for (int i = 0; i < links.count; i++) {
+        json_object_array_add(rows, links.links[i].row);
+        links.links[i].row = NULL;
+    }
+
+cleanup:
+    for (int i = 0; i < links.count; i++)
+        json_object_put(links.links[i].row);
+    json_object_put(kind_data);
+    free(links.links);
+    lh_table_free(links.by_index);
+    return rows;
+}
+
+static void free_ifname_entry(struct lh_entry *entry)
+{
+    free(lh_entry_v(entry));
+}
+
+/**
+ * add an interface name member, the names are looked up once per decode, in the dumped netns.
+ * @param [in,out] row json row.
+ * @param [in] key member key.
+ * @param [in,out] ifnames ifindex -> name cache of the decode.
+ * @param [in] ifindex interface index.
+ */
+static void add_ifname(struct json_object *row, const char *key, struct lh_table *ifnames,
+                       int ifindex)
+{
+    char buf[IF_NAMESIZE + 8];
+    void *name = NULL;
+
+    if (!lh_table_lookup_ex(ifnames, (void *)(uintptr_t)ifindex, &name)) {
+        if (if_indextoname(ifindex, buf) == NULL)
+            snprintf(buf, sizeof(buf), "if%d", ifindex);
+        name = strdup(buf);
+        if (name && lh_table_insert(ifnames, (void *)(uintptr_t)ifindex, name)) {
+            free(name);
+            name = NULL;
+        }
+        if (name == NULL) {
+            add_string(row, key, buf);
+            return;
+        }
+    }
+    add_string(row, key, name);
+}
+
+static struct json_object *rt_flags_jobj(unsigned int flags)
+{
+    struct json_object *flags_jobj = json_object_new_array();
+
+    for (size_t i = 0; i < sizeof(rt_flags) / sizeof(rt_flags[0]); i++) {
+        if (flags & rt_flags[i].flag)
+            json_object_array_add(flags_jobj, json_object_new_string(rt_flags[i].name));
+    }
+    return flags_jobj;
+}
+
+/**
+ * add a route prefix member, host prefixes are printed without their length.
+ * @param [in,out] row route row.
+ * @param [in] key member key.
+ * @param [in] family route family.
+ * @param [in] addr prefix address attribute, NULL for the zero address.
+ * @param [in] len prefix length.
+ */
+static void add_route_prefix(struct json_object *row, const char *key, int family,
+                             const struct rtattr *addr, int len)
+{
+    char buf[256];
+
+    if (addr == NULL && len == 0)
+        snprintf(buf, sizeof(buf), "default");
+    else if (addr == NULL)
+        snprintf(buf, sizeof(buf), "0/%d", len);
+    else if (len != af_bit_len(family))
+        snprintf(buf, sizeof(buf), "%s/%d", rt_addr_n2a_rta(family, addr), len);
+    else
+        snprintf(buf, sizeof(buf), "%s", rt_addr_n2a_rta(family, addr));
+    add_string(row, key, buf);
+}
+
+static struct json_object *route_via_jobj(const struct rtattr *via_attr)
+{
+    const struct rtvia *via = RTA_DATA(via_attr);
+    struct json_object *via_jobj = json_object_new_object();
+
+    add_string(via_jobj, "family", family_name(via->rtvia_family));
+    add_string(via_jobj, "host",
+               rt_addr_n2a(via->rtvia_family, RTA_PAYLOAD(via_attr) - sizeof(via->rtvia_family),
+                           via->rtvia_addr));
+    return via_jobj;
+}
+
+static struct json_object *route_metrics_jobj(const struct rtattr *metrics_attr)
+{
+    struct rtattr *mxrta[RTAX_MAX + 1];
+    struct json_object *metrics = json_object_new_array();
+    struct json_object *metrics_jobj = json_object_new_object();
+
+    parse_rtattr_nested(mxrta, RTAX_MAX, (struct rtattr *)metrics_attr);
+    for (int i = 0; i <= RTAX_MAX; i++) {
+        if (mxrta[i] == NULL)
+            continue;
+        if (i == RTAX_CC_ALGO)
+            add_string(metrics_jobj, "congctl", rta_getattr_str(mxrta[i]));
+        else if (route_metrics[i])
+            add_uint(metrics_jobj, route_metrics[i], rta_getattr_u32(mxrta[i]));
+    }
+    json_object_array_add(metrics, metrics_jobj);
+    return metrics;
+}
+
+static struct json_object *route_nexthops_jobj(const struct rtmsg *r,
+                                               const struct rtattr *multipath_attr,
+                                               struct lh_table *ifnames)
+{
+    struct json_object *nexthops = json_object_new_array();
+    struct rtnexthop *nh = RTA_DATA(multipath_attr);
+    int len = RTA_PAYLOAD(multipath_attr);
+
+    while (len >= (int)sizeof(*nh) && nh->rtnh_len >= sizeof(*nh) && nh->rtnh_len <= len) {
+        struct json_object *nh_jobj = json_object_new_object();
+
+        if (nh->rtnh_len > sizeof(*nh)) {
+            struct rtattr *tb[RTA_MAX + 1];
+            parse_rtattr(tb, RTA_MAX, RTNH_DATA(nh), nh->rtnh_len - sizeof(*nh));
+            if (tb[RTA_NEWDST])
+                add_string(nh_jobj, "to", rt_addr_n2a_rta(r->rtm_family, tb[RTA_NEWDST]));
+            if (tb[RTA_GATEWAY])
+                add_string(nh_jobj, "gateway", rt_addr_n2a_rta(r->rtm_family, tb[RTA_GATEWAY]));
+            if (tb[RTA_VIA])
+                json_object_object_add(nh_jobj, "via", route_via_jobj(tb[RTA_VIA]));
+        }
+        if (nh->rtnh_ifindex)
+            add_ifname(nh_jobj, "dev", ifnames, nh->rtnh_ifindex);
+        if (r->rtm_family != AF_MPLS)
+            add_uint(nh_jobj, "weight", nh->rtnh_hops + 1);
+        json_object_object_add(nh_jobj, "flags", rt_flags_jobj(nh->rtnh_flags));
+        json_object_array_add(nexthops, nh_jobj);
+
+        len -= RTNH_ALIGN(nh->rtnh_len);
+        nh = RTNH_NEXT(nh);
+    }
+    return nexthops;
+}
+
+/**
+ * get the rows array of a family group, the group is added if the family has none yet.
+ * @param [in,out] groups json array of {"family": name, "rows": [...]} groups.
+ * @param [in] family address family.
+ * @return rows array of the family group.
+ */
+static struct json_object *route_family_rows(struct json_object *groups, int family)
+{
+    const char *name = family_name(family);
+    struct json_object *group, *rows;
+
+    for (size_t i = 0; i < json_object_array_length(groups); i++) {
+        group = json_object_array_get_idx(groups, i);
+        if (!strcmp(json_object_get_string(json_object_object_get(group, "family")), name))
+            return json_object_object_get(group, "rows");
+    }
+    group = json_object_new_object();
+    rows = json_object_new_array();
+    add_string(group, "family", name);
+    json_object_object_add(group, "rows", rows);
+    json_object_array_add(groups, group);
+    return rows;
+}
+
+static int route_msg_to_row(struct nlmsghdr *n, void *arg)
+{
+    struct nl_dump_rows *dump = arg;
+    struct rtmsg *r = NLMSG_DATA(n);
+    struct rtattr *tb[RTA_MAX + 1];
+    char buf[256];
+
+    if (n->nlmsg_type != RTM_NEWROUTE)
+        return 0;
+    if (n->nlmsg_len < NLMSG_LENGTH(sizeof(*r)))
+        return -1;
+    /* cached clones are only listed by "ip route list cache" */
+    if (r->rtm_flags & RTM_F_CLONED)
+        return 0;
+    parse_rtattr(tb, RTA_MAX, RTM_RTA(r), n->nlmsg_len - NLMSG_LENGTH(sizeof(*r)));
+
+    struct json_object *row = json_object_new_object();
+    add_string(row, "type", rtnl_rtntype_n2a(r->rtm_type, buf, sizeof(buf)));
+    add_route_prefix(row, "dst", r->rtm_family, tb[RTA_DST], r->rtm_dst_len);
+    if (tb[RTA_SRC] || r->rtm_src_len)
+        add_route_prefix(row, "from", r->rtm_family, tb[RTA_SRC], r->rtm_src_len);
+    if (tb[RTA_NH_ID])
+        add_uint(row, "nhid", rta_getattr_u32(tb[RTA_NH_ID]));
+    if (tb[RTA_NEWDST])
+        add_string(row, "to", rt_addr_n2a_rta(r->rtm_family, tb[RTA_NEWDST]));
+    if (r->rtm_tos)
+        add_string(row, "tos", rtnl_dsfield_n2a(r->rtm_tos, buf, sizeof(buf)));
+    if (tb[RTA_GATEWAY])
+        add_string(row, "gateway", rt_addr_n2a_rta(r->rtm_family, tb[RTA_GATEWAY]));
+    if (tb[RTA_VIA])
+        json_object_object_add(row, "via", route_via_jobj(tb[RTA_VIA]));
+    if (tb[RTA_OIF])
+        add_ifname(row, "dev", dump->ifnames, rta_getattr_u32(tb[RTA_OIF]));
+    add_string(row, "table", rtnl_rttable_n2a(rtm_get_table(r, tb), buf, sizeof(buf)));
+    add_string(row, "protocol", rtnl_rtprot_n2a(r->rtm_protocol, buf, sizeof(buf)));
+    add_string(row, "scope", rtnl_rtscope_n2a(r->rtm_scope, buf, sizeof(buf)));
+    if (tb[RTA_PREFSRC])
+        add_string(row, "prefsrc", rt_addr_n2a_rta(r->rtm_family, tb[RTA_PREFSRC]));
+    if (tb[RTA_PRIORITY])
+        add_uint(row, "metric", rta_getattr_u32(tb[RTA_PRIORITY]));
+    json_object_object_add(row, "flags", rt_flags_jobj(r->rtm_flags));
+    if (tb[RTA_METRICS])
+        json_object_object_add(row, "metrics", route_metrics_jobj(tb[RTA_METRICS]));
+    if (tb[RTA_MULTIPATH])
+        json_object_object_add(row, "nexthops",
+                               route_nexthops_jobj(r, tb[RTA_MULTIPATH], dump->ifnames));
+    if (tb[RTA_PREF]) {
+        __u8 pref = rta_getattr_u8(tb[RTA_PREF]);
+        if (pref < sizeof(route_prefs) / sizeof(route_prefs[0]) && route_prefs[pref])
+            add_string(row, "pref", route_prefs[pref]);
+        else
+            add_uint(row, "pref", pref);
+    }
+
+    json_object_array_add(route_family_rows(dump->rows, r->rtm_family), row);
+    return 0;
+}
+
+static int nexthop_msg_to_row(struct nlmsghdr *n, void *arg)
+{
+    struct nl_dump_rows *dump = arg;
+    struct nhmsg *nhm = NLMSG_DATA(n);
+    struct rtattr *tb[NHA_MAX + 1];
+    char buf[256];
+
+    if (n->nlmsg_type != RTM_NEWNEXTHOP)
+        return 0;
+    if (n->nlmsg_len < NLMSG_LENGTH(sizeof(*nhm)))
+        return -1;
+    parse_rtattr(tb, NHA_MAX, (struct rtattr *)((char *)nhm + NLMSG_ALIGN(sizeof(*nhm))),
+                 n->nlmsg_len - NLMSG_LENGTH(sizeof(*nhm)));
+
+    struct json_object *row = json_object_new_object();
+    if (tb[NHA_ID])
+        add_uint(row, "id", rta_getattr_u32(tb[NHA_ID]));
+    if (tb[NHA_GROUP]) {
+        const struct nexthop_grp *nhg = RTA_DATA(tb[NHA_GROUP]);
+        struct json_object *group = json_object_new_array();
+        for (size_t i = 0; i < RTA_PAYLOAD(tb[NHA_GROUP]) / sizeof(*nhg); i++) {
+            struct json_object *nh_jobj = json_object_new_object();
+            add_uint(nh_jobj, "id", nhg[i].id);
+            if (nhg[i].weight)
+                add_uint(nh_jobj, "weight", nhg[i].weight + 1);
+            json_object_array_add(group, nh_jobj);
+        }
+        json_object_object_add(row, "group", group);
+    }
+    if (tb[NHA_GROUP_TYPE] && rta_getattr_u16(tb[NHA_GROUP_TYPE]) == NEXTHOP_GRP_TYPE_RES)
+        add_string(row, "type", "resilient");
+    if (tb[NHA_GATEWAY])
+        add_string(row, "gateway", rt_addr_n2a_rta(nhm->nh_family, tb[NHA_GATEWAY]));
+    if (tb[NHA_OIF])
+        add_ifname(row, "dev", dump->ifnames, rta_getattr_u32(tb[NHA_OIF]));
+    add_string(row, "scope", rtnl_rtscope_n2a(nhm->nh_scope, buf, sizeof(buf)));
+    if (tb[NHA_BLACKHOLE])
+        json_object_object_add(row, "blackhole", NULL);
+    add_string(row, "protocol", rtnl_rtprot_n2a(nhm->nh_protocol, buf, sizeof(buf)));
+    json_object_object_add(row, "flags", rt_flags_jobj(nhm->nh_flags));
+    if (tb[NHA_FDB])
+        json_object_object_add(row, "fdb", NULL);
+
+    json_object_array_add(dump->rows, row);
+    return 0;
+}
+
+/**
+ * dump one type of rtnl objects of a netns and decode the messages into json rows.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [in] filter dump filter applied on the messages, NULL for none.
+ * @param [in] dump_type RTM_GET* dump request type.
+ * @param [in] msg_cb decoder of one message, appending its row to the nl_dump_rows.
+ * @return json array of the rows, NULL on failure.
+ */
+static struct json_object *decode_dump_rows(const char *netns, const struct dump_filter *filter,
+                                            int dump_type, rtnl_filter_t msg_cb)
+{
+    struct nl_dump_rows dump = { 0 };
+
+    dump.ifnames = lh_kptr_table_new(64, free_ifname_entry);
+    dump.rows = json_object_new_array();
+    if (dump.ifnames == NULL || dump.rows == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        goto cleanup;
+    }
+    if (dump_rtnl_objects(netns, filter, &dump_type, 1, msg_cb, &dump) != EXIT_SUCCESS) {
+        fprintf(stderr, "%s: failed to dump netns %s\n", __func__, netns);
+        json_object_put(dump.rows);
+        dump.rows = NULL;
+    }
+
+cleanup:
+    if (dump.ifnames)
+        lh_table_free(dump.ifnames);
+    return dump.rows;
+}
+
+struct json_object *nl_decode_routes(const char *netns, const struct dump_filter *filter)
+{
+    return decode_dump_rows(netns, filter, RTM_GETROUTE, route_msg_to_row);
+}
+
+struct json_object *nl_decode_nexthops(const char *netns, const struct dump_filter *filter)
+{
+    return decode_dump_rows(netns, filter, RTM_GETNEXTHOP, nexthop_msg_to_row);
+}
@@ -0,0 +1,37 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+#ifndef IPROUTE2_SYSREPO_NL_DECODER_H
+#define IPROUTE2_SYSREPO_NL_DECODER_H
+
+#include "json-c/json.h"
+#include "oper_data.h"
+
+/**
+ * dump the links and addresses of a netns and decode them from the netlink attributes into the
+ * json rows printed by "ip -d -s address show", without going through the iproute2 json text.
+ * Only the kind specific info_data and info_slave_data objects are printed by the iproute2 link
+ * kinds printers, the other row members are built directly.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [in] filter dump filter applied on the messages, NULL for none.
+ * @return json array of the link rows, NULL on failure.
+ */
+struct json_object *nl_decode_links(const char *netns, const struct dump_filter *filter);
+
+/**
+ * dump the routes of all tables and families of a netns and decode them into the json rows
+ * printed by "ip -d route list table all", grouped by family like a group_by_family dump.
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [in] filter dump filter applied on the messages, NULL for none.
+ * @return json array of {"family": name, "rows": [...]} groups, NULL on failure.
+ */
+struct json_object *nl_decode_routes(const char *netns, const struct dump_filter *filter);
+
+/**
+ * dump the nexthops of a netns and decode them into the json rows printed by
+ * "ip -d nexthop show".
+ * @param [in] netns network namespace name, "1" for the default one.
+ * @param [in] filter dump filter applied on the messages, NULL for none.
+ * @return json array of the nexthop rows, NULL on failure.
+ */
+struct json_object *nl_decode_nexthops(const char *netns, const struct dump_filter *filter);
+
+#endif // IPROUTE2_SYSREPO_NL_DECODER_H
@@ -0,0 +1,724 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+/*
+ * Authors:     Ali Aqrabawi, <aaqrbaw@okdanetworks.com>
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU Affero General Public
+ *              License Version 3.0 as published by the Free Software Foundation;
+ *              either version 3.0 of the License, or (at your option) any later
+ *              version.
+ *
+ * Copyright (C) 2024 Okda Networks, <aaqrbaw@okdanetworks.com>
+ */
+
+#define _GNU_SOURCE /* sendmmsg() */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <linux/rtnetlink.h>
+#include <linux/lwtunnel.h>
+#include <linux/mpls_iptunnel.h>
+#include <linux/nexthop.h>
+
+/* common iproute2 */
+#include "utils.h"
+#include "rt_names.h"
+
+#include "nl_encoder.h"
+
+#define NL_REQUEST_SIZE 4096
+#define NL_BATCH_MSG_SIZE 16384 /* stays below the 32k send buffer set by rtnl_open() */
+#define NL_BATCH_RECV_SIZE 32768
+
+static int encode_route(const struct lyd_node *route, nl_request_op_t op,
+                        struct nl_request *req);
+static int encode_mpls_route(const struct lyd_node *route, nl_request_op_t op,
+                             struct nl_request *req);
+static int encode_nexthop(const struct lyd_node *nexthop, nl_request_op_t op,
+                          struct nl_request *req);
+
+/* startcmd lists having a native netlink encoder, the encoders are enabled per module */
+static struct nl_encoder {
+    const char *module;
+    const char *list;
+    int (*encode)(const struct lyd_node *startcmd, nl_request_op_t op, struct nl_request *req);
+    bool enabled;
+} nl_encoders[] = {
+    { "iproute2-ip-route", "route", encode_route },
+    { "iproute2-ip-route", "mpls-route", encode_mpls_route },
+    { "iproute2-ip-nexthop", "nexthop", encode_nexthop },
+};
+
+static bool node_deleted(const struct lyd_node *dnode)
+{
+    struct lyd_meta *meta = lyd_find_meta(dnode->meta, NULL, "yang:operation");
+
+    return meta && !strcmp(lyd_get_meta_value(meta), "delete");
+}
+
+/**
+ * find a child node by its schema name.
+ * @param [in] parent parent node, can be NULL.
+ * @param [in] name child schema node name.
+ * @return child node, NULL if not found or deleted by the change.
+ */
+static const struct lyd_node *find_child(const struct lyd_node *parent, const char *name)
+{
+    const struct lyd_node *child;
+
+    if (parent == NULL)
+        return NULL;
+    LY_LIST_FOR(lyd_child(parent), child)
+    {
+        if (!strcmp(child->schema->name, name))
+            return node_deleted(child) ? NULL : child;
+    }
+    return NULL;
+}
+
+static const char *child_value(const struct lyd_node *parent, const char *name)
+{
+    const struct lyd_node *child = find_child(parent, name);
+
+    return child ? lyd_get_value(child) : NULL;
+}
+
+static bool child_flag(const struct lyd_node *parent, const char *name)
+{
+    const char *value = child_value(parent, name);
+
+    return value && !strcmp(value, "true");
+}
+
+/**
+ * parse an address or prefix value, on a copy as iproute2 edits the prefix string while parsing.
+ * @param [out] addr parsed address.
+ * @param [in] value address or prefix value.
+ * @param [in] family expected family, AF_UNSPEC for any.
+ * @param [in] prefix true to parse a prefix.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int parse_addr(inet_prefix *addr, const char *value, int family, bool prefix)
+{
+    char buf[256];
+
+    if (snprintf(buf, sizeof(buf), "%s", value) >= (int)sizeof(buf))
+        return EXIT_FAILURE;
+    memset(addr, 0, sizeof(*addr));
+    if (prefix ? get_prefix_1(addr, buf, family) : get_addr_1(addr, buf, family))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * add a device reference to a request, its ifindex field is written by
+ * nl_request_resolve_devs().
+ * @param [in,out] req netlink request.
+ * @param [in] ifindex_field ifindex field in the request message.
+ * @param [in] name device name.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int add_dev(struct nl_request *req, const void *ifindex_field, const char *name)
+{
+    struct nl_request_dev *devs;
+
+    if (strlen(name) >= IFNAMSIZ)
+        return EXIT_FAILURE;
+    devs = realloc(req->devs, (req->n_devs + 1) * sizeof(*devs));
+    if (devs == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return EXIT_FAILURE;
+    }
+    req->devs = devs;
+    devs[req->n_devs].offset = (const char *)ifindex_field - (const char *)req->n;
+    snprintf(devs[req->n_devs].name, sizeof(devs[req->n_devs].name), "%s", name);
+    req->n_devs++;
+    return EXIT_SUCCESS;
+}
+
+static int add_dev_attr(struct nl_request *req, int type, const char *name)
+{
+    struct rtattr *rta = NLMSG_TAIL(req->n);
+
+    if (addattr32(req->n, NL_REQUEST_SIZE, type, 0) < 0)
+        return EXIT_FAILURE;
+    return add_dev(req, RTA_DATA(rta), name);
+}
+
+/* addattr_nest() does not check the message bound */
+static struct rtattr *add_nest(struct nlmsghdr *n, int type)
+{
+    if (NLMSG_ALIGN(n->nlmsg_len) + RTA_LENGTH(0) > NL_REQUEST_SIZE)
+        return NULL;
+    return addattr_nest(n, NL_REQUEST_SIZE, type);
+}
+
+static int add_via(struct nlmsghdr *n, int type, const inet_prefix *gw)
+{
+    char buf[sizeof(struct rtvia) + sizeof(gw->data)];
+    struct rtvia *via = (struct rtvia *)buf;
+
+    via->rtvia_family = gw->family;
+    memcpy(via->rtvia_addr, gw->data, gw->bytelen);
+    return addattr_l(n, NL_REQUEST_SIZE, type, buf, sizeof(via->rtvia_family) + gw->bytelen);
+}
+
+/**
+ * add a mpls lwtunnel encap, of a route nexthop or of a nexthop object.
+ * @param [in,out] n netlink message.
+ * @param [in] type_attr encap type attribute, RTA_ENCAP_TYPE or NHA_ENCAP_TYPE.
+ * @param [in] encap_attr encap attribute, RTA_ENCAP or NHA_ENCAP.
+ * @param [in] labels label stack.
+ * @param [in] ttl mpls ttl value, NULL if not set.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int add_mpls_encap(struct nlmsghdr *n, int type_attr, int encap_attr, const char *labels,
+                          const char *ttl)
+{
+    inet_prefix addr;
+    struct rtattr *nest;
+    __u8 ttl_val = 0;
+
+    if (parse_addr(&addr, labels, AF_MPLS, false) != EXIT_SUCCESS ||
+        (ttl && get_u8(&ttl_val, ttl, 0)))
+        return EXIT_FAILURE;
+    if (addattr16(n, NL_REQUEST_SIZE, type_attr, LWTUNNEL_ENCAP_MPLS) < 0)
+        return EXIT_FAILURE;
+    nest = add_nest(n, encap_attr);
+    if (nest == NULL || addattr_l(n, NL_REQUEST_SIZE, MPLS_IPTUNNEL_DST, addr.data,
+                                  addr.bytelen) < 0)
+        return EXIT_FAILURE;
+    if (ttl && addattr8(n, NL_REQUEST_SIZE, MPLS_IPTUNNEL_TTL, ttl_val) < 0)
+        return EXIT_FAILURE;
+    addattr_nest_end(n, nest);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * initialize a route request header, with the defaults of "ip route" for the operation.
+ * @param [in,out] n netlink message.
+ * @param [in] op request operation.
+ */
+static void init_route_msg(struct nlmsghdr *n, nl_request_op_t op)
+{
+    struct rtmsg *r = NLMSG_DATA(n);
+
+    n->nlmsg_len = NLMSG_LENGTH(sizeof(*r));
+    n->nlmsg_type = op == NL_REQUEST_DELETE ? RTM_DELROUTE : RTM_NEWROUTE;
+    n->nlmsg_flags = NLM_F_REQUEST;
+    if (op == NL_REQUEST_ADD)
+        n->nlmsg_flags |= NLM_F_CREATE | NLM_F_EXCL;
+    else if (op == NL_REQUEST_REPLACE)
+        n->nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
+    r->rtm_table = RT_TABLE_MAIN;
+    r->rtm_scope = RT_SCOPE_NOWHERE;
+    if (op != NL_REQUEST_DELETE) {
+        r->rtm_protocol = RTPROT_BOOT;
+        r->rtm_scope = RT_SCOPE_UNIVERSE;
+        r->rtm_type = RTN_UNICAST;
+    }
+}
+
+/**
+ * get the family of a route, a default route takes the family of its source or first gateway
+ * like "ip route" does.
+ * @param [in] route route list entry.
+ * @param [in] dst parsed route prefix.
+ * @return route family.
+ */
+static int route_family(const struct lyd_node *route, const inet_prefix *dst)
+{
+    const struct lyd_node *child;
+    const char *value;
+
+    if (dst->family != AF_UNSPEC)
+        return dst->family;
+    value = child_value(route, "src");
+    if (value)
+        return strchr(value, ':') ? AF_INET6 : AF_INET;
+    LY_LIST_FOR(lyd_child(route), child)
+    {
+        if (strcmp(child->schema->name, "nexthop") || node_deleted(child))
+            continue;
+        const struct lyd_node *via = find_child(child, "via");
+        const char *family = child_value(via, "family");
+        value = child_value(via, "address");
+        if (family && read_family(family) != AF_UNSPEC)
+            return read_family(family);
+        if (value)
+            return strchr(value, ':') ? AF_INET6 : AF_INET;
+    }
+    return AF_INET;
+}
+
+/**
+ * add a route nexthop list entry to the open RTA_MULTIPATH attribute.
+ * @param [in] nh nexthop list entry.
+ * @param [in] r route message header.
+ * @param [in,out] req netlink request.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the nexthop can't be encoded.
+ */
+static int encode_route_nexthop(const struct lyd_node *nh, const struct rtmsg *r,
+                                struct nl_request *req)
+{
+    struct nlmsghdr *n = req->n;
+    const struct lyd_node *via = find_child(nh, "via"), *mpls = find_child(nh, "mpls-encap");
+    const char *value;
+    struct rtnexthop *rtnh;
+    __u32 weight = 1;
+
+    /* ip encap ids and tunnel keys are left to iproute2 */
+    if (find_child(nh, "ip-encap"))
+        return EXIT_FAILURE;
+    if (NLMSG_ALIGN(n->nlmsg_len) + RTNH_ALIGN(sizeof(*rtnh)) > NL_REQUEST_SIZE)
+        return EXIT_FAILURE;
+    rtnh = (struct rtnexthop *)NLMSG_TAIL(n);
+    memset(rtnh, 0, sizeof(*rtnh));
+    n->nlmsg_len = NLMSG_ALIGN(n->nlmsg_len) + RTNH_ALIGN(sizeof(*rtnh));
+
+    value = child_value(nh, "dev");
+    if (value && add_dev(req, &rtnh->rtnh_ifindex, value) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    value = child_value(nh, "weight");
+    if (value && (get_u32(&weight, value, 0) || weight == 0 || weight > 256))
+        return EXIT_FAILURE;
+    rtnh->rtnh_hops = weight - 1;
+
+    value = child_value(via, "address");
+    if (value) {
+        const char *family = child_value(via, "family");
+        inet_prefix gw;
+        if (parse_addr(&gw, value, family ? read_family(family) : r->rtm_family, false) !=
+            EXIT_SUCCESS)
+            return EXIT_FAILURE;
+        if (gw.family == r->rtm_family) {
+            if (addattr_l(n, NL_REQUEST_SIZE, RTA_GATEWAY, gw.data, gw.bytelen) < 0)
+                return EXIT_FAILURE;
+        } else if (add_via(n, RTA_VIA, &gw) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+    value = child_value(mpls, "label");
+    if (value && add_mpls_encap(n, RTA_ENCAP_TYPE, RTA_ENCAP, value, NULL) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+
+    rtnh->rtnh_len = (char *)NLMSG_TAIL(n) - (char *)rtnh;
+    return EXIT_SUCCESS;
+}
+
+static int encode_route(const struct lyd_node *route, nl_request_op_t op, struct nl_request *req)
+{
+    struct nlmsghdr *n = req->n;
+    struct rtmsg *r = NLMSG_DATA(n);
+    const struct lyd_node *child;
+    struct rtattr *nest = NULL;
+    const char *value;
+    inet_prefix dst, addr;
+    __u32 id;
+
+    init_route_msg(n, op);
+
+    /* keys, the only attributes a route delete is matched on */
+    value = child_value(route, "prefix");
+    if (value == NULL || parse_addr(&dst, value, AF_UNSPEC, true) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    r->rtm_family = route_family(route, &dst);
+    r->rtm_dst_len = dst.bitlen;
+    if (dst.bytelen && addattr_l(n, NL_REQUEST_SIZE, RTA_DST, dst.data, dst.bytelen) < 0)
+        return EXIT_FAILURE;
+    value = child_value(route, "table");
+    if (value) {
+        if (rtnl_rttable_a2n(&id, value))
+            return EXIT_FAILURE;
+        if (id < 256) {
+            r->rtm_table = id;
+        } else {
+            r->rtm_table = RT_TABLE_UNSPEC;
+            if (addattr32(n, NL_REQUEST_SIZE, RTA_TABLE, id) < 0)
+                return EXIT_FAILURE;
+        }
+    }
+    value = child_value(route, "metric");
+    if (value && (get_u32(&id, value, 0) || addattr32(n, NL_REQUEST_SIZE, RTA_PRIORITY, id) < 0))
+        return EXIT_FAILURE;
+    value = child_value(route, "tos");
+    if (value && strcmp(value, "default") != 0) {
+        if (rtnl_dsfield_a2n(&id, value))
+            return EXIT_FAILURE;
+        r->rtm_tos = id;
+    }
+    if (op == NL_REQUEST_DELETE)
+        return EXIT_SUCCESS;
+
+    value = child_value(route, "src");
+    if (value && (parse_addr(&addr, value, r->rtm_family, false) != EXIT_SUCCESS ||
+                  addattr_l(n, NL_REQUEST_SIZE, RTA_PREFSRC, addr.data, addr.bytelen) < 0))
+        return EXIT_FAILURE;
+    value = child_value(route, "protocol");
+    if (value) {
+        if (rtnl_rtprot_a2n(&id, value))
+            return EXIT_FAILURE;
+        r->rtm_protocol = id;
+    }
+    value = child_value(route, "flag");
+    if (value)
+        r->rtm_flags |= !strcmp(value, "onlink") ? RTNH_F_ONLINK : RTNH_F_PERVASIVE;
+
+    if (child_value(route, "mtu") || child_value(route, "advmss")) {
+        nest = add_nest(n, RTA_METRICS);
+        if (nest == NULL)
+            return EXIT_FAILURE;
+        value = child_value(route, "mtu");
+        if (value &&
+            (get_u32(&id, value, 0) || addattr32(n, NL_REQUEST_SIZE, RTAX_MTU, id) < 0))
+            return EXIT_FAILURE;
+        value = child_value(route, "advmss");
+        if (value &&
+            (get_u32(&id, value, 0) || addattr32(n, NL_REQUEST_SIZE, RTAX_ADVMSS, id) < 0))
+            return EXIT_FAILURE;
+        addattr_nest_end(n, nest);
+        nest = NULL;
+    }
+
+    /* "ip route" sends the nexthop arguments as a multipath attribute, even a single one */
+    LY_LIST_FOR(lyd_child(route), child)
+    {
+        if (strcmp(child->schema->name, "nexthop") || node_deleted(child))
+            continue;
+        if (nest == NULL && (nest = add_nest(n, RTA_MULTIPATH)) == NULL)
+            return EXIT_FAILURE;
+        if (encode_route_nexthop(child, r, req) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+    }
+    if (nest)
+        addattr_nest_end(n, nest);
+
+    value = child_value(route, "scope");
+    if (value) {
+        if (rtnl_rtscope_a2n(&id, (char *)value))
+            return EXIT_FAILURE;
+        r->rtm_scope = id;
+    } else if (r->rtm_family == AF_INET && nest == NULL) {
+        r->rtm_scope = RT_SCOPE_LINK;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int encode_mpls_route(const struct lyd_node *route, nl_request_op_t op,
+                             struct nl_request *req)
+{
+    struct nlmsghdr *n = req->n;
+    struct rtmsg *r = NLMSG_DATA(n);
+    const char *value;
+    inet_prefix addr;
+
+    init_route_msg(n, op);
+    r->rtm_family = AF_MPLS;
+    value = child_value(route, "label");
+    if (value == NULL || parse_addr(&addr, value, AF_MPLS, false) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    r->rtm_dst_len = addr.bitlen;
+    if (addattr_l(n, NL_REQUEST_SIZE, RTA_DST, addr.data, addr.bytelen) < 0)
+        return EXIT_FAILURE;
+    if (op == NL_REQUEST_DELETE)
+        return EXIT_SUCCESS;
+
+    value = child_value(route, "swap");
+    if (value && (parse_addr(&addr, value, AF_MPLS, false) != EXIT_SUCCESS ||
+                  addattr_l(n, NL_REQUEST_SIZE, RTA_NEWDST, addr.data, addr.bytelen) < 0))
+        return EXIT_FAILURE;
+    value = child_value(route, "dev");
+    if (value && add_dev_attr(req, RTA_OIF, value) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    value = child_value(route, "via");
+    if (value && (parse_addr(&addr, value, AF_INET, false) != EXIT_SUCCESS ||
+                  add_via(n, RTA_VIA, &addr) < 0))
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * add the group attributes of a nexthop group.
+ * @param [in,out] n netlink message.
+ * @param [in] group nexthop group container.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the group can't be encoded.
+ */
+static int encode_nexthop_group(struct nlmsghdr *n, const struct lyd_node *group)
+{
+    struct nexthop_grp grps[NL_REQUEST_SIZE / sizeof(struct nexthop_grp)];
+    const struct lyd_node *child;
+    const char *value;
+    struct rtattr *nest;
+    int count = 0;
+    __u32 val;
+
+    LY_LIST_FOR(lyd_child(group), child)
+    {
+        if (strcmp(child->schema->name, "nh") || node_deleted(child))
+            continue;
+        if (count == sizeof(grps) / sizeof(grps[0]))
+            return EXIT_FAILURE;
+        memset(&grps[count], 0, sizeof(grps[count]));
+        value = child_value(child, "id");
+        if (value == NULL || get_u32(&grps[count].id, value, 0))
+            return EXIT_FAILURE;
+        value = child_value(child, "weight");
+        if (value && (get_u32(&val, value, 0) || val == 0 || val > 256))
+            return EXIT_FAILURE;
+        grps[count].weight = value ? val - 1 : 0;
+        count++;
+    }
+    if (count == 0)
+        return EXIT_SUCCESS;
+    if (addattr_l(n, NL_REQUEST_SIZE, NHA_GROUP, grps, count * sizeof(grps[0])) < 0)
+        return EXIT_FAILURE;
+
+    value = child_value(group, "type");
+    if (value == NULL)
+        return EXIT_SUCCESS;
+    if (strcmp(value, "resilient") != 0)
+        return addattr16(n, NL_REQUEST_SIZE, NHA_GROUP_TYPE, NEXTHOP_GRP_TYPE_MPATH) < 0 ?
+                   EXIT_FAILURE :
+                   EXIT_SUCCESS;
+    if (addattr16(n, NL_REQUEST_SIZE, NHA_GROUP_TYPE, NEXTHOP_GRP_TYPE_RES) < 0)
+        return EXIT_FAILURE;
+    nest = add_nest(n, NHA_RES_GROUP);
+    if (nest == NULL)
+        return EXIT_FAILURE;
+    nest->rta_type |= NLA_F_NESTED;
+    value = child_value(group, "resilient-buckets");
+    if (value && (get_u32(&val, value, 0) || val > UINT16_MAX ||
+                  addattr16(n, NL_REQUEST_SIZE, NHA_RES_GROUP_BUCKETS, val) < 0))
+        return EXIT_FAILURE;
+    /* the timers are sent in clock_t units, seconds * 100 */
+    value = child_value(group, "resilient-idle-timer");
+    if (value && (get_u32(&val, value, 0) || val >= UINT32_MAX / 100 ||
+                  addattr32(n, NL_REQUEST_SIZE, NHA_RES_GROUP_IDLE_TIMER, val * 100) < 0))
+        return EXIT_FAILURE;
+    value = child_value(group, "resilient-unbalanced_timer");
+    if (value && (get_u32(&val, value, 0) || val >= UINT32_MAX / 100 ||
+                  addattr32(n, NL_REQUEST_SIZE, NHA_RES_GROUP_UNBALANCED_TIMER, val * 100) < 0))
+        return EXIT_FAILURE;
+    addattr_nest_end(n, nest);
+    return EXIT_SUCCESS;
+}
+
+static int encode_nexthop(const struct lyd_node *nexthop, nl_request_op_t op,
+                          struct nl_request *req)
+{
+    struct nlmsghdr *n = req->n;
+    struct nhmsg *nhm = NLMSG_DATA(n);
+    const struct lyd_node *mpls;
+    const char *value, *dev;
+    inet_prefix gw;
+    __u32 id;
+
+    n->nlmsg_len = NLMSG_LENGTH(sizeof(*nhm));
+    n->nlmsg_type = op == NL_REQUEST_DELETE ? RTM_DELNEXTHOP : RTM_NEWNEXTHOP;
+    n->nlmsg_flags = NLM_F_REQUEST;
+    if (op == NL_REQUEST_ADD)
+        n->nlmsg_flags |= NLM_F_CREATE | NLM_F_EXCL;
+    else if (op == NL_REQUEST_REPLACE)
+        n->nlmsg_flags |= NLM_F_CREATE | NLM_F_REPLACE;
+    value = child_value(nexthop, "id");
+    if (value == NULL || get_u32(&id, value, 0) || addattr32(n, NL_REQUEST_SIZE, NHA_ID, id) < 0)
+        return EXIT_FAILURE;
+    if (op == NL_REQUEST_DELETE)
+        return EXIT_SUCCESS;
+
+    dev = child_value(nexthop, "dev");
+    if (dev && add_dev_attr(req, NHA_OIF, dev) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    value = child_value(find_child(nexthop, "ipv4"), "address");
+    if (value == NULL)
+        value = child_value(find_child(nexthop, "ipv6"), "address");
+    if (value) {
+        if (parse_addr(&gw, value, AF_UNSPEC, false) != EXIT_SUCCESS ||
+            addattr_l(n, NL_REQUEST_SIZE, NHA_GATEWAY, gw.data, gw.bytelen) < 0)
+            return EXIT_FAILURE;
+        nhm->nh_family = gw.family;
+    }
+    if (child_flag(nexthop, "blackhole")) {
+        if (addattr_l(n, NL_REQUEST_SIZE, NHA_BLACKHOLE, NULL, 0) < 0)
+            return EXIT_FAILURE;
+        if (nhm->nh_family == AF_UNSPEC)
+            nhm->nh_family = AF_INET;
+    }
+    // a dev only nexthop has no gateway family, the kernel rejects AF_UNSPEC with NHA_OIF.
+    if (dev && nhm->nh_family == AF_UNSPEC)
+        nhm->nh_family = AF_INET;
+    if (child_flag(nexthop, "onlink"))
+        nhm->nh_flags |= RTNH_F_ONLINK;
+    if (child_flag(nexthop, "fdb") && addattr_l(n, NL_REQUEST_SIZE, NHA_FDB, NULL, 0) < 0)
+        return EXIT_FAILURE;
+    mpls = find_child(nexthop, "mpls");
+    value = child_value(mpls, "label-stack");
+    if (value && add_mpls_encap(n, NHA_ENCAP_TYPE, NHA_ENCAP, value,
+                                child_value(mpls, "ttl")) != EXIT_SUCCESS)
+        return EXIT_FAILURE;
+    return encode_nexthop_group(n, find_child(nexthop, "group"));
+}
+
+int set_nl_encoder(const char *module_name, bool enabled)
+{
+    bool found = false;
+
+    for (size_t i = 0; i < sizeof(nl_encoders) / sizeof(nl_encoders[0]); i++) {
+        if (!strcmp(nl_encoders[i].module, module_name)) {
+            nl_encoders[i].enabled = enabled;
+            found = true;
+        }
+    }
+    if (!found && enabled) {
+        fprintf(stderr, "%s: module %s has no netlink encoder\n", __func__, module_name);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+struct nl_request *nl_encode_startcmd(const struct lyd_node *startcmd, nl_request_op_t op)
+{
+    for (size_t i = 0; i < sizeof(nl_encoders) / sizeof(nl_encoders[0]); i++) {
+        struct nl_encoder *encoder = &nl_encoders[i];
+        if (!encoder->enabled || strcmp(encoder->module, startcmd->schema->module->name) ||
+            strcmp(encoder->list, startcmd->schema->name))
+            continue;
+
+        const char *netns = child_value(startcmd, "netns");
+        struct nl_request *req = calloc(1, sizeof(*req));
+        if (req == NULL || (req->n = calloc(1, NL_REQUEST_SIZE)) == NULL ||
+            (req->netns = strdup(netns ? netns : "1")) == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            free_nl_request(req);
+            return NULL;
+        }
+        if (encoder->encode(startcmd, op, req) != EXIT_SUCCESS) {
+            /* the node is applied by its iproute2 command, which reports the errors */
+            free_nl_request(req);
+            return NULL;
+        }
+        /* transactions can hold many requests, only keep the message length */
+        struct nlmsghdr *n = realloc(req->n, req->n->nlmsg_len);
+        if (n)
+            req->n = n;
+        return req;
+    }
+    return NULL;
+}
+
+int nl_request_resolve_devs(struct nl_request *req)
+{
+    for (int i = 0; i < req->n_devs; i++) {
+        unsigned int ifindex = if_nametoindex(req->devs[i].name);
+        if (ifindex == 0) {
+            fprintf(stderr, "%s: Cannot find device \"%s\"\n", __func__, req->devs[i].name);
+            return EXIT_FAILURE;
+        }
+        memcpy((char *)req->n + req->devs[i].offset, &ifindex, sizeof(ifindex));
+    }
+    return EXIT_SUCCESS;
+}
+
+int nl_requests_send_batch(struct rtnl_handle *rth, struct nl_request *const *reqs, int n_reqs,
+                           int *errors)
+{
+    struct sockaddr_nl nladdr = {.nl_family = AF_NETLINK};
+    struct iovec iov[n_reqs];
+    struct mmsghdr msgs[n_reqs];
+    char buf[NL_BATCH_RECV_SIZE];
+    __u32 seq = rth->seq + 1;
+    size_t msg_len = 0;
+    int n_msgs = 0, pending = 0;
+
+    for (int i = 0; i < n_reqs; i++) {
+        struct nlmsghdr *n = reqs[i]->n;
+
+        n->nlmsg_seq = seq + i;
+        n->nlmsg_flags |= NLM_F_ACK;
+        errors[i] = ECANCELED;
+        iov[i] = (struct iovec){.iov_base = n, .iov_len = n->nlmsg_len};
+        if (n_msgs == 0 || msg_len + n->nlmsg_len > NL_BATCH_MSG_SIZE) {
+            memset(&msgs[n_msgs], 0, sizeof(msgs[n_msgs]));
+            msgs[n_msgs].msg_hdr.msg_name = &nladdr;
+            msgs[n_msgs].msg_hdr.msg_namelen = sizeof(nladdr);
+            msgs[n_msgs].msg_hdr.msg_iov = &iov[i];
+            n_msgs++;
+            msg_len = 0;
+        }
+        msgs[n_msgs - 1].msg_hdr.msg_iovlen++;
+        msg_len += n->nlmsg_len;
+    }
+    rth->seq += n_reqs;
+
+    for (int sent = 0; sent < n_msgs;) {
+        int ret = sendmmsg(rth->fd, msgs + sent, n_msgs - sent, 0);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            fprintf(stderr, "%s: failed to send netlink requests: %s\n", __func__,
+                    strerror(errno));
+            return EXIT_FAILURE;
+        }
+        // the kernel may apply the sent requests even if their acks are never read.
+        for (int m = sent; m < sent + ret; m++) {
+            for (size_t k = 0; k < msgs[m].msg_hdr.msg_iovlen; k++)
+                errors[msgs[m].msg_hdr.msg_iov - iov + k] = NL_REQUEST_UNACKED;
+            pending += msgs[m].msg_hdr.msg_iovlen;
+        }
+        sent += ret;
+    }
+
+    while (pending > 0) {
+        struct iovec riov = {.iov_base = buf, .iov_len = sizeof(buf)};
+        struct msghdr rmsg = {
+            .msg_name = &nladdr,
+            .msg_namelen = sizeof(nladdr),
+            .msg_iov = &riov,
+            .msg_iovlen = 1,
+        };
+        int len = recvmsg(rth->fd, &rmsg, 0);
+        if (len < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            fprintf(stderr, "%s: failed to receive netlink acks: %s\n", __func__,
+                    strerror(errno));
+            return EXIT_FAILURE;
+        }
+        if (len == 0) {
+            fprintf(stderr, "%s: EOF on netlink\n", __func__);
+            return EXIT_FAILURE;
+        }
+        for (struct nlmsghdr *h = (struct nlmsghdr *)buf; NLMSG_OK(h, len);
+             h = NLMSG_NEXT(h, len)) {
+            struct nlmsgerr *err = NLMSG_DATA(h);
+            int i = h->nlmsg_seq - seq;
+
+            if (nladdr.nl_pid != 0 || h->nlmsg_pid != rth->local.nl_pid ||
+                h->nlmsg_type != NLMSG_ERROR || i < 0 || i >= n_reqs ||
+                errors[i] != NL_REQUEST_UNACKED)
+                continue;
+            if (h->nlmsg_len < NLMSG_LENGTH(sizeof(*err)))
+                errors[i] = EINVAL;
+            else
+                errors[i] = -err->error;
+            if (errors[i] != 0) {
+                fprintf(stderr, "RTNETLINK answers: %s\n", strerror(errors[i]));
+                nl_dump_ext_ack(h, NULL);
+            }
+            pending--;
+        }
+    }
+    return EXIT_SUCCESS;
+}
+
+void free_nl_request(struct nl_request *req)
+{
+    if (req == NULL)
+        return;
+    free(req->netns);
+    free(req->devs);
+    free(req->n);
+    free(req);
+}
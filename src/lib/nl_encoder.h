@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+#ifndef IPROUTE2_SYSREPO_NL_ENCODER_H
+#define IPROUTE2_SYSREPO_NL_ENCODER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <libyang/libyang.h>
+
+struct rtnl_handle;
+
+/* state of a sent request whose ack was not received, the kernel may have applied it */
+#define NL_REQUEST_UNACKED (-1)
+
+/**
+ * @brief operations a startcmd node is encoded for.
+ */
+typedef enum {
+    NL_REQUEST_ADD,
+    NL_REQUEST_DELETE,
+    NL_REQUEST_REPLACE,
+} nl_request_op_t;
+
+/**
+ * @brief device referenced by a netlink request, its ifindex is only known in the request netns
+ * once the previous commands of the transaction are applied.
+ */
+struct nl_request_dev {
+    size_t offset; /* offset of the ifindex field from the message start */
+    char name[IFNAMSIZ];
+};
+
+/**
+ * @brief netlink request encoded from a startcmd node, see nl_encode_startcmd().
+ */
+struct nl_request {
+    char *netns; /* network namespace name, "1" for the default one */
+    struct nl_request_dev *devs;
+    int n_devs;
+    struct nlmsghdr *n;
+};
+
+/**
+ * enable or disable the native netlink encoding of a module startcmd nodes.
+ * @param [in] module_name module name.
+ * @param [in] enabled true to encode the module changes to netlink requests.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the module has no netlink encoder.
+ */
+int set_nl_encoder(const char *module_name, bool enabled);
+
+/**
+ * encode a startcmd change node to a netlink request, for the route, mpls route and nexthop list
+ * entries of the modules with an enabled encoder. The node leaves with a delete operation are not
+ * part of the encoded object.
+ * @param [in] startcmd startcmd node, with all its leaves for add and replace operations.
+ * @param [in] op operation of the request.
+ * @return encoded request, NULL if the node is to be applied by an iproute2 command.
+ */
+struct nl_request *nl_encode_startcmd(const struct lyd_node *startcmd, nl_request_op_t op);
+
+/**
+ * resolve the devices of a request to their ifindexes, in the current netns.
+ * @param [in,out] req netlink request.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if a device is not found.
+ */
+int nl_request_resolve_devs(struct nl_request *req);
+
+/**
+ * send requests of one netns in batches of multi-message buffers on one socket, then collect
+ * their acks by sequence number. The kernel applies every request of a batch, including the ones
+ * following a failed request. The socket is expected to have NETLINK_CAP_ACK set, so a batch of
+ * acks fits the receive buffer.
+ * @param [in] rth rtnl socket opened in the requests netns.
+ * @param [in] reqs requests with resolved devices, their sequence numbers are set.
+ * @param [in] n_reqs number of requests.
+ * @param [out] errors errno of each request: 0 if the request is applied, ECANCELED if it was not
+ * sent, NL_REQUEST_UNACKED if it was sent but its ack was not received.
+ * @return EXIT_SUCCESS if all acks are received, EXIT_FAILURE on socket errors.
+ */
+int nl_requests_send_batch(struct rtnl_handle *rth, struct nl_request *const *reqs, int n_reqs,
+                           int *errors);
+
+/**
+ * free a netlink request.
+ * @param [in] req netlink request, can be NULL.
+ */
+void free_nl_request(struct nl_request *req);
+
+#endif // IPROUTE2_SYSREPO_NL_ENCODER_H
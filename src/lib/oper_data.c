@@ -11,14 +11,28 @@
  * Copyright (C) 2024 Okda Networks, <contact@okdanetworks.com>
  */
 
+#include <pthread.h>
 #include <stdbool.h>
 #include <libyang/tree_data.h>
 
 #include "json-c/json.h"
+#include "json-c/linkhash.h"
+#include "arena.h"
+#include "json_scan.h"
+#include "nl_decoder.h"
 #include "oper_data.h"
+#include "oper_json.h"
 #include "cmdgen.h"
 
 char *net_namespace;
+static uint16_t load_lys_flags; /* lys_flags of the current load pass */
+static const char *load_module_name; /* module of the current load pass */
+/* transient data of the current load pass: extension values, arg names, converted values.
+ * released in one shot at the end of the load pass. */
+static struct arena oper_arena;
+/* the load pass state above is shared, the monitor threads and the sysrepo oper callbacks load
+ * data one pass at a time */
+static pthread_mutex_t load_pass_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /* to be merged with cmdgen */
 typedef enum {
@@ -31,6 +45,8 @@ typedef enum {
     OPER_CK_ARGNAME_PRESENCE_EXT,
     OPER_DEFAULT_VALUE_EXT,
     OPER_STOP_IF_EXT,
+    OPER_MATCH_IF_EXT,
+    OPER_FAMILY_EXT,
     OPER_COMBINE_VALUES_EXT,
     OPER_CHANGE_VAL_FORMAT_EXT,
     OPER_SUB_JOBJ_EXT,
@@ -47,6 +63,8 @@ char *oper_yang_ext_map[] = { [OPER_CMD_EXT] = "oper-cmd",
                               [OPER_CK_ARGNAME_PRESENCE_EXT] = "oper-ck-argname-presence",
                               [OPER_DEFAULT_VALUE_EXT] = "oper-default-val",
                               [OPER_STOP_IF_EXT] = "oper-stop-if",
+                              [OPER_MATCH_IF_EXT] = "oper-match-if",
+                              [OPER_FAMILY_EXT] = "oper-family",
                               [OPER_COMBINE_VALUES_EXT] = "oper-combine-values",
                               [OPER_CHANGE_VAL_FORMAT_EXT] = "oper-change-value-format",
                               [OPER_SUB_JOBJ_EXT] = "oper-sub-jobj",
@@ -54,24 +72,19 @@ char *oper_yang_ext_map[] = { [OPER_CMD_EXT] = "oper-cmd",
                               [OPER_DUMP_TC_CLASSES] = "oper-dump-tc-classes" };
 
 extern int apply_ipr2_cmd(char *ipr2_show_cmd);
-int process_node(const struct lysc_node *s_node, json_object *json_array_obj, uint16_t lys_flags,
-                 struct lyd_node **parent_data_node);
+extern int apply_ipr2_cmd_filtered(char *ipr2_show_cmd, const struct dump_filter *filter);
+extern int dump_tc_objects(const char *netns, const struct tc_dump_req *reqs, int n_reqs,
+                           tc_dump_cb_t dump_cb, void *cb_arg);
+/* converter output node, a libyang data node, or an oper_json document node while the json
+ * backend builds a document */
+struct oper_node;
 
-void free_list_params(const char ***key_values, uint32_t **values_lengths, int key_count)
-{
-    if (*key_values) {
-        for (int i = 0; i < key_count; ++i) {
-            free((void *)(*key_values)[i]);
-        }
-        free(*key_values);
-        *key_values = NULL;
-    }
-
-    if (*values_lengths) {
-        free(*values_lengths);
-        *values_lengths = NULL;
-    }
-}
+int process_node(const struct lysc_node *s_node, json_object *json_array_obj, uint16_t lys_flags,
+                 struct oper_node **parent_data_node);
+void get_schema_json_keys(const struct lysc_node *s_node, struct json_object *wanted_keys);
+int get_lys_extension(oper_extension_t ex_t, const struct lysc_node *s_node, char **value);
+bool terminate_processing(const struct lysc_node *s_node, struct json_object *cmd_out_jobj,
+                          struct json_object *termination_obj);
 
 /**
  * Recursively searches for a value associated with a given key within a JSON object.
@@ -114,7 +127,696 @@ json_bool find_json_value_by_key(struct json_object *jobj, const char *key,
     return 0; // Key not found
 }
 
+#define JSON_KEY_PATH_MAX_DEPTH 8
+
+/* json object keys leading to a schema node key, learned from the first command output row */
+struct json_key_path {
+    const struct lysc_node *s_node;
+    char *key;
+    int depth; /* -1 if the key was found inside an array, the path is not reusable then */
+    char *path[JSON_KEY_PATH_MAX_DEPTH];
+};
+
+/* key paths of the current load pass, released by free_json_key_paths() */
+static struct lh_table *json_key_paths;
+
+static unsigned long json_key_path_hash(const void *k)
+{
+    const struct json_key_path *kpath = k;
+    unsigned long hash = (unsigned long)(uintptr_t)kpath->s_node;
+
+    for (const char *c = kpath->key; *c; c++)
+        hash = hash * 33 + (unsigned char)*c;
+    return hash;
+}
+
+static int json_key_path_equal(const void *k1, const void *k2)
+{
+    const struct json_key_path *kpath1 = k1, *kpath2 = k2;
+
+    return kpath1->s_node == kpath2->s_node && !strcmp(kpath1->key, kpath2->key);
+}
+
+static void json_key_path_clear(struct json_key_path *kpath)
+{
+    for (int i = 0; i < kpath->depth; i++) {
+        free(kpath->path[i]);
+        kpath->path[i] = NULL;
+    }
+    kpath->depth = -1;
+}
+
+static void json_key_path_entry_free(struct lh_entry *entry)
+{
+    /* the entry key and value are the same json_key_path */
+    struct json_key_path *kpath = lh_entry_v(entry);
+
+    json_key_path_clear(kpath);
+    free(kpath->key);
+    free(kpath);
+}
+
+void free_json_key_paths(void)
+{
+    if (json_key_paths)
+        lh_table_free(json_key_paths);
+    json_key_paths = NULL;
+}
+
+/**
+ * Same search as find_json_value_by_key(), but also records the object keys leading to the
+ * found key.
+ * @param [in] jobj: JSON object to be searched.
+ * @param [in] key: Key string for which the value is to be found.
+ * @param [out] found_obj: JSON object to store the found key object.
+ * @param [out] path: object keys leading to the object holding the key.
+ * @param [in,out] depth: number of keys in path, set to -1 if the key is not reachable through
+ * objects only.
+ * @return json_bool, returns 1 if key is found, 0 if not.
+ */
+static json_bool find_json_path_by_key(struct json_object *jobj, const char *key,
+                                       struct json_object **found_obj, const char **path,
+                                       int *depth)
+{
+    int level = *depth;
+
+    if (json_object_get_type(jobj) == json_type_object) {
+        json_object_object_foreach(jobj, current_key, current_val)
+        {
+            if (strcmp(current_key, key) == 0) {
+                *found_obj = current_val;
+                return 1;
+            }
+            if (level >= 0 && level < JSON_KEY_PATH_MAX_DEPTH) {
+                path[level] = current_key;
+                *depth = level + 1;
+            } else {
+                *depth = -1;
+            }
+            if (find_json_path_by_key(current_val, key, found_obj, path, depth))
+                return 1;
+            *depth = level;
+        }
+    } else if (json_object_get_type(jobj) == json_type_array) {
+        *depth = -1;
+        for (int i = 0; i < json_object_array_length(jobj); i++) {
+            if (find_json_path_by_key(json_object_array_get_idx(jobj, i), key, found_obj, path,
+                                      depth))
+                return 1;
+        }
+        *depth = level;
+    }
+    return 0;
+}
+
+/**
+ * Looks up the value of a schema node key in a command output JSON object.
+ * The path to the key is learned on the first row and then followed directly on the next rows,
+ * the recursive search is only used when the learned path does not match the row.
+ * @param [in] s_node: schema node the key belongs to.
+ * @param [in] jobj: JSON object to be searched.
+ * @param [in] key: Key string for which the value is to be found.
+ * @param [out] found_obj: JSON object to store the found key object.
+ * @return json_bool, returns 1 if key is found, 0 if not.
+ */
+json_bool lookup_json_value_by_key(const struct lysc_node *s_node, struct json_object *jobj,
+                                   const char *key, struct json_object **found_obj)
+{
+    struct json_key_path lookup = { .s_node = s_node, .key = (char *)key };
+    struct json_key_path *kpath = NULL;
+    const char *path[JSON_KEY_PATH_MAX_DEPTH];
+    int depth = 0;
+
+    if (json_key_paths == NULL) {
+        json_key_paths = lh_table_new(64, json_key_path_entry_free, json_key_path_hash,
+                                      json_key_path_equal);
+        if (json_key_paths == NULL)
+            return find_json_value_by_key(jobj, key, found_obj);
+    }
+
+    if (lh_table_lookup_ex(json_key_paths, &lookup, (void **)&kpath) && kpath->depth >= 0) {
+        struct json_object *obj = jobj;
+        int i;
+        for (i = 0; i < kpath->depth; i++) {
+            if (!json_object_object_get_ex(obj, kpath->path[i], &obj))
+                break;
+        }
+        if (i == kpath->depth && json_object_object_get_ex(obj, key, found_obj))
+            return 1;
+    }
+
+    if (!find_json_path_by_key(jobj, key, found_obj, path, &depth))
+        return 0;
+
+    /* learn the path, or relearn it if this row has a different layout */
+    if (kpath == NULL) {
+        kpath = calloc(1, sizeof(*kpath));
+        if (kpath == NULL)
+            return 1;
+        kpath->s_node = s_node;
+        kpath->key = strdup(key);
+        kpath->depth = -1;
+        if (kpath->key == NULL || lh_table_insert(json_key_paths, kpath, kpath)) {
+            free(kpath->key);
+            free(kpath);
+            return 1;
+        }
+    }
+    json_key_path_clear(kpath);
+    for (int i = 0; i < depth; i++) {
+        kpath->path[i] = strdup(path[i]);
+        if (kpath->path[i] == NULL) {
+            kpath->depth = i;
+            json_key_path_clear(kpath);
+            return 1;
+        }
+    }
+    kpath->depth = depth;
+    return 1;
+}
+
+/* output of a show command executed in the current load pass */
+struct show_cmd_output {
+    char *show_cmd;
+    char *netns;
+    bool filtered; /* dumped with the shared oper-stop-if of its lists, see get_shared_stop_if() */
+    bool group_by_family; /* rows grouped by address family */
+    char *text;
+    struct json_object *jobj; /* fully parsed text, NULL until requested */
+};
+
+/* show command outputs of the current load pass, released by free_show_cmd_outputs() */
+static struct lh_table *show_cmd_outputs;
+
+/* oper-stop-if keys that map to netlink message attributes the dumps can be filtered on */
+static const struct {
+    const char *key;
+    dump_filter_attr_t attr;
+} dump_filter_keys[] = {
+    { "table", DUMP_FILTER_TABLE },
+    { "protocol", DUMP_FILTER_PROTOCOL },
+    { "type", DUMP_FILTER_TYPE },
+    { "info_kind", DUMP_FILTER_KIND },
+};
+
+static unsigned long show_cmd_output_hash(const void *k)
+{
+    const struct show_cmd_output *output = k;
+    unsigned long hash = 5381 + output->group_by_family + 2 * output->filtered;
+
+    for (const char *c = output->show_cmd; *c; c++)
+        hash = hash * 33 + (unsigned char)*c;
+    for (const char *c = output->netns; *c; c++)
+        hash = hash * 33 + (unsigned char)*c;
+    return hash;
+}
+
+static int show_cmd_output_equal(const void *k1, const void *k2)
+{
+    const struct show_cmd_output *output1 = k1, *output2 = k2;
+
+    return !strcmp(output1->show_cmd, output2->show_cmd) &&
+           !strcmp(output1->netns, output2->netns) && output1->filtered == output2->filtered &&
+           output1->group_by_family == output2->group_by_family;
+}
+
+static void show_cmd_output_entry_free(struct lh_entry *entry)
+{
+    /* the entry key and value are the same show_cmd_output */
+    struct show_cmd_output *output = lh_entry_v(entry);
+
+    json_object_put(output->jobj);
+    free(output->show_cmd);
+    free(output->netns);
+    free(output->text);
+    free(output);
+}
+
+void free_show_cmd_outputs(void)
+{
+    if (show_cmd_outputs)
+        lh_table_free(show_cmd_outputs);
+    show_cmd_outputs = NULL;
+}
+
+/**
+ * Builds the dump filter of a show command, the oper-stop-if values that map to netlink message
+ * attributes are excluded from the command dumps, the other values are only checked on the rows.
+ * Only the objects in the config ownership scope are kept when loading configuration.
+ * @param [in] stop_if: oper-stop-if extension value of the command schema node, NULL if none.
+ * @param [out] filter: dump filter, its excluded values point into the returned json object.
+ * @return parsed oper-stop-if to release once the filter is used, NULL if none.
+ */
+static struct json_object *build_stop_if_filter(const char *stop_if, struct dump_filter *filter)
+{
+    struct json_object *stop_if_jobj = stop_if ? json_tokener_parse(stop_if) : NULL;
+
+    memset(filter, 0, sizeof(*filter));
+    filter->owned_only = (load_lys_flags & LYS_CONFIG_W) != 0;
+    if (json_object_get_type(stop_if_jobj) != json_type_object)
+        return stop_if_jobj;
+    json_object_object_foreach(stop_if_jobj, key, values)
+    {
+        size_t k;
+        for (k = 0; k < sizeof(dump_filter_keys) / sizeof(dump_filter_keys[0]); k++) {
+            if (!strcmp(key, dump_filter_keys[k].key))
+                break;
+        }
+        if (k == sizeof(dump_filter_keys) / sizeof(dump_filter_keys[0]) ||
+            !json_object_is_type(values, json_type_array))
+            continue;
+        for (size_t i = 0; i < json_object_array_length(values); i++) {
+            if (filter->n_excluded == DUMP_FILTER_MAX_VALUES)
+                break;
+            filter->excluded[filter->n_excluded].attr = dump_filter_keys[k].attr;
+            filter->excluded[filter->n_excluded].value =
+                json_object_get_string(json_object_array_get_idx(values, i));
+            filter->n_excluded++;
+        }
+    }
+    return stop_if_jobj;
+}
+
+/**
+ * Keeps the values excluded by both oper-stop-if objects, for the keys that can be pushed down
+ * to the dumps.
+ * @param [in] stop_if1: parsed oper-stop-if.
+ * @param [in] stop_if2: parsed oper-stop-if.
+ * @return new json object of the common values, NULL on memory allocation failure.
+ */
+static struct json_object *intersect_stop_if(struct json_object *stop_if1,
+                                             struct json_object *stop_if2)
+{
+    struct json_object *common = json_object_new_object();
+
+    if (common == NULL)
+        return NULL;
+    json_object_object_foreach(stop_if1, key, values1)
+    {
+        struct json_object *values2, *common_values;
+        if (!json_object_is_type(values1, json_type_array) ||
+            !json_object_object_get_ex(stop_if2, key, &values2) ||
+            !json_object_is_type(values2, json_type_array))
+            continue;
+        common_values = json_object_new_array();
+        for (size_t i = 0; common_values && i < json_object_array_length(values1); i++) {
+            const char *value = json_object_get_string(json_object_array_get_idx(values1, i));
+            for (size_t j = 0; j < json_object_array_length(values2); j++) {
+                if (!strcmp(value, json_object_get_string(json_object_array_get_idx(values2, j)))) {
+                    json_object_array_add(common_values, json_object_new_string(value));
+                    break;
+                }
+            }
+        }
+        if (common_values == NULL) {
+            json_object_put(common);
+            return NULL;
+        }
+        json_object_object_add(common, key, common_values);
+    }
+    return common;
+}
+
+/**
+ * Removes the values of an oper-match-if key from the oper-stop-if values of that key, the other
+ * keys are dropped as the rows they exclude can match.
+ * @param [in] stop_if: parsed oper-stop-if.
+ * @param [in] match_key: oper-match-if key.
+ * @param [in] match_values: oper-match-if values of the key.
+ * @return new json object of the remaining values, NULL on memory allocation failure.
+ */
+static struct json_object *subtract_match_if(struct json_object *stop_if, const char *match_key,
+                                             struct json_object *match_values)
+{
+    struct json_object *remaining = json_object_new_object(), *values, *remaining_values;
+
+    if (remaining == NULL || !json_object_object_get_ex(stop_if, match_key, &values) ||
+        !json_object_is_type(values, json_type_array))
+        return remaining;
+    remaining_values = json_object_new_array();
+    for (size_t i = 0; remaining_values && i < json_object_array_length(values); i++) {
+        const char *value = json_object_get_string(json_object_array_get_idx(values, i));
+        size_t j;
+        for (j = 0; j < json_object_array_length(match_values); j++) {
+            if (!strcmp(value, json_object_get_string(json_object_array_get_idx(match_values, j))))
+                break;
+        }
+        if (j == json_object_array_length(match_values))
+            json_object_array_add(remaining_values, json_object_new_string(value));
+    }
+    if (remaining_values == NULL) {
+        json_object_put(remaining);
+        return NULL;
+    }
+    json_object_object_add(remaining, match_key, remaining_values);
+    return remaining;
+}
+
+/**
+ * Gets the oper-stop-if pushed down to the dump of a list oper-cmd. The dump output is shared by
+ * the lists of the module using the same oper-cmd, only the values excluded by all of them are
+ * pushed down, so the output does not depend on the order the lists are loaded in. A list with
+ * an oper-match-if excludes the values it does not match, e.g. the link list stop-if kinds that
+ * no link kind list matches. Each list still matches its own extensions on the rows, see
+ * process_node().
+ * @param [in] s_node: list schema node holding the oper-cmd extension.
+ * @return shared oper-stop-if allocated from the load pass arena, NULL if none.
+ */
+static char *get_shared_stop_if(const struct lysc_node *s_node)
+{
+    char *oper_cmd = NULL, *shared_str = NULL, *match_key = NULL;
+    struct json_object *shared = NULL, *matched = json_object_new_array();
+    const struct lysc_node *top, *node;
+
+    if (matched == NULL)
+        return NULL;
+    if (get_lys_extension(OPER_CMD_EXT, s_node, &oper_cmd) != EXIT_SUCCESS || oper_cmd == NULL)
+        goto done;
+    LY_LIST_FOR(s_node->module->compiled->data, top)
+    {
+        LYSC_TREE_DFS_BEGIN(top, node)
+        {
+            char *node_cmd = NULL, *stop_if = NULL, *match_if = NULL;
+            struct json_object *stop_if_jobj, *common;
+
+            if (node->nodetype != LYS_LIST ||
+                get_lys_extension(OPER_CMD_EXT, node, &node_cmd) != EXIT_SUCCESS ||
+                node_cmd == NULL || strcmp(node_cmd, oper_cmd))
+                goto next_node;
+            if (get_lys_extension(OPER_MATCH_IF_EXT, node, &match_if) == EXIT_SUCCESS) {
+                /* the list reads only the rows matching one key values, kept for the end */
+                struct json_object *match_jobj = match_if ? json_tokener_parse(match_if) : NULL;
+                bool single_key = json_object_is_type(match_jobj, json_type_object) &&
+                                  json_object_object_length(match_jobj) == 1;
+
+                if (single_key) {
+                    json_object_object_foreach(match_jobj, key, values)
+                    {
+                        if (!json_object_is_type(values, json_type_array) ||
+                            (match_key && strcmp(match_key, key))) {
+                            single_key = false;
+                            break;
+                        }
+                        match_key = arena_strdup(&oper_arena, key);
+                        for (size_t i = 0; i < json_object_array_length(values); i++) {
+                            struct json_object *value = json_object_array_get_idx(values, i);
+                            json_object_array_add(matched, json_object_get(value));
+                        }
+                    }
+                }
+                json_object_put(match_jobj);
+                if (!single_key || match_key == NULL) {
+                    json_object_put(shared);
+                    shared = NULL;
+                    goto done;
+                }
+                goto next_node;
+            }
+            get_lys_extension(OPER_STOP_IF_EXT, node, &stop_if);
+            stop_if_jobj = stop_if ? json_tokener_parse(stop_if) : NULL;
+            if (!json_object_is_type(stop_if_jobj, json_type_object)) {
+                /* a list reading all the rows, nothing can be pushed down */
+                json_object_put(stop_if_jobj);
+                json_object_put(shared);
+                shared = NULL;
+                goto done;
+            }
+            if (shared == NULL) {
+                shared = stop_if_jobj;
+            } else {
+                common = intersect_stop_if(shared, stop_if_jobj);
+                json_object_put(stop_if_jobj);
+                json_object_put(shared);
+                shared = common;
+                if (shared == NULL)
+                    goto done;
+            }
+next_node:
+            LYSC_TREE_DFS_END(top, node);
+        }
+    }
+    if (shared && match_key) {
+        struct json_object *remaining = subtract_match_if(shared, match_key, matched);
+        json_object_put(shared);
+        shared = remaining;
+    }
+    if (shared)
+        shared_str = arena_strdup(&oper_arena, json_object_to_json_string(shared));
+done:
+    json_object_put(shared);
+    json_object_put(matched);
+    return shared_str;
+}
+
+/**
+ * Executes a show command with the dump filter of its oper-stop-if, see build_stop_if_filter().
+ * @param [in] show_cmd: show command.
+ * @param [in] stop_if: oper-stop-if extension value of the command schema node, NULL if none.
+ * @param [in] group_by_family: group the output rows by address family.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int apply_ipr2_cmd_stop_if(const char *show_cmd, const char *stop_if, bool group_by_family)
+{
+    struct dump_filter filter;
+    struct json_object *stop_if_jobj = build_stop_if_filter(stop_if, &filter);
+    int ret;
+
+    filter.group_by_family = group_by_family;
+    if (filter.n_excluded || filter.group_by_family || filter.owned_only)
+        ret = apply_ipr2_cmd_filtered((char *)show_cmd, &filter);
+    else
+        ret = apply_ipr2_cmd((char *)show_cmd);
+    json_object_put(stop_if_jobj);
+    return ret;
+}
+
+/**
+ * Gets the output of an iproute2 show command in the current namespace, the command is executed
+ * only the first time it is requested in the load pass.
+ * @param [in] show_cmd: show command, with the namespace option already inserted.
+ * @param [in] s_node: list schema node reading the output, its oper-cmd dump is filtered with the
+ * shared oper-stop-if, see get_shared_stop_if(). NULL if the output is read unfiltered.
+ * @param [in] group_by_family: group the output rows by address family.
+ * @return show command output entry, NULL if the command execution failed.
+ */
+static struct show_cmd_output *get_show_cmd_output(const char *show_cmd,
+                                                   const struct lysc_node *s_node,
+                                                   bool group_by_family)
+{
+    struct show_cmd_output lookup = { .show_cmd = (char *)show_cmd,
+                                      .netns = net_namespace,
+                                      .filtered = s_node != NULL,
+                                      .group_by_family = group_by_family };
+    struct show_cmd_output *output = NULL;
+
+    if (show_cmd_outputs == NULL) {
+        show_cmd_outputs = lh_table_new(16, show_cmd_output_entry_free, show_cmd_output_hash,
+                                        show_cmd_output_equal);
+        if (show_cmd_outputs == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return NULL;
+        }
+    }
+    if (lh_table_lookup_ex(show_cmd_outputs, &lookup, (void **)&output))
+        return output;
+
+    if (apply_ipr2_cmd_stop_if(show_cmd, s_node ? get_shared_stop_if(s_node) : NULL,
+                               group_by_family) != EXIT_SUCCESS) {
+        fprintf(stderr, "%s: command execution failed for command: %s\n", __func__, show_cmd);
+        return NULL;
+    }
+    output = calloc(1, sizeof(*output));
+    if (output == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+    output->show_cmd = strdup(show_cmd);
+    output->netns = strdup(net_namespace);
+    output->filtered = s_node != NULL;
+    output->group_by_family = group_by_family;
+    output->text = strdup(json_buffer);
+    if (!output->show_cmd || !output->netns || !output->text ||
+        lh_table_insert(show_cmd_outputs, output, output)) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        free(output->show_cmd);
+        free(output->netns);
+        free(output->text);
+        free(output);
+        return NULL;
+    }
+    return output;
+}
+
+/**
+ * Gets the output text of an iproute2 show command, see get_show_cmd_output().
+ * @param [in] show_cmd: show command, with the namespace option already inserted.
+ * @param [in] s_node: list schema node reading the output, NULL if the output is read unfiltered.
+ * @param [in] group_by_family: group the output rows by address family.
+ * @return output text owned by the load pass cache, NULL if the command execution failed.
+ */
+const char *get_show_cmd_text(const char *show_cmd, const struct lysc_node *s_node,
+                              bool group_by_family)
+{
+    struct show_cmd_output *output = get_show_cmd_output(show_cmd, s_node, group_by_family);
+
+    return output ? output->text : NULL;
+}
+
+/**
+ * Selects the rows of some address families from a show command output grouped by family. An
+ * oper-stop-if object named after a family is only matched on the rows of that family, e.g.
+ * {"inet6": {"protocol": ["kernel"]}}.
+ * @param [in] s_node: list schema node holding the oper-family extension.
+ * @param [in] cmd_output: json array of {"family": name, "rows": [...]} groups.
+ * @param [in] families: comma separated family names.
+ * @param [in] stop_if: parsed oper-stop-if of the list, NULL if none.
+ * @return json array of the selected rows, NULL on memory allocation failure.
+ */
+static struct json_object *select_family_rows(const struct lysc_node *s_node,
+                                              struct json_object *cmd_output, const char *families,
+                                              struct json_object *stop_if)
+{
+    struct json_object *rows = json_object_new_array();
+    size_t n_groups = 0;
+
+    if (rows == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        return NULL;
+    }
+    if (json_object_get_type(cmd_output) == json_type_array)
+        n_groups = json_object_array_length(cmd_output);
+    for (size_t i = 0; i < n_groups; i++) {
+        struct json_object *group = json_object_array_get_idx(cmd_output, i);
+        struct json_object *family_obj, *group_rows;
+        if (!json_object_object_get_ex(group, "family", &family_obj) ||
+            !json_object_object_get_ex(group, "rows", &group_rows) ||
+            json_object_get_type(group_rows) != json_type_array)
+            continue;
+
+        /* match the group family against the comma separated families */
+        const char *family = json_object_get_string(family_obj);
+        size_t family_len = strlen(family);
+        const char *f = families;
+        while (f) {
+            if (!strncmp(f, family, family_len) && (f[family_len] == ',' || !f[family_len]))
+                break;
+            f = strchr(f, ',');
+            if (f)
+                f++;
+        }
+        if (f == NULL)
+            continue;
+
+        struct json_object *family_stop_if = NULL;
+        if (!json_object_object_get_ex(stop_if, family, &family_stop_if) ||
+            !json_object_is_type(family_stop_if, json_type_object))
+            family_stop_if = NULL;
+
+        /* the rows array holds its own references, so the rows outlive cmd_output */
+        for (size_t j = 0; j < json_object_array_length(group_rows); j++) {
+            struct json_object *row = json_object_array_get_idx(group_rows, j);
+            if (family_stop_if && terminate_processing(s_node, row, family_stop_if))
+                continue;
+            json_object_array_add(rows, json_object_get(row));
+        }
+    }
+    return rows;
+}
+
+/**
+ * Gets the parsed output of an iproute2 show command, the output is parsed only the first time
+ * it is requested in the load pass, see get_show_cmd_output().
+ * @param [in] show_cmd: show command, with the namespace option already inserted.
+ * @return json object owned by the load pass cache, use json_object_get() to hold a reference,
+ * NULL if the command execution or the output parsing failed.
+ */
+struct json_object *get_show_cmd_jobj(const char *show_cmd)
+{
+    struct show_cmd_output *output = get_show_cmd_output(show_cmd, NULL, false);
+
+    if (output == NULL)
+        return NULL;
+    if (output->jobj == NULL) {
+        output->jobj = json_tokener_parse(output->text);
+        if (output->jobj == NULL)
+            fprintf(stderr, "%s: JSON parsing failed for command output: %s\n", __func__,
+                    show_cmd);
+    }
+    return output->jobj;
+}
+
+/* show commands having a native netlink decoder, the decoders are selected per module */
+static struct netlink_decoder {
+    const char *module;
+    const char *show_cmd;
+    struct json_object *(*decode)(const char *netns, const struct dump_filter *filter);
+    bool enabled;
+    struct json_object *rows; /* rows decoded in the current load pass */
+} netlink_decoders[] = {
+    { "iproute2-ip-link", "ip address show", nl_decode_links },
+    { "iproute2-ip-route", "ip route list table all", nl_decode_routes },
+    { "iproute2-ip-nexthop", "ip nexthop show", nl_decode_nexthops },
+};
+
+int set_oper_data_source(const char *module_name, oper_data_source_t source)
+{
+    bool found = false;
+
+    for (size_t i = 0; i < sizeof(netlink_decoders) / sizeof(netlink_decoders[0]); i++) {
+        if (!strcmp(netlink_decoders[i].module, module_name)) {
+            netlink_decoders[i].enabled = source == OPER_DATA_SOURCE_NETLINK;
+            found = true;
+        }
+    }
+    if (!found && source == OPER_DATA_SOURCE_NETLINK) {
+        fprintf(stderr, "%s: module %s has no netlink decoder\n", __func__, module_name);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static void free_netlink_rows(void)
+{
+    for (size_t i = 0; i < sizeof(netlink_decoders) / sizeof(netlink_decoders[0]); i++) {
+        json_object_put(netlink_decoders[i].rows);
+        netlink_decoders[i].rows = NULL;
+    }
+}
+
+/**
+ * Gets the rows of a show command from its native netlink decoder, if the decoder is enabled for
+ * the module of the load pass. The rows are decoded once per load pass, the shared oper-stop-if
+ * values that map to netlink message attributes are excluded from the decoder dump, see
+ * get_shared_stop_if().
+ * @param [in] s_node: list schema node holding the oper-cmd extension.
+ * @param [in] show_cmd: show command, without the namespace option.
+ * @return decoded rows owned by the load pass, NULL if the command is to be executed by iproute2.
+ */
+static struct json_object *get_netlink_rows(const struct lysc_node *s_node, const char *show_cmd)
+{
+    for (size_t i = 0; i < sizeof(netlink_decoders) / sizeof(netlink_decoders[0]); i++) {
+        struct netlink_decoder *decoder = &netlink_decoders[i];
+        if (!decoder->enabled || strcmp(decoder->module, load_module_name) ||
+            strcmp(decoder->show_cmd, show_cmd))
+            continue;
+
+        if (decoder->rows == NULL) {
+            struct dump_filter filter;
+            struct json_object *stop_if_jobj =
+                build_stop_if_filter(get_shared_stop_if(s_node), &filter);
+            decoder->rows = decoder->decode(net_namespace, &filter);
+            json_object_put(stop_if_jobj);
+            if (decoder->rows == NULL)
+                fprintf(stderr, "%s: netlink decoding failed, executing command: %s\n", __func__,
+                        show_cmd);
+        }
+        return decoder->rows;
+    }
+    return NULL;
+}
+
 // TODO : redundant code to cmdgen:get_extension, input is lysc_node instead of lyd_node
+// the value is allocated from the load pass arena.
 int get_lys_extension(oper_extension_t ex_t, const struct lysc_node *s_node, char **value)
 {
     struct lysc_ext_instance *ys_extenstions = s_node->exts;
@@ -126,7 +828,7 @@ int get_lys_extension(oper_extension_t ex_t, const struct lysc_node *s_node, cha
     {
         if (!strcmp(ys_extenstions[i].def->name, oper_yang_ext_map[ex_t])) {
             if (value != NULL)
-                *value = strdup(ys_extenstions[i].argument);
+                *value = arena_strdup(&oper_arena, ys_extenstions[i].argument);
             return EXIT_SUCCESS;
         }
     }
@@ -141,8 +843,8 @@ int get_lys_extension(oper_extension_t ex_t, const struct lysc_node *s_node, cha
  * - If the conversion to a higher unit results in a decimal, the function drops to the next lower unit to display the exact value as an integer.
  * 
  * @param [in] bytes: The input value in bytes to be converted.
- * @return char*: A dynamically allocated string representing the formatted size in bits. 
- *                The caller is responsible for freeing this memory.
+ * @return char*: A string representing the formatted size in bits, allocated from the load pass
+ *                arena.
  */
 char *bytes_to_bit_units(uint64_t bytes)
 {
@@ -180,9 +882,10 @@ char *bytes_to_bit_units(uint64_t bytes)
         suffix = "bit";
         value = bits;
     }
-    char *result = malloc(50);
-    printf("bits1 %ld bytes %ld\n", bits, bytes);
-    sprintf(result, "%.0f%s", value, suffix);
+    char *result = arena_alloc(&oper_arena, 50);
+    if (result == NULL)
+        return NULL;
+    snprintf(result, 50, "%.0f%s", value, suffix);
     return result;
 }
 
@@ -256,208 +959,226 @@ char *combine_values(struct json_object *cmd_out_jobj, struct json_object *combi
     return combined_value;
 }
 
-/**
- * Extracts keys and their values from a JSON array object based on the YANG list Schema keys.
- * This function is used to map JSON array data to YANG schema list keys.
- * @param [in] list: YANG list schema node.
- * @param [in] json_array_obj: JSON object containing the list's data.
- * @param [out] key_values: Pointer to store the extracted keys' values.
- * @param [out] values_lengths: Pointer to store the lengths of the keys' values.
- * @param [out] keys_num: Pointer to store the number of keys extracted.
- * @return Returns EXIT_SUCCESS if keys are successfully extracted; otherwise, returns EXIT_FAILURE.
- */
-int get_list_keys(const struct lysc_node_list *list, json_object *json_array_obj,
-                  const char ***key_values, uint32_t **values_lengths, int *keys_num)
-{
-    int ret = EXIT_SUCCESS;
-    int key_count = 0;
-    *key_values = NULL;
-    *values_lengths = NULL;
-    struct json_object *temp_value, *combine_ext_jobj = NULL;
-
-    const struct lysc_node *child;
-    for (child = list->child; child; child = child->next) {
-        char *key_name = NULL, *combine_ext_str = NULL, *default_val = NULL;
-        if (lysc_is_key(child)) {
-            if (get_lys_extension(OPER_ARG_NAME_EXT, child, &key_name) == EXIT_SUCCESS) {
-                if (key_name == NULL) {
-                    fprintf(stderr,
-                            "%s: ipr2cgen:oper-arg-name extension found but failed to "
-                            "get the arg-name value for node \"%s\"\n",
-                            __func__, child->name);
-                    return EXIT_FAILURE;
-                }
-            } else {
-                key_name = strdup(child->name);
-            }
-
-            if (get_lys_extension(OPER_DEFAULT_VALUE_EXT, child, &default_val) == EXIT_SUCCESS) {
-                if (default_val == NULL) {
-                    fprintf(stderr,
-                            "%s: ipr2cgen:oper-default-val extension found but failed to "
-                            "get the value for node \"%s\"\n",
-                            __func__, child->name);
-                    return EXIT_FAILURE;
-                }
-            }
-
-            if (get_lys_extension(OPER_COMBINE_VALUES_EXT, child, &combine_ext_str) ==
-                EXIT_SUCCESS) {
-                if (combine_ext_str == NULL) {
-                    fprintf(stderr,
-                            "%s: ipr2cgen:oper-combine-values extension found but failed to "
-                            "get the combined values list for node \"%s\"\n",
-                            __func__, child->name);
-                    return EXIT_FAILURE;
-                }
+static oper_data_backend_t oper_backend = OPER_DATA_BACKEND_LYD;
 
-                combine_ext_jobj = combine_ext_str ? json_tokener_parse(combine_ext_str) : NULL;
-                if (combine_ext_str != NULL) {
-                    free(combine_ext_str);
-                }
+/* document of the top-level node being converted by the json backend */
+static struct oper_json_doc *oper_doc;
 
-                if (combine_ext_jobj == NULL) {
-                    fprintf(stderr,
-                            "%s: Error reading schema node \"%s\" ipr2cgen:oper-stop-if extension,"
-                            " the extension value has a bad json format\n",
-                            __func__, child->name);
-                    return EXIT_FAILURE;
-                }
-            }
+void set_oper_data_backend(oper_data_backend_t backend)
+{
+    oper_backend = backend;
+}
 
-            if (json_object_object_get_ex(json_array_obj, key_name, &temp_value)) {
-                // Resize the arrays to accommodate key additions
-                *key_values = (const char **)realloc(*key_values, (key_count + 1) * sizeof(char *));
-                *values_lengths =
-                    (uint32_t *)realloc(*values_lengths, (key_count + 1) * sizeof(uint32_t));
+const struct lysc_node *oper_node_schema(struct oper_node *node)
+{
+    if (oper_doc)
+        return oper_json_schema((struct oper_json_node *)node);
+    return ((struct lyd_node *)node)->schema;
+}
 
-                if (!*key_values || !*values_lengths) {
-                    fprintf(stderr, "%s: Memory allocation failed\n", __func__);
-                    ret = EXIT_FAILURE;
-                    goto cleanup;
-                }
+/**
+ * Finds the first child of a converter output node with a given container schema.
+ * @param [in] parent: node to search the children of.
+ * @param [in] s_node: schema node of the child.
+ * @param [out] node: found child node.
+ * @return LY_SUCCESS if found, LY_ENOTFOUND otherwise.
+ */
+LY_ERR oper_find_child(struct oper_node *parent, const struct lysc_node *s_node,
+                       struct oper_node **node)
+{
+    if (oper_doc) {
+        *node = (struct oper_node *)oper_json_find_child((struct oper_json_node *)parent, s_node);
+        return *node ? LY_SUCCESS : LY_ENOTFOUND;
+    }
+    return lyd_find_sibling_val(lyd_child((struct lyd_node *)parent), s_node, NULL, 0,
+                                (struct lyd_node **)node);
+}
 
-                char *combined_value = NULL;
-                // Store the new key
-                if (combine_ext_jobj != NULL) {
-                    combined_value = combine_values(json_array_obj, combine_ext_jobj);
-                    (*key_values)[key_count] = strdup(combined_value);
-                    json_object_put(combine_ext_jobj);
-                } else
-                    (*key_values)[key_count] = strdup(json_object_get_string(temp_value));
+/**
+ * Creates a container converter output node.
+ * @param [in] parent: parent node, NULL to create a top-level node.
+ * @param [in] s_node: container schema node.
+ * @param [out] node: created node.
+ * @return LY_SUCCESS on success, libyang error code otherwise.
+ */
+LY_ERR oper_new_inner(struct oper_node *parent, const struct lysc_node *s_node,
+                      struct oper_node **node)
+{
+    if (oper_doc) {
+        *node = (struct oper_node *)oper_json_add(oper_doc, (struct oper_json_node *)parent,
+                                                  s_node, NULL);
+        return *node ? LY_SUCCESS : LY_EMEM;
+    }
+    return lyd_new_inner((struct lyd_node *)parent, parent ? NULL : s_node->module, s_node->name,
+                         0, (struct lyd_node **)node);
+}
 
-                if (!(*key_values)[key_count]) {
-                    fprintf(stderr, "%s: Failed to duplicate list key value\n", __func__);
-                    ret = EXIT_FAILURE;
-                    goto cleanup;
-                }
-                if (combined_value != NULL) {
-                    (*values_lengths)[key_count] = strlen(combined_value);
-                    free(combined_value);
-                } else
-                    (*values_lengths)[key_count] = strlen(json_object_get_string(temp_value));
+/**
+ * Creates a leaf or leaf-list converter output node.
+ * @param [in] parent: parent node.
+ * @param [in] s_node: leaf or leaf-list schema node.
+ * @param [in] value: node value.
+ * @return LY_SUCCESS on success, libyang error code otherwise.
+ */
+LY_ERR oper_new_term(struct oper_node *parent, const struct lysc_node *s_node, const char *value)
+{
+    if (oper_doc) {
+        /* lyd_new_term() looks the node up under the parent, reject misplaced nodes the same way */
+        if (value == NULL || lysc_data_parent(s_node) != oper_node_schema(parent))
+            return LY_EINVAL;
+        if (!oper_json_add(oper_doc, (struct oper_json_node *)parent, s_node, value))
+            return LY_EMEM;
+        return LY_SUCCESS;
+    }
+    return lyd_new_term((struct lyd_node *)parent, NULL, s_node->name, value, 0, NULL);
+}
 
-                key_count++;
-            } else {
-                // key value not found in json data.
-                if (default_val != NULL) {
-                    // Resize the arrays to accommodate key additions
-                    *key_values =
-                        (const char **)realloc(*key_values, (key_count + 1) * sizeof(char *));
-                    *values_lengths =
-                        (uint32_t *)realloc(*values_lengths, (key_count + 1) * sizeof(uint32_t));
-
-                    if (!*key_values || !*values_lengths) {
-                        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
-                        ret = EXIT_FAILURE;
-                        goto cleanup;
-                    }
-                    (*key_values)[key_count] = strdup(default_val);
+#define LIST_KEYS_MAX 8
 
-                    if (!(*key_values)[key_count]) {
-                        fprintf(stderr, "%s: Failed to duplicate list key value\n", __func__);
-                        ret = EXIT_FAILURE;
-                        goto cleanup;
-                    }
-                    (*values_lengths)[key_count] = strlen(default_val);
-                    free(default_val);
-                    key_count++;
-                } else {
-                    ret = EXIT_FAILURE;
-                    goto cleanup;
-                }
-            }
-            free(key_name);
-        }
+/**
+ * Creates a list instance from its key values, without building a keys predicate string.
+ * lyd_new_list3() can't be used for this, on libyang version 2.1.148 there is a bug:
+ * https://github.com/CESNET/libyang/pull/2207, so the values are passed to lyd_new_list().
+ * @param [in] parent: data node to create the list instance under.
+ * @param [in] s_node: list schema node.
+ * @param [in] key_values: key values, in the list schema keys order.
+ * @param [in] keys_count: number of key values.
+ * @param [out] node: created list instance.
+ * @return LY_SUCCESS on success, libyang error code otherwise.
+ */
+LY_ERR new_list_instance(struct oper_node *parent, const struct lysc_node *s_node,
+                         const char **key_values, int keys_count, struct oper_node **node)
+{
+    struct lyd_node *lyd_parent = (struct lyd_node *)parent, **lyd_node = (struct lyd_node **)node;
+    const char **v = key_values;
+
+    if (oper_doc) {
+        const struct lysc_node *key;
+        int i = 0;
+        LY_ERR ret = oper_new_inner(parent, s_node, node);
+        LY_LIST_FOR(lysc_node_child(s_node), key)
+        {
+            if (ret != LY_SUCCESS || !lysc_is_key(key))
+                continue;
+            if (i == keys_count)
+                return LY_EINVAL;
+            ret = oper_new_term(*node, key, key_values[i++]);
+        }
+        return ret;
+    }
+
+    switch (keys_count) {
+    case 0:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node);
+    case 1:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0]);
+    case 2:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1]);
+    case 3:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1], v[2]);
+    case 4:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1], v[2], v[3]);
+    case 5:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1], v[2], v[3],
+                            v[4]);
+    case 6:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1], v[2], v[3],
+                            v[4], v[5]);
+    case 7:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1], v[2], v[3],
+                            v[4], v[5], v[6]);
+    case 8:
+        return lyd_new_list(lyd_parent, NULL, s_node->name, 0, lyd_node, v[0], v[1], v[2], v[3],
+                            v[4], v[5], v[6], v[7]);
+    default:
+        fprintf(stderr, "%s: list \"%s\" has more than %d keys\n", __func__, s_node->name,
+                LIST_KEYS_MAX);
+        return LY_EINVAL;
     }
-    (*keys_num) = key_count;
-    ret = EXIT_SUCCESS;
-cleanup:
-    return ret;
 }
 
-/* helper function convert json-c object to lyd_new_list2 keys string format */
-int jobj_to_list2_keys(json_object *keys_jobj, char **keys_str)
+/**
+ * Creates a list instance from key names and values given in any order.
+ * @param [in] parent: data node to create the list instance under.
+ * @param [in] s_node: list schema node.
+ * @param [in] key_names: key names.
+ * @param [in] values: key values, values[i] is the value of key_names[i].
+ * @param [in] count: number of key names and values.
+ * @param [out] node: created list instance.
+ * @return LY_SUCCESS on success, libyang error code otherwise.
+ */
+LY_ERR new_list_instance_by_names(struct oper_node *parent, const struct lysc_node *s_node,
+                                  const char **key_names, const char **values, int count,
+                                  struct oper_node **node)
 {
-    // Calculate the length of the result string
-    int str_length = 1; // Start with 1 for the null terminator
-    json_object_object_foreach(keys_jobj, key_alloc, val_alloc)
-    {
-        // Add the length of each key-value pair to the total length
-        str_length +=
-            snprintf(NULL, 0, "[%s=%s] ", key_alloc,
-                     json_object_to_json_string_ext(val_alloc, JSON_C_TO_STRING_NOSLASHESCAPE));
-    }
+    const char *key_values[LIST_KEYS_MAX];
+    int keys_count = 0;
+    const struct lysc_node *child;
 
-    // Allocate memory for the result string
-    char *result_str = (char *)malloc(str_length * sizeof(char));
-    if (!result_str) {
-        fprintf(stderr, "%s: Failed to allocate memory\n", __func__);
-        return EXIT_FAILURE;
-    }
-    result_str[0] = '\0';
-    json_object_object_foreach(keys_jobj, key, val)
+    LY_LIST_FOR(lysc_node_child(s_node), child)
     {
-        sprintf(result_str + strlen(result_str), "[%s=%s]", key,
-                json_object_to_json_string_ext(val, JSON_C_TO_STRING_NOSLASHESCAPE));
+        if (!lysc_is_key(child))
+            continue;
+        if (keys_count == LIST_KEYS_MAX) {
+            fprintf(stderr, "%s: list \"%s\" has more than %d keys\n", __func__, s_node->name,
+                    LIST_KEYS_MAX);
+            return LY_EINVAL;
+        }
+        int i;
+        for (i = 0; i < count; i++) {
+            if (!strcmp(key_names[i], child->name))
+                break;
+        }
+        if (i == count || values[i] == NULL) {
+            fprintf(stderr, "%s: list \"%s\" key \"%s\" value is missing\n", __func__,
+                    s_node->name, child->name);
+            return LY_EINVAL;
+        }
+        key_values[keys_count++] = values[i];
     }
-    *keys_str = strdup(result_str);
-    free(result_str);
-
-    return EXIT_SUCCESS;
+    return new_list_instance(parent, s_node, key_values, keys_count, node);
 }
+
 /**
- * Outputs keys in the format needed for lyd_new_list2 as workaround of to libyang bug:
- * https://github.com/CESNET/libyang/pull/2207
- * 
  * Extracts keys and their values from a JSON array object based on the YANG list Schema keys.
  * This function is used to map JSON array data to YANG schema list keys.
  * @param [in] list: YANG list schema node.
  * @param [in] json_array_obj: JSON object containing the list's data.
- * @param [out] key: extracted keys string in the format [key1="val"][keyN="val"]
- * @param [out] values_lengths: Pointer to store the lengths of the keys' values.
+ * @param [out] key_values: extracted key values in the list schema keys order, values are owned
+ * by json_array_obj unless they are also set in combined_values.
+ * @param [out] combined_values: combined key values, to be freed by the caller.
  * @param [out] keys_num: Pointer to store the number of keys extracted.
  * @return Returns EXIT_SUCCESS if keys are successfully extracted; otherwise, returns EXIT_FAILURE.
  */
-int get_list_keys2(const struct lysc_node_list *list, json_object *json_array_obj, char **keys)
+int get_list_keys2(const struct lysc_node_list *list, json_object *json_array_obj,
+                   const char *key_values[LIST_KEYS_MAX], char *combined_values[LIST_KEYS_MAX],
+                   int *keys_num)
 {
     int ret = EXIT_SUCCESS;
+    int key_count = 0;
     struct json_object *temp_value, *combine_ext_jobj = NULL;
-    json_object *keys_jobj = json_object_new_object();
     const struct lysc_node *child;
     for (child = list->child; child; child = child->next) {
         char *key_name = NULL, *combine_ext_str = NULL, *default_val = NULL;
         if (lysc_is_key(child)) {
+            if (key_count == LIST_KEYS_MAX) {
+                fprintf(stderr, "%s: list \"%s\" has more than %d keys\n", __func__,
+                        list->name, LIST_KEYS_MAX);
+                ret = EXIT_FAILURE;
+                goto cleanup;
+            }
+            combined_values[key_count] = NULL;
             if (get_lys_extension(OPER_ARG_NAME_EXT, child, &key_name) == EXIT_SUCCESS) {
                 if (key_name == NULL) {
                     fprintf(stderr,
                             "%s: ipr2cgen:oper-arg-name extension found but failed to "
                             "get the arg-name value for node \"%s\"\n",
                             __func__, child->name);
-                    return EXIT_FAILURE;
+                    ret = EXIT_FAILURE;
+                    goto cleanup;
                 }
             } else {
-                key_name = strdup(child->name);
+                key_name = arena_strdup(&oper_arena, child->name);
             }
             if (get_lys_extension(OPER_DEFAULT_VALUE_EXT, child, &default_val) == EXIT_SUCCESS) {
                 if (default_val == NULL) {
@@ -465,7 +1186,8 @@ int get_list_keys2(const struct lysc_node_list *list, json_object *json_array_ob
                             "%s: ipr2cgen:oper-default-val extension found but failed to "
                             "get the value for node \"%s\"\n",
                             __func__, child->name);
-                    return EXIT_FAILURE;
+                    ret = EXIT_FAILURE;
+                    goto cleanup;
                 }
             }
 
@@ -476,58 +1198,54 @@ int get_list_keys2(const struct lysc_node_list *list, json_object *json_array_ob
                             "%s: ipr2cgen:oper-combine-values extension found but failed to "
                             "get the combined values list for node \"%s\"\n",
                             __func__, child->name);
-                    return EXIT_FAILURE;
+                    ret = EXIT_FAILURE;
+                    goto cleanup;
                 }
 
                 combine_ext_jobj = json_tokener_parse(combine_ext_str);
-                free(combine_ext_str);
 
                 if (combine_ext_jobj == NULL) {
                     fprintf(stderr,
                             "%s: Error reading schema node \"%s\" ipr2cgen:oper-stop-if extension,"
                             " the extension value has a bad json format\n",
                             __func__, child->name);
-                    return EXIT_FAILURE;
+                    ret = EXIT_FAILURE;
+                    goto cleanup;
                 }
             }
 
             if (json_object_object_get_ex(json_array_obj, key_name, &temp_value)) {
-                char *value = NULL;
                 if (combine_ext_jobj != NULL) {
-                    value = combine_values(json_array_obj, combine_ext_jobj);
+                    combined_values[key_count] = combine_values(json_array_obj, combine_ext_jobj);
+                    key_values[key_count] = combined_values[key_count];
+                    json_object_put(combine_ext_jobj);
+                    combine_ext_jobj = NULL;
                 } else
-                    value = strdup(json_object_get_string(temp_value));
-
-                json_object_object_add(keys_jobj, child->name, json_object_new_string(value));
-                free(value);
-            } else {
+                    key_values[key_count] = json_object_get_string(temp_value);
+            } else if (!strcmp(child->name, "netns")) {
                 // key value not found in json data.
-                if (!strcmp(child->name, "netns")) {
-                    json_object_object_add(keys_jobj, child->name,
-                                           json_object_new_string(net_namespace));
-                    if (default_val)
-                        free(default_val);
-                } else if (default_val != NULL) {
-                    json_object_object_add(keys_jobj, child->name,
-                                           json_object_new_string(default_val));
-                    free(default_val);
-                } else {
-                    ret = EXIT_FAILURE;
-                    goto cleanup;
-                }
+                key_values[key_count] = net_namespace;
+            } else if (default_val != NULL) {
+                /* the default value is kept by the load pass arena */
+                key_values[key_count] = default_val;
+            } else {
+                ret = EXIT_FAILURE;
+                goto cleanup;
             }
-            free(key_name);
+            key_count++;
         }
     }
 
-    ret = jobj_to_list2_keys(keys_jobj, keys);
 cleanup:
-    if (keys_jobj != NULL) {
-        json_object_put(keys_jobj);
-    }
     if (combine_ext_jobj != NULL) {
         json_object_put(combine_ext_jobj);
     }
+    if (ret != EXIT_SUCCESS) {
+        for (int i = 0; i < key_count; i++)
+            free(combined_values[i]);
+        key_count = 0;
+    }
+    *keys_num = key_count;
     return ret;
 }
 
@@ -557,16 +1275,21 @@ const char *map_value_if_needed(struct json_object *value_map_jobj, const char *
  * (direct value or within an array) equals the value in `cmd_out_jobj`. Termination is advised if 
  * any match is found.
  *
+ * @param [in] s_node: schema node carrying the termination criteria.
  * @param [in] cmd_out_jobj: JSON object with command output to check.
  * @param [in] termination_obj: JSON object with termination criteria.
  * @return Returns true if a termination condition is met, otherwise false.
  */
-bool terminate_processing(struct json_object *cmd_out_jobj, struct json_object *termination_obj)
+bool terminate_processing(const struct lysc_node *s_node, struct json_object *cmd_out_jobj,
+                          struct json_object *termination_obj)
 {
     struct json_object *cmd_out_val = NULL;
     json_object_object_foreach(termination_obj, key, term_vals_obj)
     {
-        if (find_json_value_by_key(cmd_out_jobj, key, &cmd_out_val)) {
+        /* per family objects are matched when the rows are selected, see select_family_rows() */
+        if (json_object_is_type(term_vals_obj, json_type_object))
+            continue;
+        if (lookup_json_value_by_key(s_node, cmd_out_jobj, key, &cmd_out_val)) {
             if (json_object_is_type(term_vals_obj, json_type_array)) {
                 size_t n_json_values = json_object_array_length(term_vals_obj);
                 for (size_t i = 0; i < n_json_values; i++) {
@@ -589,56 +1312,48 @@ bool terminate_processing(struct json_object *cmd_out_jobj, struct json_object *
 }
 
 /**
- * This function compares schema node (s_node) parents names to lyd_node data tree node name, if the
+ * This function compares schema node (s_node) data parent to lyd_node data tree node schema, if the
  * schema node parent containers are not added to the lyd_node, this function adds them.
  * 
  * This function is to be used before processing leafs and leaf_lists to ensure their parent containers
- * are added to the lyd data tree.
+ * are added to the lyd data tree. parent_data_node acts as the row cursor, it is moved to the
+ * data parent of s_node so the next sibling leafs are matched on the first comparison.
  * 
  * @param [in] s_node: schema node being processed (typically the s_node of a leaf or leaf_list).
  * @param [in] parent_data_node: lyd data tree to which nodes under process are being attached to.
  */
-int add_missing_parents(const struct lysc_node *s_node, struct lyd_node **parent_data_node)
+int add_missing_parents(const struct lysc_node *s_node, struct oper_node **parent_data_node)
 {
     if (*parent_data_node == NULL) {
         fprintf(stderr, "%s: Failed to check node parents, reference lyd_node is NULL\n", __func__);
         return EXIT_FAILURE;
     }
 
-    struct lyd_node *new_data_node = NULL;
-    char snode_parent_xpath[1024] = { 0 };
-    char parent_data_node_xpath[1024] = { 0 };
-    lysc_path(s_node->parent, LYSC_PATH_LOG, snode_parent_xpath, 1024);
-    lysc_path((*parent_data_node)->schema, LYSC_PATH_LOG, parent_data_node_xpath, 1024);
+    /* choice and case nodes have no data instance, skip them */
+    const struct lysc_node *s_parent = lysc_data_parent(s_node);
 
-    /* exit if root node was reached */
-    if (strcmp(snode_parent_xpath, "/") == 0 || strcmp(parent_data_node_xpath, "/") == 0)
+    /* exit if root node was reached or the cursor is already on the parent */
+    const struct lysc_node *s_cursor = oper_node_schema(*parent_data_node);
+    if (s_parent == NULL || s_cursor == NULL || s_cursor == s_parent)
+        return EXIT_SUCCESS;
+
+    if (s_parent->nodetype != LYS_CONTAINER)
         return EXIT_SUCCESS;
 
     /* Check first-level children in case parent was added by a sibling leaf/leaf-list iteration */
-    struct lyd_node *child_node = NULL;
-    LY_LIST_FOR(lyd_child(*parent_data_node), child_node)
-    {
-        if (child_node->schema->nodetype == LYS_CONTAINER) {
-            lysc_path(child_node->schema, LYSC_PATH_LOG, parent_data_node_xpath, 1024);
-            if (strcmp(snode_parent_xpath, parent_data_node_xpath) == 0) {
-                *parent_data_node = child_node;
-                return EXIT_SUCCESS;
-            }
-        }
+    struct oper_node *child_node = NULL;
+    if (oper_find_child(*parent_data_node, s_parent, &child_node) == LY_SUCCESS) {
+        *parent_data_node = child_node;
+        return EXIT_SUCCESS;
     }
 
-    /* check parent xpaths */
-    if (strcmp(snode_parent_xpath, parent_data_node_xpath) != 0 &&
-        s_node->parent->nodetype == LYS_CONTAINER) {
-        /* check grand_parents xpaths */
-        add_missing_parents(s_node->parent, parent_data_node);
+    /* check grand_parents */
+    add_missing_parents(s_parent, parent_data_node);
 
-        /* add missing parent */
-        if (LY_SUCCESS ==
-            lyd_new_inner(*parent_data_node, NULL, s_node->parent->name, 0, &new_data_node)) {
-            *parent_data_node = new_data_node;
-        }
+    /* add missing parent */
+    struct oper_node *new_data_node = NULL;
+    if (LY_SUCCESS == oper_new_inner(*parent_data_node, s_parent, &new_data_node)) {
+        *parent_data_node = new_data_node;
     }
     return EXIT_SUCCESS;
 }
@@ -653,7 +1368,7 @@ int add_missing_parents(const struct lysc_node *s_node, struct lyd_node **parent
  * @param [in] s_node: Schema node corresponding to the leaf nodes to be created.
  */
 void flags_to_leafs(struct json_object *temp_obj, struct json_object *fmap_jobj,
-                    struct lyd_node **parent_data_node, const struct lysc_node *s_node)
+                    struct oper_node **parent_data_node, const struct lysc_node *s_node)
 {
     const char *value = NULL;
     json_object_object_foreach(fmap_jobj, key_flag, flag_map)
@@ -674,7 +1389,7 @@ void flags_to_leafs(struct json_object *temp_obj, struct json_object *fmap_jobj,
         value = json_object_get_string(flag_unset_obj);
     }
     if (value) {
-        if (LY_SUCCESS != lyd_new_term(*parent_data_node, NULL, s_node->name, value, 0, NULL)) {
+        if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, value)) {
             fprintf(stderr, "%s: node %s creation failed\n", __func__, s_node->name);
         }
     } else {
@@ -695,7 +1410,7 @@ void flags_to_leafs(struct json_object *temp_obj, struct json_object *fmap_jobj,
  * @param [in] s_node: Schema node corresponding to the leaf node to be created.
  */
 void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
-                   struct lyd_node **parent_data_node, const struct lysc_node *s_node)
+                   struct oper_node **parent_data_node, const struct lysc_node *s_node)
 {
     char *vmap_str = NULL, *fmap_str = NULL, *val_format_str = NULL, *combine_ext_str = NULL,
          *static_value = NULL;
@@ -703,8 +1418,7 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
                        *combine_ext_jobj = NULL;
 
     if (!strcmp(s_node->name, "netns")) {
-        if (LY_SUCCESS !=
-            lyd_new_term(*parent_data_node, NULL, s_node->name, net_namespace, 0, NULL)) {
+        if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, net_namespace)) {
             fprintf(stderr, "%s: node %s creation failed\n", __func__, s_node->name);
             return;
         }
@@ -719,7 +1433,6 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
             return;
         }
         fmap_jobj = fmap_str ? json_tokener_parse(fmap_str) : NULL;
-        free(fmap_str);
         if (fmap_jobj == NULL) {
             fprintf(stderr,
                     "%s: Error reading schema node \"%s\" ipr2cgen:oper-flag-map extension,"
@@ -736,7 +1449,6 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
             return;
         }
         vmap_jobj = vmap_str ? json_tokener_parse(vmap_str) : NULL;
-        free(vmap_str);
         if (vmap_jobj == NULL) {
             fprintf(stderr,
                     "%s: Error reading schema node \"%s\" ipr2cgen:oper-value-map extension,"
@@ -763,7 +1475,6 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
             return;
         }
         val_format_jobj = val_format_str ? json_tokener_parse(val_format_str) : NULL;
-        free(val_format_str);
         if (val_format_jobj == NULL) {
             fprintf(stderr,
                     "%s: Error reading schema node \"%s\" ipr2cgen:oper-change-format extension,"
@@ -781,7 +1492,6 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
             return;
         }
         combine_ext_jobj = combine_ext_str ? json_tokener_parse(combine_ext_str) : NULL;
-        free(combine_ext_str);
         if (combine_ext_jobj == NULL) {
             fprintf(stderr,
                     "%s: Error reading schema node \"%s\" ipr2cgen:oper-combine-value extension,"
@@ -795,20 +1505,17 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
     /* Attempt to directly find the argument name otherwise use the find function */
     json_bool argname_found = json_object_object_get_ex(json_obj, arg_name, &temp_obj);
     if (!argname_found) {
-        argname_found = find_json_value_by_key(json_obj, arg_name, &temp_obj);
+        argname_found = lookup_json_value_by_key(s_node, json_obj, arg_name, &temp_obj);
     }
 
     /* Proceed only if arg_name is found as a key */
     if (argname_found) {
         add_missing_parents(s_node, parent_data_node);
         if (static_value) {
-            if (LY_SUCCESS !=
-                lyd_new_term(*parent_data_node, NULL, s_node->name, static_value, 0, NULL)) {
+            if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, static_value)) {
                 fprintf(stderr, "%s: node %s creation failed\n", __func__, s_node->name);
-                free(static_value);
                 return;
             }
-            free(static_value);
         } else if (temp_obj) {
             if (json_object_is_type(temp_obj, json_type_array) && fmap_jobj) {
                 /* array values are processed as flags. */
@@ -817,23 +1524,19 @@ void jdata_to_leaf(struct json_object *json_obj, const char *arg_name,
                 /* Process a single value */
                 if (val_format_jobj) {
                     char *converted_value = convert_value(temp_obj, val_format_jobj);
-                    if (LY_SUCCESS != lyd_new_term(*parent_data_node, NULL, s_node->name,
-                                                   converted_value, 0, NULL)) {
+                    if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, converted_value)) {
                         fprintf(stderr, "%s: node %s creation failed\n", __func__, s_node->name);
                     }
-                    free(converted_value);
                 } else if (combine_ext_jobj) {
                     char *combined_value = combine_values(temp_obj, combine_ext_jobj);
-                    if (LY_SUCCESS != lyd_new_term(*parent_data_node, NULL, s_node->name,
-                                                   combined_value, 0, NULL)) {
+                    if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, combined_value)) {
                         fprintf(stderr, "%s: node %s creation failed\n", __func__, s_node->name);
                     }
                     free(combined_value);
                 } else {
                     const char *value =
                         map_value_if_needed(vmap_jobj, json_object_get_string(temp_obj));
-                    if (LY_SUCCESS !=
-                        lyd_new_term(*parent_data_node, NULL, s_node->name, value, 0, NULL)) {
+                    if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, value)) {
                         fprintf(stderr, "%s: node %s creation failed\n", __func__, s_node->name);
                     }
                 }
@@ -867,7 +1570,7 @@ cleanup:
  * @param [in] s_node: Schema node corresponding to the leaf-list node to be created.
  */
 void jdata_to_leaflist(struct json_object *json_array_obj, const char *arg_name,
-                       struct lyd_node **parent_data_node, const struct lysc_node *s_node)
+                       struct oper_node **parent_data_node, const struct lysc_node *s_node)
 {
     char *vmap_str = NULL;
     if (get_lys_extension(OPER_VALUE_MAP_EXT, s_node, &vmap_str) == EXIT_SUCCESS) {
@@ -880,14 +1583,11 @@ void jdata_to_leaflist(struct json_object *json_array_obj, const char *arg_name,
         }
     }
     struct json_object *vmap_jobj = vmap_str ? json_tokener_parse(vmap_str) : NULL;
-    if (vmap_str) {
-        free(vmap_str);
-    }
 
     struct json_object *temp_obj = NULL;
     // Attempt to directly find the argument name or use search function
     if (!json_object_object_get_ex(json_array_obj, arg_name, &temp_obj)) {
-        find_json_value_by_key(json_array_obj, arg_name, &temp_obj);
+        lookup_json_value_by_key(s_node, json_array_obj, arg_name, &temp_obj);
     }
 
     // Proceed only if temp_obj is found
@@ -900,8 +1600,7 @@ void jdata_to_leaflist(struct json_object *json_array_obj, const char *arg_name,
                 struct json_object *inner_value = json_object_array_get_idx(temp_obj, i);
                 const char *value =
                     map_value_if_needed(vmap_jobj, json_object_get_string(inner_value));
-                if (LY_SUCCESS !=
-                    lyd_new_term(*parent_data_node, NULL, s_node->name, value, 0, NULL)) {
+                if (LY_SUCCESS != oper_new_term(*parent_data_node, s_node, value)) {
                     fprintf(stderr, "%s: node %s creation failed.\n", s_node->name, __func__);
                 }
             }
@@ -913,63 +1612,29 @@ void jdata_to_leaflist(struct json_object *json_array_obj, const char *arg_name,
     }
 }
 
-/*
-This function shouldn't be used.
-Uses lyd_new_list3, on libyang version 2.1.148 there is a bug:
-https://github.com/CESNET/libyang/pull/2207
-*/
-void single_jobj_to_list(struct json_object *json_obj, struct lyd_node **parent_data_node,
-                         const struct lysc_node *s_node, uint16_t lys_flags)
-{
-    const struct lysc_node_list *list = (const struct lysc_node_list *)s_node;
-    const char **key_values;
-    uint32_t *values_lengths;
-    int keys_count;
-    if (get_list_keys(list, json_obj, &key_values, &values_lengths, &keys_count) == EXIT_SUCCESS) {
-        add_missing_parents(s_node, parent_data_node);
-        struct lyd_node *new_data_node = NULL;
-        if (LY_SUCCESS != lyd_new_list3(*parent_data_node, NULL, s_node->name, key_values,
-                                        values_lengths, 0, &new_data_node)) {
-            fprintf(stderr, "%s: list \"%s\" creation failed.\n", __func__, s_node->name);
-            free_list_params(&key_values, &values_lengths, keys_count);
-            return;
-        }
-
-        free_list_params(&key_values, &values_lengths, keys_count);
-
-        if (!new_data_node)
-            new_data_node = *parent_data_node;
-
-        // Recursively process child nodes
-        const struct lysc_node *s_child;
-        LY_LIST_FOR(lysc_node_child(s_node), s_child)
-        {
-            if (process_node(s_child, json_obj, lys_flags, &new_data_node))
-                return;
-        }
-    }
-}
-
 /* 
-Uses lyd_new_list2
+Creates the list instance with new_list_instance()
 */
-void single_jobj_to_list2(struct json_object *json_obj, struct lyd_node **parent_data_node,
+void single_jobj_to_list2(struct json_object *json_obj, struct oper_node **parent_data_node,
                           const struct lysc_node *s_node, uint16_t lys_flags)
 {
     const struct lysc_node_list *list = (const struct lysc_node_list *)s_node;
-    char *keys = NULL;
-    if (get_list_keys2(list, json_obj, &keys) == EXIT_SUCCESS) {
-        if (add_missing_parents(s_node, parent_data_node) == EXIT_FAILURE)
-            return;
-        struct lyd_node *new_data_node = NULL;
-        if (LY_SUCCESS !=
-            lyd_new_list2(*parent_data_node, NULL, s_node->name, keys, 0, &new_data_node)) {
+    const char *key_values[LIST_KEYS_MAX];
+    char *combined_values[LIST_KEYS_MAX];
+    int keys_count = 0;
+    if (get_list_keys2(list, json_obj, key_values, combined_values, &keys_count) ==
+        EXIT_SUCCESS) {
+        struct oper_node *new_data_node = NULL;
+        LY_ERR ly_ret = LY_EINVAL;
+        if (add_missing_parents(s_node, parent_data_node) == EXIT_SUCCESS)
+            ly_ret = new_list_instance(*parent_data_node, s_node, key_values, keys_count,
+                                       &new_data_node);
+        for (int i = 0; i < keys_count; i++)
+            free(combined_values[i]);
+        if (ly_ret != LY_SUCCESS) {
             fprintf(stderr, "%s: list \"%s\" creation failed.\n", __func__, s_node->name);
-            //free_list_params(&key_values, &values_lengths, keys_count);
-            free(keys);
             return;
         }
-        //free_list_params(&key_values, &values_lengths, keys_count);
 
         if (!new_data_node)
             new_data_node = *parent_data_node;
@@ -982,7 +1647,6 @@ void single_jobj_to_list2(struct json_object *json_obj, struct lyd_node **parent
                 return;
         }
     }
-    free(keys);
 }
 
 /**
@@ -999,7 +1663,7 @@ void single_jobj_to_list2(struct json_object *json_obj, struct lyd_node **parent
  */
 void jdata_to_list(struct json_object *json_obj, const char *arg_name,
                    const struct lysc_node *s_node, uint16_t lys_flags,
-                   struct lyd_node **parent_data_node)
+                   struct oper_node **parent_data_node)
 {
     // json_obj itself is an array of objects
     if (json_object_get_type(json_obj) == json_type_array) {
@@ -1011,7 +1675,7 @@ void jdata_to_list(struct json_object *json_obj, const char *arg_name,
     }
     // json_obj itself is single object but its content is an array
     struct json_object *lists_arrays;
-    if (find_json_value_by_key(json_obj, arg_name, &lists_arrays) &&
+    if (lookup_json_value_by_key(s_node, json_obj, arg_name, &lists_arrays) &&
         json_object_get_type(lists_arrays) == json_type_array) {
         size_t n_arrays = json_object_array_length(lists_arrays);
         for (size_t i = 0; i < n_arrays; i++) {
@@ -1024,94 +1688,82 @@ void jdata_to_list(struct json_object *json_obj, const char *arg_name,
     }
 }
 
-/* helper function to generate tc filter commands based on required filter type */
-void generate_tc_filter_sh_cmds(char **commands, int *command_count, char *tc_filter_type,
-                                const char *dev_name, const char *qdisc_kind,
-                                const char *ingress_block, const char *egress_block)
+/* tc dump requests generated from the qdisc list */
+struct tc_dump_reqs {
+    struct tc_dump_req *reqs;
+    int count;
+    int size;
+};
+
+/* conversion context of the tc dump callbacks */
+struct tc_dump_ctx {
+    const struct lysc_node *s_node;
+    struct oper_node **parent_data_node;
+    uint16_t lys_flags;
+    struct json_object *wanted_keys;
+};
+
+/**
+ * Appends a tc dump request, the requests array is grown as needed.
+ * @param [in,out] reqs: tc dump requests.
+ * @param [in] type: dumped tc objects.
+ * @param [in] dev: device name, NULL for a shared block.
+ * @param [in] block: shared block index, NULL for a device.
+ * @param [in] direction: clsact direction, NULL for all the device parents.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on memory allocation failure.
+ */
+static int add_tc_dump_req(struct tc_dump_reqs *reqs, tc_dump_type_t type, const char *dev,
+                           const char *block, const char *direction)
+{
+    if (reqs->count == reqs->size) {
+        int size = reqs->size ? reqs->size * 2 : 16;
+        struct tc_dump_req *new_reqs = realloc(reqs->reqs, size * sizeof(*new_reqs));
+        if (new_reqs == NULL) {
+            fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+            return EXIT_FAILURE;
+        }
+        reqs->reqs = new_reqs;
+        reqs->size = size;
+    }
+    reqs->reqs[reqs->count++] = (struct tc_dump_req){
+        .type = type, .dev = dev, .block = block, .direction = direction
+    };
+    return EXIT_SUCCESS;
+}
+
+/* helper function to generate tc filter dump requests based on required filter type */
+int generate_tc_filter_reqs(struct tc_dump_reqs *reqs, char *tc_filter_type, const char *dev_name,
+                            const char *qdisc_kind, const char *ingress_block,
+                            const char *egress_block)
 {
-    if (*command_count >= CMDS_ARRAY_SIZE) {
-        fprintf(stderr, "%s: Command buffer overflow.\n", __func__);
-        return;
-    }
-
-    int result;
+    int ret = EXIT_SUCCESS;
 
     if (strcmp(tc_filter_type, "shared-block-filter") == 0) {
         if (strcmp(qdisc_kind, "ingress") == 0 && ingress_block) {
-            result = snprintf(commands[*command_count], CMD_LINE_SIZE, "tc filter show block %s",
-                              ingress_block);
-            if (result < 0 || result >= CMD_LINE_SIZE) {
-                fprintf(stderr, "%s: snprintf failed or truncated for ingress block.\n", __func__);
-                return;
-            }
-            (*command_count)++;
+            ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, NULL, ingress_block, NULL);
         } else if (strcmp(qdisc_kind, "clsact") == 0) {
-            if (ingress_block) {
-                result = snprintf(commands[*command_count], CMD_LINE_SIZE,
-                                  "tc filter show block %s", ingress_block);
-                if (result < 0 || result >= CMD_LINE_SIZE) {
-                    fprintf(stderr,
-                            "%s: snprintf failed or truncated for ingress block (clsact).\n",
-                            __func__);
-                    return;
-                }
-                (*command_count)++;
-            }
-            if (egress_block) {
-                result = snprintf(commands[*command_count], CMD_LINE_SIZE,
-                                  "tc filter show block %s", egress_block);
-                if (result < 0 || result >= CMD_LINE_SIZE) {
-                    fprintf(stderr, "%s: snprintf failed or truncated for egress block.\n",
-                            __func__);
-                    return;
-                }
-                (*command_count)++;
-            }
+            if (ingress_block)
+                ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, NULL, ingress_block, NULL);
+            if (ret == EXIT_SUCCESS && egress_block)
+                ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, NULL, egress_block, NULL);
         }
     } else if (strcmp(tc_filter_type, "dev-filter") == 0 && (!ingress_block || !egress_block)) {
         if (strcmp(qdisc_kind, "ingress") == 0) {
-            result = snprintf(commands[*command_count], CMD_LINE_SIZE,
-                              "tc filter show dev %s ingress", dev_name);
-            if (result < 0 || result >= CMD_LINE_SIZE) {
-                fprintf(stderr, "%s: snprintf failed or truncated for dev ingress filter.\n",
-                        __func__);
-                return;
-            }
-            (*command_count)++;
+            ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, dev_name, NULL, "ingress");
         } else if (strcmp(qdisc_kind, "clsact") == 0) {
-            result = snprintf(commands[*command_count], CMD_LINE_SIZE,
-                              "tc filter show dev %s ingress", dev_name);
-            if (result < 0 || result >= CMD_LINE_SIZE) {
-                fprintf(stderr,
-                        "%s: snprintf failed or truncated for dev ingress filter (clsact).\n",
-                        __func__);
-                return;
-            }
-            (*command_count)++;
-
-            result = snprintf(commands[*command_count], CMD_LINE_SIZE,
-                              "tc filter show dev %s egress", dev_name);
-            if (result < 0 || result >= CMD_LINE_SIZE) {
-                fprintf(stderr, "%s: snprintf failed or truncated for dev egress filter.\n",
-                        __func__);
-                return;
-            }
-            (*command_count)++;
+            ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, dev_name, NULL, "ingress");
+            if (ret == EXIT_SUCCESS)
+                ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, dev_name, NULL, "egress");
         }
     } else if (strcmp(tc_filter_type, "qdisc-filter") == 0) {
-        result =
-            snprintf(commands[*command_count], CMD_LINE_SIZE, "tc filter show dev %s", dev_name);
-        if (result < 0 || result >= CMD_LINE_SIZE) {
-            fprintf(stderr, "%s: snprintf failed or truncated for qdisc filter.\n", __func__);
-            return;
-        }
-        (*command_count)++;
+        ret = add_tc_dump_req(reqs, TC_DUMP_FILTERS, dev_name, NULL, NULL);
     }
+    return ret;
 }
 
-/* helper function to generate tc filter commands using the information in interfaces qdiscs */
-void qdiscs_to_filters_cmds(struct json_object *qdisc_array, char *tc_filter_type, char **commands,
-                            int *command_count)
+/* helper function to generate tc filter dump requests using the information in interfaces qdiscs */
+int qdiscs_to_filters_reqs(struct json_object *qdisc_array, char *tc_filter_type,
+                           struct tc_dump_reqs *reqs)
 {
     size_t n_qdiscs = json_object_array_length(qdisc_array);
 
@@ -1160,21 +1812,17 @@ void qdiscs_to_filters_cmds(struct json_object *qdisc_array, char *tc_filter_typ
             }
         }
 
-        if (*command_count >= CMDS_ARRAY_SIZE) {
-            fprintf(stderr, "%s: Command buffer overflow.\n", __func__);
-            return;
-        }
-
-        generate_tc_filter_sh_cmds(commands, command_count, tc_filter_type, dev_str, kind_str,
-                                   ingress_block_str, egress_block_str);
+        if (generate_tc_filter_reqs(reqs, tc_filter_type, dev_str, kind_str, ingress_block_str,
+                                    egress_block_str) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
     }
+    return EXIT_SUCCESS;
 }
 
-/* helper function to generate tc class commands using the information in interfaces qdiscs */
-void qdiscs_to_classes_cmds(struct json_object *qdisc_array, char **commands, int *command_count)
+/* helper function to generate tc class dump requests using the information in interfaces qdiscs */
+int qdiscs_to_classes_reqs(struct json_object *qdisc_array, struct tc_dump_reqs *reqs)
 {
     int array_len = json_object_array_length(qdisc_array);
-    *command_count = 0;
 
     for (int i = 0; i < array_len; i++) {
         struct json_object *qdisc_obj = json_object_array_get_idx(qdisc_array, i);
@@ -1189,376 +1837,208 @@ void qdiscs_to_classes_cmds(struct json_object *qdisc_array, char **commands, in
             // Check if the qdisc type supports classes
             if (strcmp(kind, "htb") == 0 || strcmp(kind, "cbq") == 0 || strcmp(kind, "hfsc") == 0 ||
                 strcmp(kind, "atm") == 0 || strcmp(kind, "dsmark") == 0) {
-                // Generate the tc class show command
-                char command[256];
-                snprintf(command, sizeof(command), "tc class show dev %s", dev);
-
-                // Store the command in the commands array
-                commands[*command_count] = strdup(command);
-                (*command_count)++;
+                if (add_tc_dump_req(reqs, TC_DUMP_CLASSES, dev, NULL, NULL) != EXIT_SUCCESS)
+                    return EXIT_FAILURE;
             }
         }
     }
+    return EXIT_SUCCESS;
 }
 
 /**
- * dumps tc filters configured on the system into sysrepo YANG data tree 
+ * Parses the tc dump output held in json_buffer.
+ * @param [in] req: completed tc dump request.
+ * @param [in] wanted_keys: json keys read by the converter.
+ * @return json array of the dumped objects, NULL on parse failure.
  */
-int dump_tc_filters(char *tc_filter_type, const struct lysc_node *s_node,
-                    struct lyd_node **parent_data_node, int lys_flags)
+static struct json_object *parse_tc_dump_output(const struct tc_dump_req *req,
+                                                struct json_object *wanted_keys)
 {
-    int tc_command_count = 0;
-    char tc_cmd_key_value[CMD_LINE_SIZE];
-    char *tc_cmd_key_name = NULL, *tc_filter_direction = NULL;
-    struct json_object *qdisc_cmd_output = NULL, *tc_cmd_output = NULL;
-    char **tc_commands = NULL;
-    int ret = EXIT_FAILURE;
-
-    /* Apply tc qdisc command */
-    char tc_qdisc_cmd[CMD_LINE_SIZE] = "tc qdisc list";
-    if (strcmp(net_namespace, "1") != 0) {
-        insert_netns(tc_qdisc_cmd, net_namespace);
-    }
-    if (apply_ipr2_cmd(tc_qdisc_cmd) != EXIT_SUCCESS) {
-        fprintf(stderr, "%s: command execution failed\n", __func__);
-        goto cleanup;
-    }
+    struct json_object *output = json_scan_parse(json_buffer, wanted_keys);
+
+    if (output == NULL)
+        output = json_tokener_parse(json_buffer);
+    if (output == NULL)
+        fprintf(stderr, "%s: JSON parsing failed for %s %s dump output\n", __func__,
+                req->dev ? "dev" : "block", req->dev ? req->dev : req->block);
+    return output;
+}
 
-    /* Allocate memory for tc filter commands */
-    tc_commands = calloc(CMDS_ARRAY_SIZE, sizeof(char *));
-    if (tc_commands == NULL) {
-        fprintf(stderr, "%s: Failed to allocate memory for tc_commands array\n", __func__);
-        goto cleanup;
-    }
-    for (int i = 0; i < CMDS_ARRAY_SIZE; i++) {
-        tc_commands[i] = calloc(CMD_LINE_SIZE, sizeof(char));
-        if (tc_commands[i] == NULL) {
-            fprintf(stderr, "%s: Failed to allocate memory for command string at index %d\n",
-                    __func__, i);
-            goto cleanup;
-        }
-    }
+/**
+ * tc filters dump callback, converts the filter rules of one device or shared block into a
+ * tc filter list instance.
+ * @param [in] req: completed tc dump request, its output is in json_buffer.
+ * @param [in] arg: struct tc_dump_ctx conversion context.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int tc_filters_to_list(const struct tc_dump_req *req, void *arg)
+{
+    struct tc_dump_ctx *ctx = arg;
+    struct json_object *tc_rules = parse_tc_dump_output(req, ctx->wanted_keys);
+    if (tc_rules == NULL)
+        return EXIT_FAILURE;
 
-    /* Parse qdisc command output */
-    qdisc_cmd_output = json_tokener_parse(json_buffer);
-    if (qdisc_cmd_output == NULL) {
-        fprintf(stderr, "%s: JSON parsing failed for qdisc output\n", __func__);
-        goto cleanup;
+    if (json_object_get_type(tc_rules) != json_type_array ||
+        json_object_array_length(tc_rules) == 0) {
+        json_object_put(tc_rules);
+        return EXIT_SUCCESS; /* No data to process */
+    }
+
+    /* Create tc filter list in YANG data tree */
+    const char *filter_key_names[] = { req->dev ? "dev" : "block", "netns", "direction" };
+    const char *filter_key_values[] = { req->dev ? req->dev : req->block, net_namespace,
+                                        req->direction };
+    int filter_keys_count = req->direction != NULL ? 3 : 2;
+    struct oper_node *new_filter = NULL;
+    if (new_list_instance_by_names(*ctx->parent_data_node, ctx->s_node, filter_key_names,
+                                   filter_key_values, filter_keys_count,
+                                   &new_filter) != LY_SUCCESS) {
+        fprintf(stderr, "%s: Failed to create new list in YANG data tree\n", __func__);
+        json_object_put(tc_rules);
+        return EXIT_FAILURE;
     }
 
-    if (json_object_get_type(qdisc_cmd_output) == json_type_array) {
-        qdiscs_to_filters_cmds(qdisc_cmd_output, tc_filter_type, tc_commands, &tc_command_count);
-    } else {
-        fprintf(stderr, "%s: Unexpected JSON type for qdisc output\n", __func__);
-        goto cleanup;
+    /* Process individual filter rules, the filter head rows are already skipped by the dump */
+    size_t n_rules = json_object_array_length(tc_rules);
+    for (size_t i = 0; i < n_rules; i++) {
+        struct json_object *tc_rule_obj = json_object_array_get_idx(tc_rules, i);
+        const struct lysc_node *s_child = NULL;
+        LY_LIST_FOR(lysc_node_child(ctx->s_node), s_child)
+        {
+            process_node(s_child, tc_rule_obj, ctx->lys_flags, &new_filter);
+        }
     }
-    json_object_put(qdisc_cmd_output);
-    qdisc_cmd_output = NULL;
+    json_object_put(tc_rules);
+    return EXIT_SUCCESS;
+}
 
-    /* Process each tc filter command */
-    for (int i = 0; i < tc_command_count; i++) {
-        /* Apply tc filter command */
-        if (apply_ipr2_cmd(tc_commands[i]) != EXIT_SUCCESS) {
-            fprintf(stderr, "%s: command execution failed for command: %s\n", __func__,
-                    tc_commands[i]);
-            goto cleanup;
-        }
+/**
+ * tc classes dump callback, converts the classes of one device into tc class list instances.
+ * @param [in] req: completed tc dump request, its output is in json_buffer.
+ * @param [in] arg: struct tc_dump_ctx conversion context.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+static int tc_classes_to_list(const struct tc_dump_req *req, void *arg)
+{
+    struct tc_dump_ctx *ctx = arg;
+    struct json_object *tc_classes = parse_tc_dump_output(req, ctx->wanted_keys);
+    int ret = EXIT_SUCCESS;
+    if (tc_classes == NULL)
+        return EXIT_FAILURE;
 
-        /* Parse tc filter command output */
-        tc_cmd_output = json_tokener_parse(json_buffer);
-        if (tc_cmd_output == NULL) {
-            fprintf(stderr, "%s: JSON parsing failed for command output: %s\n", __func__,
-                    tc_commands[i]);
-            goto cleanup;
-        }
-        if (json_object_get_type(tc_cmd_output) != json_type_array ||
-            json_object_array_length(tc_cmd_output) == 0) {
-            json_object_put(tc_cmd_output);
-            tc_cmd_output = NULL;
-            continue; /* No data to process, proceed to next tc filter command */
-        }
-
-        /* Extract keys from command */
-        if (strstr(tc_commands[i], "block")) {
-            if (sscanf(tc_commands[i], "tc filter show block %s", tc_cmd_key_value) != 1) {
-                fprintf(stderr, "%s: Failed to parse block from command: %s\n", __func__,
-                        tc_commands[i]);
-                json_object_put(tc_cmd_output);
-                tc_cmd_output = NULL;
-                goto cleanup;
-            }
-            tc_cmd_key_name = "block";
-            tc_filter_direction = NULL;
-        } else if (strstr(tc_commands[i], "dev")) {
-            if (sscanf(tc_commands[i], "tc filter show dev %s", tc_cmd_key_value) != 1) {
-                fprintf(stderr, "%s: Failed to parse dev from command: %s\n", __func__,
-                        tc_commands[i]);
-                json_object_put(tc_cmd_output);
-                tc_cmd_output = NULL;
-                goto cleanup;
-            }
-            tc_cmd_key_name = "dev";
-
-            if (strstr(tc_commands[i], "ingress"))
-                tc_filter_direction = "ingress";
-            else if (strstr(tc_commands[i], "egress"))
-                tc_filter_direction = "egress";
-            else
-                tc_filter_direction = NULL;
-        } else {
-            fprintf(stderr, "%s: Unknown command format: %s\n", __func__, tc_commands[i]);
-            json_object_put(tc_cmd_output);
-            tc_cmd_output = NULL;
-            goto cleanup;
-        }
-
-        /* Create tc filter list in YANG data tree */
-        json_object *filter_list_jobj = json_object_new_object();
-        if (!filter_list_jobj) {
-            fprintf(stderr, "%s: Failed to create JSON object for filter list\n", __func__);
-            json_object_put(tc_cmd_output);
-            tc_cmd_output = NULL;
-            goto cleanup;
-        }
-        json_object_object_add(filter_list_jobj, tc_cmd_key_name,
-                               json_object_new_string(tc_cmd_key_value));
-        json_object_object_add(filter_list_jobj, "netns", json_object_new_string(net_namespace));
-        if (tc_filter_direction != NULL)
-            json_object_object_add(filter_list_jobj, "direction",
-                                   json_object_new_string(tc_filter_direction));
-        char *filter_list_str = NULL;
-        jobj_to_list2_keys(filter_list_jobj, &filter_list_str);
-        json_object_put(filter_list_jobj);
-        filter_list_jobj = NULL;
-
-        if (!filter_list_str) {
-            fprintf(stderr, "%s: Failed to convert JSON object to string for filter list\n",
-                    __func__);
-            json_object_put(tc_cmd_output);
-            tc_cmd_output = NULL;
-            goto cleanup;
-        }
-        struct lyd_node *new_filter = NULL;
-        if (lyd_new_list2(*parent_data_node, NULL, s_node->name, filter_list_str, 0, &new_filter) !=
-            LY_SUCCESS) {
+    /* iterate through every class array */
+    size_t n_classes = 0;
+    if (json_object_get_type(tc_classes) == json_type_array)
+        n_classes = json_object_array_length(tc_classes);
+    for (size_t i = 0; i < n_classes; i++) {
+        struct json_object *tc_class_obj = json_object_array_get_idx(tc_classes, i);
+
+        /* Extract tc class list keys */
+        struct json_object *classid_obj, *parent_obj;
+        const char *classid_str = NULL, *parent_str = NULL;
+        if (json_object_object_get_ex(tc_class_obj, "handle", &classid_obj)) {
+            classid_str = json_object_get_string(classid_obj);
+        }
+        if (json_object_object_get_ex(tc_class_obj, "parent", &parent_obj)) {
+            parent_str = json_object_get_string(parent_obj);
+        } else if (json_object_object_get_ex(tc_class_obj, "root", &parent_obj)) {
+            parent_str = "root";
+        }
+
+        /* create tc class YANG list data tree */
+        const char *class_key_names[] = { "dev", "netns", "parent", "classid" };
+        const char *class_key_values[] = { req->dev, net_namespace, parent_str, classid_str };
+        struct oper_node *new_class = NULL;
+        if (new_list_instance_by_names(*ctx->parent_data_node, ctx->s_node, class_key_names,
+                                       class_key_values, 4, &new_class) != LY_SUCCESS) {
             fprintf(stderr, "%s: Failed to create new list in YANG data tree\n", __func__);
-            free(filter_list_str);
-            json_object_put(tc_cmd_output);
-            tc_cmd_output = NULL;
-            goto cleanup;
-        }
-        free(filter_list_str);
-        filter_list_str = NULL;
-
-        /* Process individual filter rules into tc filter YANG data tree */
-        size_t n_arrays = json_object_array_length(tc_cmd_output);
-        for (size_t j = 0; j < n_arrays; j++) {
-            if (j % 2 == 1) { /* workaround having tc filter rules shown twice
-                                in tc filer command outputs */
-                struct json_object *tc_array_obj = json_object_array_get_idx(tc_cmd_output, j);
-                if (!tc_array_obj) {
-                    fprintf(stderr, "%s: Failed to get JSON array element at index %zu\n", __func__,
-                            j);
-                    continue;
-                }
-                const struct lysc_node *s_child = NULL;
-                LY_LIST_FOR(lysc_node_child(s_node), s_child)
-                {
-                    process_node(s_child, tc_array_obj, lys_flags, &new_filter);
-                }
-            }
+            ret = EXIT_FAILURE;
+            break;
         }
 
-        /* Clean up for this iteration */
-        json_object_put(tc_cmd_output);
-        tc_cmd_output = NULL;
-    }
-
-    ret = EXIT_SUCCESS;
-
-cleanup:
-    /* Free tc_commands array */
-    if (tc_commands) {
-        for (int i = 0; i < CMDS_ARRAY_SIZE; i++) {
-            if (tc_commands[i]) {
-                free(tc_commands[i]);
-                tc_commands[i] = NULL;
-            }
+        /* process the class list children nodes */
+        const struct lysc_node *s_child = NULL;
+        LY_LIST_FOR(lysc_node_child(ctx->s_node), s_child)
+        {
+            process_node(s_child, tc_class_obj, ctx->lys_flags, &new_class);
         }
-        free(tc_commands);
-        tc_commands = NULL;
-    }
-    /* Free any remaining JSON objects */
-    if (qdisc_cmd_output) {
-        json_object_put(qdisc_cmd_output);
-        qdisc_cmd_output = NULL;
-    }
-    if (tc_cmd_output) {
-        json_object_put(tc_cmd_output);
-        tc_cmd_output = NULL;
     }
+    json_object_put(tc_classes);
     return ret;
 }
 
 /**
- * dumps tc classes configured on the system into sysrepo YANG data tree 
+ * dumps the tc filters or classes of the qdiscs configured on the system into sysrepo YANG
+ * data tree, all the dumps are done on one netlink socket and converted as they complete.
+ * @param [in] type: dumped tc objects.
+ * @param [in] tc_filter_type: oper-dump-tc-filters type, for TC_DUMP_FILTERS only.
+ * @param [in] s_node: tc filter or tc class list schema node.
+ * @param [in, out] parent_data_node: list parent data node.
+ * @param [in] lys_flags: flag value used to filter out schema nodes containers and leafs.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
  */
-int dump_tc_classes(const struct lysc_node *s_node, struct lyd_node **parent_data_node,
-                    int lys_flags)
+static int dump_tc_objects_to_list(tc_dump_type_t type, char *tc_filter_type,
+                                   const struct lysc_node *s_node,
+                                   struct oper_node **parent_data_node, int lys_flags)
 {
-    int tc_command_count = 0;
-    char tc_cmd_key_value[CMD_LINE_SIZE];
-    char *tc_cmd_key_name = NULL;
-    struct json_object *qdisc_cmd_output = NULL, *tc_cmd_output = NULL;
-    char **tc_commands = NULL;
+    struct tc_dump_ctx ctx = { s_node, parent_data_node, lys_flags, NULL };
+    struct tc_dump_reqs reqs = { 0 };
+    struct json_object *qdisc_cmd_output = NULL;
     int ret = EXIT_FAILURE;
 
-    /* Apply tc qdisc command */
+    /* the qdisc list is shared with the other tc lists of the load pass */
     char tc_qdisc_cmd[CMD_LINE_SIZE] = "tc qdisc list";
     if (strcmp(net_namespace, "1") != 0) {
         insert_netns(tc_qdisc_cmd, net_namespace);
     }
-    if (apply_ipr2_cmd(tc_qdisc_cmd) != EXIT_SUCCESS) {
-        fprintf(stderr, "%s: command execution failed\n", __func__);
+    qdisc_cmd_output = json_object_get(get_show_cmd_jobj(tc_qdisc_cmd));
+    if (qdisc_cmd_output == NULL) {
+        fprintf(stderr, "%s: failed to get qdisc output\n", __func__);
         goto cleanup;
     }
-
-    /* Allocate memory for tc class commands */
-    tc_commands = calloc(CMDS_ARRAY_SIZE, sizeof(char *));
-    if (tc_commands == NULL) {
-        fprintf(stderr, "%s: Failed to allocate memory for tc_commands array\n", __func__);
+    if (json_object_get_type(qdisc_cmd_output) != json_type_array) {
+        fprintf(stderr, "%s: Unexpected JSON type for qdisc output\n", __func__);
         goto cleanup;
     }
-    for (int i = 0; i < CMDS_ARRAY_SIZE; i++) {
-        tc_commands[i] = calloc(CMD_LINE_SIZE, sizeof(char));
-        if (tc_commands[i] == NULL) {
-            fprintf(stderr, "%s: Failed to allocate memory for command string at index %d\n",
-                    __func__, i);
-            goto cleanup;
-        }
-    }
 
-    /* Parse qdisc command output */
-    qdisc_cmd_output = json_tokener_parse(json_buffer);
-    if (qdisc_cmd_output == NULL) {
-        fprintf(stderr, "%s: JSON parsing failed for qdisc output\n", __func__);
+    /* the requests borrow the device and block names from the qdisc output */
+    if (type == TC_DUMP_FILTERS)
+        ret = qdiscs_to_filters_reqs(qdisc_cmd_output, tc_filter_type, &reqs);
+    else
+        ret = qdiscs_to_classes_reqs(qdisc_cmd_output, &reqs);
+    if (ret != EXIT_SUCCESS || reqs.count == 0)
         goto cleanup;
-    }
-    qdiscs_to_classes_cmds(qdisc_cmd_output, tc_commands, &tc_command_count);
-    json_object_put(qdisc_cmd_output);
-    qdisc_cmd_output = NULL;
-
-    /* Process each tc class command */
-    for (int i = 0; i < tc_command_count; i++) {
-        /* Apply tc class command */
-        if (apply_ipr2_cmd(tc_commands[i]) != EXIT_SUCCESS) {
-            fprintf(stderr, "%s: command execution failed for command: %s\n", __func__,
-                    tc_commands[i]);
-            goto cleanup;
-        }
-
-        /* Parse tc class command output */
-        tc_cmd_output = json_tokener_parse(json_buffer);
-        if (tc_cmd_output == NULL) {
-            fprintf(stderr, "%s: JSON parsing failed for command output: %s\n", __func__,
-                    tc_commands[i]);
-            goto cleanup;
-        }
-
-        if (json_object_get_type(tc_cmd_output) != json_type_array ||
-            json_object_array_length(tc_cmd_output) == 0) {
-            json_object_put(tc_cmd_output);
-            tc_cmd_output = NULL;
-            continue; /* No data to process, proceed to next tc class command */
-        }
-
-        /* iterate through every class array */
-        size_t n_arrays = json_object_array_length(tc_cmd_output);
-        for (size_t j = 0; j < n_arrays; j++) {
-            struct json_object *tc_array_obj = json_object_array_get_idx(tc_cmd_output, j);
-
-            /* Extract tc class list keys */
-            struct json_object *classid_obj, *parent_obj;
-            const char *classid_str, *parent_str = NULL;
-            if (strstr(tc_commands[i], "dev")) {
-                if (sscanf(tc_commands[i], "tc class show dev %s", tc_cmd_key_value) != 1) {
-                    fprintf(stderr, "%s: Failed to parse dev from command: %s\n", __func__,
-                            tc_commands[i]);
-                    goto cleanup;
-                }
-                tc_cmd_key_name = "dev";
-            } else {
-                fprintf(stderr, "%s: Unknown command format: %s\n", __func__, tc_commands[i]);
-                goto cleanup;
-            }
-            if (json_object_object_get_ex(tc_array_obj, "handle", &classid_obj)) {
-                classid_str = json_object_get_string(classid_obj);
-            }
-            if (json_object_object_get_ex(tc_array_obj, "parent", &parent_obj)) {
-                parent_str = json_object_get_string(parent_obj);
-            } else if (json_object_object_get_ex(tc_array_obj, "root", &parent_obj)) {
-                parent_str = "root";
-            }
-
-            /* create tc class YANG list data tree */
-            json_object *class_list_jobj = json_object_new_object();
-            json_object_object_add(class_list_jobj, tc_cmd_key_name,
-                                   json_object_new_string(tc_cmd_key_value));
-            json_object_object_add(class_list_jobj, "netns", json_object_new_string(net_namespace));
-            json_object_object_add(class_list_jobj, "parent", json_object_new_string(parent_str));
-            json_object_object_add(class_list_jobj, "classid", json_object_new_string(classid_str));
-
-            char *class_list_str = NULL;
-            jobj_to_list2_keys(class_list_jobj, &class_list_str);
-            json_object_put(class_list_jobj);
-            class_list_jobj = NULL;
-
-            struct lyd_node *new_class = NULL;
-            if (lyd_new_list2(*parent_data_node, NULL, s_node->name, class_list_str, 0,
-                              &new_class) != LY_SUCCESS) {
-                fprintf(stderr, "%s: Failed to create new list in YANG data tree\n", __func__);
-                free(class_list_str);
-                goto cleanup;
-            }
-            free(class_list_str);
-
-            /* process the class list children nodes */
-            const struct lysc_node *s_child = NULL;
-            LY_LIST_FOR(lysc_node_child(s_node), s_child)
-            {
-                process_node(s_child, tc_array_obj, lys_flags, &new_class);
-            }
-        }
-        json_object_put(tc_cmd_output);
-        tc_cmd_output = NULL;
-    }
 
-    ret = EXIT_SUCCESS;
+    /* only materialize the keys read by the list */
+    ctx.wanted_keys = json_object_new_object();
+    get_schema_json_keys(s_node, ctx.wanted_keys);
+    ret = dump_tc_objects(net_namespace, reqs.reqs, reqs.count,
+                          type == TC_DUMP_FILTERS ? tc_filters_to_list : tc_classes_to_list, &ctx);
 
 cleanup:
-    /* Free tc_commands array */
-    if (tc_commands) {
-        for (int i = 0; i < CMDS_ARRAY_SIZE; i++) {
-            if (tc_commands[i]) {
-                free(tc_commands[i]);
-                tc_commands[i] = NULL;
-            }
-        }
-        free(tc_commands);
-        tc_commands = NULL;
-    }
+    json_object_put(ctx.wanted_keys);
+    json_object_put(qdisc_cmd_output);
+    free(reqs.reqs);
+    return ret;
+}
 
-    /* Free any remaining JSON objects */
-    if (qdisc_cmd_output) {
-        json_object_put(qdisc_cmd_output);
-        qdisc_cmd_output = NULL;
-    }
-    if (tc_cmd_output) {
-        json_object_put(tc_cmd_output);
-        tc_cmd_output = NULL;
-    }
+/**
+ * dumps tc filters configured on the system into sysrepo YANG data tree 
+ */
+int dump_tc_filters(char *tc_filter_type, const struct lysc_node *s_node,
+                    struct oper_node **parent_data_node, int lys_flags)
+{
+    return dump_tc_objects_to_list(TC_DUMP_FILTERS, tc_filter_type, s_node, parent_data_node,
+                                   lys_flags);
+}
 
-    return ret;
+/**
+ * dumps tc classes configured on the system into sysrepo YANG data tree 
+ */
+int dump_tc_classes(const struct lysc_node *s_node, struct oper_node **parent_data_node,
+                    int lys_flags)
+{
+    return dump_tc_objects_to_list(TC_DUMP_CLASSES, NULL, s_node, parent_data_node, lys_flags);
 }
 
 /**
@@ -1573,10 +2053,10 @@ cleanup:
  * @param [in, out] parent_data_node: Pointer to the parent data node in the YANG data tree (lyd_node).
  */
 int process_node(const struct lysc_node *s_node, json_object *json_obj, uint16_t lys_flags,
-                 struct lyd_node **parent_data_node)
+                 struct oper_node **parent_data_node)
 {
     const struct lysc_node *s_child;
-    struct lyd_node *new_data_node = *parent_data_node;
+    struct oper_node *new_data_node = *parent_data_node;
 
     /* check for schema extension overrides */
     char *arg_name = NULL;
@@ -1594,9 +2074,6 @@ int process_node(const struct lysc_node *s_node, json_object *json_obj, uint16_t
         }
 
         struct json_object *term_jobj = term_vals ? json_tokener_parse(term_vals) : NULL;
-        if (term_vals) {
-            free(term_vals);
-        }
 
         if (term_jobj == NULL) {
             fprintf(stderr,
@@ -1606,10 +2083,31 @@ int process_node(const struct lysc_node *s_node, json_object *json_obj, uint16_t
             return EXIT_FAILURE;
         }
 
-        if (terminate_processing(json_obj, term_jobj)) {
+        if (terminate_processing(s_node, json_obj, term_jobj)) {
+            json_object_put(term_jobj);
             s_node = s_node->next;
             return EXIT_SUCCESS;
         }
+        json_object_put(term_jobj);
+    }
+
+    /* lists sharing one dump only process the rows matching their values, e.g. a link kind */
+    if (get_lys_extension(OPER_MATCH_IF_EXT, s_node, &term_vals) == EXIT_SUCCESS) {
+        struct json_object *match_jobj = term_vals ? json_tokener_parse(term_vals) : NULL;
+
+        if (match_jobj == NULL) {
+            fprintf(stderr,
+                    "%s: Error reading schema node \"%s\" ipr2cgen:oper-match-if extension,"
+                    " the extension value has a bad json format\n",
+                    __func__, s_node->name);
+            return EXIT_FAILURE;
+        }
+
+        /* same matching as oper-stop-if, with the opposite outcome */
+        bool matched = terminate_processing(s_node, json_obj, match_jobj);
+        json_object_put(match_jobj);
+        if (!matched)
+            return EXIT_SUCCESS;
     }
 
     if (get_lys_extension(OPER_ARG_NAME_EXT, s_node, &arg_name) == EXIT_SUCCESS) {
@@ -1621,7 +2119,7 @@ int process_node(const struct lysc_node *s_node, json_object *json_obj, uint16_t
             return EXIT_FAILURE;
         }
     } else {
-        arg_name = strdup(s_node->name);
+        arg_name = arena_strdup(&oper_arena, s_node->name);
     }
 
     if (get_lys_extension(OPER_SUB_JOBJ_EXT, s_node, &sub_jobj_name) == EXIT_SUCCESS) {
@@ -1634,8 +2132,7 @@ int process_node(const struct lysc_node *s_node, json_object *json_obj, uint16_t
         }
     }
     if (sub_jobj_name != NULL) {
-        find_json_value_by_key(json_obj, sub_jobj_name, &node_jobj);
-        free(sub_jobj_name);
+        lookup_json_value_by_key(s_node, json_obj, sub_jobj_name, &node_jobj);
     } else {
         node_jobj = json_obj;
     }
@@ -1677,46 +2174,272 @@ int process_node(const struct lysc_node *s_node, json_object *json_obj, uint16_t
     default:
         break;
     }
-    free(arg_name);
     return EXIT_SUCCESS;
 }
 
-int merge_json_by_key(struct json_object *dest_jobj, struct json_object *src_array, char *key,
-                      char *include_key)
+/**
+ * Inner command index, built once per load pass for each oper-inner-cmd.
+ * The index is a json object mapping the inner command key values (e.g. ifname) to the
+ * include_key sub-object of the matching inner command row.
+ */
+struct inner_cmd_index {
+    char *show_cmd;
+    char *key;
+    char *include_key;
+    struct json_object *index;
+    struct inner_cmd_index *next;
+};
+
+/**
+ * Adds the json keys listed by a schema node extension to a set of json keys.
+ * @param [in] ex_t: extension type, its value is a json object whose keys are added, or for
+ * oper-combine-values, a json object whose "values" array items are added.
+ * @param [in] s_node: schema node.
+ * @param [in,out] wanted_keys: json object used as a set of json keys.
+ */
+void add_ext_json_keys(oper_extension_t ex_t, const struct lysc_node *s_node,
+                       struct json_object *wanted_keys)
+{
+    char *ext_value = NULL;
+    struct json_object *ext_jobj, *values_array;
+
+    if (get_lys_extension(ex_t, s_node, &ext_value) != EXIT_SUCCESS || ext_value == NULL)
+        return;
+    ext_jobj = json_tokener_parse(ext_value);
+    if (ext_jobj == NULL)
+        return;
+
+    if (ex_t == OPER_COMBINE_VALUES_EXT) {
+        if (json_object_object_get_ex(ext_jobj, "values", &values_array)) {
+            for (size_t i = 0; i < json_object_array_length(values_array); i++) {
+                const char *value_key =
+                    json_object_get_string(json_object_array_get_idx(values_array, i));
+                if (value_key)
+                    json_object_object_add(wanted_keys, value_key, NULL);
+            }
+        }
+    } else {
+        json_object_object_foreach(ext_jobj, key, val)
+        {
+            if (!json_object_is_type(val, json_type_object)) {
+                json_object_object_add(wanted_keys, key, NULL);
+                continue;
+            }
+            /* per family oper-stop-if, its keys are read from the rows */
+            json_object_object_foreach(val, family_key, family_val)
+            {
+                (void)family_val;
+                json_object_object_add(wanted_keys, family_key, NULL);
+            }
+        }
+    }
+    json_object_put(ext_jobj);
+}
+
+/**
+ * Collects the command output json keys read by the converter for a schema subtree, that is the
+ * node names and the keys named by the oper-arg-name, oper-sub-jobj, oper-stop-if, oper-match-if,
+ * oper-combine-values and oper-inner-cmd extensions.
+ * @param [in] s_node: schema node.
+ * @param [in,out] wanted_keys: json object used as a set of json keys.
+ */
+void get_schema_json_keys(const struct lysc_node *s_node, struct json_object *wanted_keys)
+{
+    const struct lysc_node *s_child;
+    char *ext_value = NULL;
+
+    json_object_object_add(wanted_keys, s_node->name, NULL);
+    if (get_lys_extension(OPER_ARG_NAME_EXT, s_node, &ext_value) == EXIT_SUCCESS && ext_value) {
+        json_object_object_add(wanted_keys, ext_value, NULL);
+    }
+    ext_value = NULL;
+    if (get_lys_extension(OPER_SUB_JOBJ_EXT, s_node, &ext_value) == EXIT_SUCCESS && ext_value) {
+        json_object_object_add(wanted_keys, ext_value, NULL);
+    }
+    ext_value = NULL;
+    if (get_lys_extension(OPER_INNER_CMD_EXT, s_node, &ext_value) == EXIT_SUCCESS && ext_value) {
+        /* "show command,key,include key", add the two keys */
+        char *saveptr = NULL;
+        char *token = strtok_r(ext_value, ",", &saveptr);
+        while (token && (token = strtok_r(NULL, ",", &saveptr)))
+            json_object_object_add(wanted_keys, token, NULL);
+    }
+    add_ext_json_keys(OPER_STOP_IF_EXT, s_node, wanted_keys);
+    add_ext_json_keys(OPER_MATCH_IF_EXT, s_node, wanted_keys);
+    add_ext_json_keys(OPER_COMBINE_VALUES_EXT, s_node, wanted_keys);
+
+    LY_LIST_FOR(lysc_node_child(s_node), s_child)
+    {
+        get_schema_json_keys(s_child, wanted_keys);
+    }
+}
+
+/* inner command indexes of the current load pass, released by free_inner_cmd_indexes() */
+static struct inner_cmd_index *inner_cmd_indexes;
+
+void free_inner_cmd_indexes(void)
+{
+    struct inner_cmd_index *entry = inner_cmd_indexes, *next;
+    while (entry) {
+        next = entry->next;
+        json_object_put(entry->index);
+        free(entry->show_cmd);
+        free(entry->key);
+        free(entry->include_key);
+        free(entry);
+        entry = next;
+    }
+    inner_cmd_indexes = NULL;
+}
+
+/**
+ * Gets the index of an inner show command output, the inner command is executed and indexed
+ * only the first time it is requested in the load pass.
+ * @param [in] show_cmd: inner show command.
+ * @param [in] key: key name used to match the outer and inner command json rows.
+ * @param [in] include_key: inner command row key to be included in the outer command row.
+ * @return json object indexed by key values, NULL on failure.
+ */
+struct json_object *get_inner_cmd_index(const char *show_cmd, const char *key,
+                                        const char *include_key)
+{
+    struct inner_cmd_index *entry;
+    for (entry = inner_cmd_indexes; entry; entry = entry->next) {
+        if (!strcmp(entry->show_cmd, show_cmd) && !strcmp(entry->key, key) &&
+            !strcmp(entry->include_key, include_key))
+            return entry->index;
+    }
+
+    const char *cmd_text = get_show_cmd_text(show_cmd, NULL, false);
+    if (cmd_text == NULL)
+        return NULL;
+    /* only the join key and the included value are materialized */
+    struct json_object *wanted_keys = json_object_new_object();
+    json_object_object_add(wanted_keys, key, NULL);
+    json_object_object_add(wanted_keys, include_key, NULL);
+    struct json_object *cmd_output = json_scan_parse(cmd_text, wanted_keys);
+    json_object_put(wanted_keys);
+    if (cmd_output == NULL)
+        cmd_output = json_tokener_parse(cmd_text);
+    if (cmd_output == NULL)
+        fprintf(stderr, "%s: JSON parsing failed for command output: %s\n", __func__, show_cmd);
+
+    /* an unparsable output is indexed as empty, so the outer rows are still processed */
+    struct json_object *index = json_object_new_object();
+    if (json_object_get_type(cmd_output) == json_type_array) {
+        size_t n_arrays = json_object_array_length(cmd_output);
+        for (size_t i = 0; i < n_arrays; i++) {
+            struct json_object *inner_obj = json_object_array_get_idx(cmd_output, i);
+            struct json_object *key_obj, *include_obj;
+            if (!json_object_object_get_ex(inner_obj, key, &key_obj) ||
+                !json_object_object_get_ex(inner_obj, include_key, &include_obj))
+                continue;
+            const char *key_value = json_object_get_string(key_obj);
+            /* keep the first matching row, as the linear search used to do */
+            if (key_value == NULL || json_object_object_get_ex(index, key_value, NULL))
+                continue;
+            /* the index holds its own reference, so the include_obj outlives cmd_output */
+            json_object_object_add(index, key_value, json_object_get(include_obj));
+        }
+    }
+    json_object_put(cmd_output);
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL) {
+        fprintf(stderr, "%s: Memory allocation failed\n", __func__);
+        json_object_put(index);
+        return NULL;
+    }
+    entry->show_cmd = strdup(show_cmd);
+    entry->key = strdup(key);
+    entry->include_key = strdup(include_key);
+    entry->index = index;
+    entry->next = inner_cmd_indexes;
+    inner_cmd_indexes = entry;
+    return index;
+}
+
+/**
+ * Attaches the inner command sub-object matching dest_jobj key value to dest_jobj.
+ * The sub-object is attached by reference, it is shared with the inner command index.
+ * @param [in,out] dest_jobj: outer command json row.
+ * @param [in] inner_index: inner command index returned by get_inner_cmd_index().
+ * @param [in] key: key name used to match the outer and inner command json rows.
+ * @param [in] include_key: key name under which the sub-object is added to dest_jobj.
+ * @return 0 on success, -1 if no matching inner row is found.
+ */
+int merge_json_by_key(struct json_object *dest_jobj, struct json_object *inner_index,
+                      const char *key, const char *include_key)
 {
+    struct json_object *include_obj = NULL;
     // Get the key value from the outer JSON object
     const char *outter_jkey = json_object_get_string(json_object_object_get(dest_jobj, key));
     if (!outter_jkey) {
         return -1; // Handle the case where the key is not found
     }
 
-    // Iterate through the inner array
-    size_t inner_array_length = json_object_array_length(src_array);
-    for (size_t i = 0; i < inner_array_length; i++) {
-        struct json_object *inner_obj = json_object_array_get_idx(src_array, i);
-        const char *inner_jkey = json_object_get_string(json_object_object_get(inner_obj, key));
+    if (!json_object_object_get_ex(inner_index, outter_jkey, &include_obj))
+        return -1;
 
-        // If keys match, merge the objects
-        if (strcmp(outter_jkey, inner_jkey) == 0) {
-            struct json_object *include_obj = json_object_object_get(inner_obj, include_key);
-            if (!include_obj) {
-                return -1; // Handle the case where the include_key is not found
-            }
+    json_object_object_add(dest_jobj, include_key, json_object_get(include_obj));
+    return 0;
+}
 
-            // Deep copy the include_obj
-            struct json_object *include_obj_copy = NULL;
-            json_object_deep_copy(include_obj, &include_obj_copy, NULL);
-            if (!include_obj_copy) {
-                return -1; // Handle deep copy failure
-            }
+/**
+ * Selects the rows a list reads from its show command output, lists with an oper-family
+ * extension only read the rows of their families from the grouped output.
+ * @param [in] s_node: list schema node holding the oper-cmd extension.
+ * @param [in] cmd_output: show command output, the reference is taken over.
+ * @return new reference to the list rows, NULL on memory allocation failure.
+ */
+static struct json_object *select_list_rows(const struct lysc_node *s_node,
+                                            struct json_object *cmd_output)
+{
+    char *families = NULL, *stop_if = NULL;
+    struct json_object *rows, *stop_if_jobj = NULL;
+
+    if (get_lys_extension(OPER_FAMILY_EXT, s_node, &families) != EXIT_SUCCESS || !families)
+        return cmd_output;
+    if (get_lys_extension(OPER_STOP_IF_EXT, s_node, &stop_if) == EXIT_SUCCESS && stop_if)
+        stop_if_jobj = json_tokener_parse(stop_if);
+    rows = select_family_rows(s_node, cmd_output, families, stop_if_jobj);
+    json_object_put(stop_if_jobj);
+    json_object_put(cmd_output);
+    return rows;
+}
 
-            // Add the copied object to the outer JSON object
-            json_object_object_add(dest_jobj, include_key, include_obj_copy);
-            break;
-        }
-    }
+/**
+ * Gets the parsed output of a list oper-cmd show command, the output is shared by the lists using
+ * the same command in the load pass, and each list only parses the json keys it reads.
+ * @param [in] s_node: list schema node holding the oper-cmd extension.
+ * @param [in] show_cmd: show command, with the namespace option already inserted.
+ * @param [out] cmd_output: parsed output, a new reference, NULL if it can't be parsed.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the command execution failed.
+ */
+static int get_list_cmd_output(const struct lysc_node *s_node, const char *show_cmd,
+                               struct json_object **cmd_output)
+{
+    char *families = NULL;
+    get_lys_extension(OPER_FAMILY_EXT, s_node, &families);
+    const char *cmd_text = get_show_cmd_text(show_cmd, s_node, families != NULL);
+    if (cmd_text == NULL)
+        return EXIT_FAILURE;
 
-    return 0;
+    /* only materialize the output keys read by the s_node subtree */
+    struct json_object *wanted_keys = json_object_new_object();
+    get_schema_json_keys(s_node, wanted_keys);
+    /* the group rows are reached through their wanted keys, "rows" itself is not wanted or each
+     * row would be fully parsed */
+    if (families)
+        json_object_object_add(wanted_keys, "family", NULL);
+    *cmd_output = json_scan_parse(cmd_text, wanted_keys);
+    json_object_put(wanted_keys);
+    if (*cmd_output == NULL)
+        *cmd_output = json_tokener_parse(cmd_text);
+    *cmd_output = select_list_rows(s_node, *cmd_output);
+    if (*cmd_output == NULL)
+        return EXIT_FAILURE;
+    return EXIT_SUCCESS;
 }
 
 /**
@@ -1732,7 +2455,7 @@ int merge_json_by_key(struct json_object *dest_jobj, struct json_object *src_arr
  * @param [in, out] parent_data_node: Pointer to the parent data node in the YANG data tree (lyd_node).
  */
 int process_schema(const struct lysc_node *s_node, uint16_t lys_flags,
-                   struct lyd_node **parent_data_node)
+                   struct oper_node **parent_data_node)
 {
     // before processing the schema, check if it's flags match the requested "lys_flags"
     if (s_node->flags & LYS_CONFIG_R) {
@@ -1741,12 +2464,11 @@ int process_schema(const struct lysc_node *s_node, uint16_t lys_flags,
     }
     char *show_cmd = NULL;
     char *tc_filter_type = NULL;
-    char *json_buffer_cpy = NULL;
     struct json_object *cmd_output = NULL;
 
     /* Create top-level lyd_node */
     if (*parent_data_node == NULL) { // Top-level node
-        lyd_new_inner(NULL, s_node->module, s_node->name, 0, parent_data_node);
+        oper_new_inner(NULL, s_node, parent_data_node);
     }
 
     if (get_lys_extension(OPER_CMD_EXT, s_node, &show_cmd) == EXIT_SUCCESS) {
@@ -1757,53 +2479,48 @@ int process_schema(const struct lysc_node *s_node, uint16_t lys_flags,
                     __func__, s_node->name);
             return EXIT_FAILURE;
         }
-        if (strcmp(net_namespace, "1") != 0) {
+        /* modules using a native decoder for the command read its rows directly */
+        struct json_object *netlink_rows = get_netlink_rows(s_node, show_cmd);
+        if (netlink_rows == NULL && strcmp(net_namespace, "1") != 0) {
             // Calculate the new size needed for show_cmd
             size_t new_size = strlen(show_cmd) + strlen(" -n ") + strlen(net_namespace) +
                               1; // +1 for the null terminator
-
-            // Reallocate memory for show_cmd
-            show_cmd = realloc(show_cmd, new_size);
-            if (show_cmd == NULL) {
-                perror("realloc");
+            char *ns_show_cmd = arena_alloc(&oper_arena, new_size);
+            if (ns_show_cmd == NULL) {
+                perror("arena_alloc");
                 exit(EXIT_FAILURE);
             }
+            strcpy(ns_show_cmd, show_cmd);
+            show_cmd = ns_show_cmd;
             insert_netns(show_cmd, net_namespace);
         }
-        if (apply_ipr2_cmd(show_cmd) != EXIT_SUCCESS) {
-            fprintf(stderr, "%s: command execution failed\n", __func__);
-
+        if (netlink_rows) {
+            cmd_output = select_list_rows(s_node, json_object_get(netlink_rows));
+            if (cmd_output == NULL)
+                return EXIT_FAILURE;
+        } else if (get_list_cmd_output(s_node, show_cmd, &cmd_output) != EXIT_SUCCESS) {
             return EXIT_FAILURE;
         }
-        free(show_cmd);
 
-        json_buffer_cpy = strdup(json_buffer);
-        cmd_output = json_tokener_parse(json_buffer_cpy);
-
-        struct json_object *inner_cmd_output = NULL;
-        char *inner_cmd_arg, *json_buffer_inner_cpy = NULL;
+        struct json_object *inner_cmd_index = NULL;
+        char *inner_cmd_arg = NULL;
         char *inner_show_cmd = NULL, *inner_cmd_key = NULL, *inner_cmd_inculde_key = NULL;
         if (get_lys_extension(OPER_INNER_CMD_EXT, s_node, &inner_cmd_arg) == EXIT_SUCCESS) {
-            char *temp = NULL;
             char *token = NULL;
-            // Create a copy of the input string to avoid modifying the original string
-            temp = strdup(inner_cmd_arg);
-
-            // Tokenize the string using comma as the delimiter
-            token = strtok(temp, ",");
+            // Tokenize the string using comma as the delimiter, the extension value is a copy
+            // owned by the load pass arena.
+            token = strtok(inner_cmd_arg, ",");
             if (token) {
-                inner_show_cmd = strdup(token);
+                inner_show_cmd = token;
                 token = strtok(NULL, ",");
             }
             if (token) {
-                inner_cmd_key = strdup(token);
+                inner_cmd_key = token;
                 token = strtok(NULL, ",");
             }
             if (token) {
-                inner_cmd_inculde_key = strdup(token);
+                inner_cmd_inculde_key = token;
             }
-            // Free the duplicated string
-            free(temp);
             // Check if all tokens were found
             if (!inner_show_cmd || !inner_cmd_key || !inner_cmd_inculde_key) {
                 fprintf(stderr, "%s: failed to get inner_show_cmd ext argument for node = %s\n",
@@ -1814,19 +2531,23 @@ int process_schema(const struct lysc_node *s_node, uint16_t lys_flags,
                 // Calculate the new size needed for show_cmd
                 size_t new_size = strlen(inner_show_cmd) + strlen(" -n ") + strlen(net_namespace) +
                                   1; // +1 for the null terminator
-
-                // Reallocate memory for show_cmd
-                inner_show_cmd = realloc(inner_show_cmd, new_size);
+                char *ns_show_cmd = arena_alloc(&oper_arena, new_size);
+                if (ns_show_cmd == NULL) {
+                    json_object_put(cmd_output);
+                    return EXIT_FAILURE;
+                }
+                strcpy(ns_show_cmd, inner_show_cmd);
+                inner_show_cmd = ns_show_cmd;
                 insert_netns(inner_show_cmd, net_namespace);
             }
 
-            if (apply_ipr2_cmd(inner_show_cmd) != EXIT_SUCCESS) {
-                fprintf(stderr, "%s: command execution failed\n", __func__);
+            // the inner command is executed and indexed once per load pass.
+            inner_cmd_index =
+                get_inner_cmd_index(inner_show_cmd, inner_cmd_key, inner_cmd_inculde_key);
+            if (inner_cmd_index == NULL) {
+                json_object_put(cmd_output);
                 return EXIT_FAILURE;
             }
-            free(inner_show_cmd);
-            json_buffer_inner_cpy = strdup(json_buffer);
-            inner_cmd_output = json_tokener_parse(json_buffer_inner_cpy);
         }
 
         if (json_object_get_type(cmd_output) == json_type_array) {
@@ -1835,22 +2556,16 @@ int process_schema(const struct lysc_node *s_node, uint16_t lys_flags,
             for (size_t i = 0; i < n_arrays; i++) {
                 struct json_object *array_obj = json_object_array_get_idx(cmd_output, i);
 
-                if (inner_cmd_output) {
-                    merge_json_by_key(array_obj, inner_cmd_output, inner_cmd_key,
+                if (inner_cmd_index) {
+                    merge_json_by_key(array_obj, inner_cmd_index, inner_cmd_key,
                                       inner_cmd_inculde_key);
                 }
                 process_node(s_node, array_obj, lys_flags, parent_data_node);
             }
         }
-        if (inner_cmd_output)
-            json_object_put(inner_cmd_output);
-        if (json_buffer_inner_cpy)
-            free(json_buffer_inner_cpy);
 
     } else if (get_lys_extension(OPER_DUMP_TC_FILTERS, s_node, &tc_filter_type) == EXIT_SUCCESS) {
-        int result = dump_tc_filters(tc_filter_type, s_node, parent_data_node, lys_flags);
-        free(tc_filter_type);
-        return result;
+        return dump_tc_filters(tc_filter_type, s_node, parent_data_node, lys_flags);
     } else if (get_lys_extension(OPER_DUMP_TC_CLASSES, s_node, NULL) == EXIT_SUCCESS) {
         return dump_tc_classes(s_node, parent_data_node, lys_flags);
     } else {
@@ -1862,24 +2577,61 @@ int process_schema(const struct lysc_node *s_node, uint16_t lys_flags,
     }
     if (cmd_output)
         json_object_put(cmd_output);
-    if (json_buffer_cpy)
-        free(json_buffer_cpy);
 
     return EXIT_SUCCESS;
 }
 
+/**
+ * Converts a top-level schema node with the json backend, the converted nodes are added to a
+ * YANG JSON document, which is printed and parsed into a data tree at once.
+ * @param [in] s_node: top-level schema node.
+ * @param [in] lys_flags: Flag value used to filter out schema nodes containers and leafs.
+ * @param [out] data_tree: parsed data tree, NULL if there is no data for s_node.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the document couldn't be built or parsed.
+ */
+int process_schema_json(const struct lysc_node *s_node, uint16_t lys_flags,
+                        struct lyd_node **data_tree)
+{
+    struct oper_node *doc_root = NULL;
+    char *doc_text = NULL;
+
+    *data_tree = NULL;
+    oper_doc = oper_json_doc_new();
+    if (oper_doc == NULL) {
+        fprintf(stderr, "%s: failed to create YANG JSON document\n", __func__);
+        return EXIT_FAILURE;
+    }
+    process_schema(s_node, lys_flags, &doc_root);
+    doc_text = oper_json_print(oper_doc);
+    oper_json_doc_free(oper_doc);
+    oper_doc = NULL;
+    if (doc_text == NULL)
+        return EXIT_FAILURE;
+
+    /* values are checked by the parser, a rejected document is converted node by node */
+    if (lyd_parse_data_mem(s_node->module->ctx, doc_text, LYD_JSON,
+                           LYD_PARSE_ONLY | LYD_PARSE_STRICT, 0, data_tree) != LY_SUCCESS) {
+        fprintf(stderr, "%s: failed to parse '%s' YANG JSON document\n", __func__, s_node->name);
+        free(doc_text);
+        *data_tree = NULL;
+        return EXIT_FAILURE;
+    }
+    free(doc_text);
+    return EXIT_SUCCESS;
+}
+
 /**
  * Sets operational data items or running data items for a module in a Sysrepo session
  * based on global json_buffer content.
  * This function parses the json_buffer data outputs comming from iproute2 show commands
- * then converts it to a YANG data tree, and merges the created data tree into a parent
- * data tree.
+ * then converts it to a YANG data tree, built in place under the parent top nodes or linked
+ * as a new parent sibling.
  * @param [in] session: Sysrepo session context.
  * @param [in] module_name: Name of the module for which the data is to be set.
  * @param [in] lys_flags: Flag value used to filter out schema nodes containers and leafs.
  *                        Use LYS_CONFIG_R to allow parsing read-only containers and leafs (for loading operational data).
  *                        Use LYS_CONFIG_W to allow parsing write containers and leafs (for loading configuration data).
- * @param [in, out] parent: Pointer to the parent node for merging the data tree.
+ * @param [in, out] parent: Pointer to the parent node the data trees are added to.
  * @return Returns an integer status code (SR_ERR_OK on success or an error code on failure).
  */
 int load_module_data(sr_session_ctx_t *session, const char *module_name, uint16_t lys_flags,
@@ -1889,7 +2641,11 @@ int load_module_data(sr_session_ctx_t *session, const char *module_name, uint16_
     const struct ly_ctx *ly_ctx;
     const struct lys_module *module = NULL;
     struct lyd_node *data_tree = NULL;
+
+    pthread_mutex_lock(&load_pass_lock);
     net_namespace = nsname;
+    load_lys_flags = lys_flags;
+    load_module_name = module_name;
 
     ly_ctx = sr_acquire_context(sr_session_get_connection(session));
     module = ly_ctx_get_module_implemented(ly_ctx, module_name);
@@ -1903,21 +2659,51 @@ int load_module_data(sr_session_ctx_t *session, const char *module_name, uint16_
     const struct lysc_node *node;
     LY_LIST_FOR(module->compiled->data, node)
     {
-        // Start with level 0 for top-level nodes, data_tree = NULL
-        //process_node(node, json_array_obj, lys_flags, data_tree);
-        process_schema(node, lys_flags, &data_tree);
-        if (lyd_merge_tree(parent, data_tree, LYD_MERGE_DEFAULTS)) {
-            /* Merge of one json_array data_tree failed.
-               This is a partial failure, no need to return ERR. */
+        /* data of another netns may already be loaded under this top node, build into it */
+        struct lyd_node *top_node = NULL;
+        if (*parent)
+            lyd_find_sibling_val(*parent, node, NULL, 0, &top_node);
+
+        if (oper_backend == OPER_DATA_BACKEND_JSON &&
+            process_schema_json(node, lys_flags, &data_tree) == EXIT_SUCCESS) {
+            if (data_tree && top_node) {
+                /* move the parsed children under the existing top node, no copy is made */
+                struct lyd_node *child;
+                while ((child = lyd_child(data_tree)) != NULL) {
+                    if (lyd_insert_child(top_node, child) != LY_SUCCESS) {
+                        fprintf(stderr, "%s: Partial failure on pushing '%s' operational data\n",
+                                __func__, node->name);
+                        break;
+                    }
+                }
+                lyd_free_tree(data_tree);
+                data_tree = NULL;
+            }
+        } else if (top_node) {
+            process_schema(node, lys_flags, (struct oper_node **)&top_node);
+        } else {
+            // Start with level 0 for top-level nodes, data_tree = NULL
+            process_schema(node, lys_flags, (struct oper_node **)&data_tree);
+        }
+        if (data_tree == NULL)
+            continue;
+        /* link the new top node as a sibling of parent, instead of merging a copy of it */
+        if (lyd_insert_sibling(*parent, data_tree, parent) != LY_SUCCESS) {
+            /* This is a partial failure, no need to return ERR. */
             fprintf(stderr, "%s: Partial failure on pushing '%s' operational data\n", __func__,
                     data_tree->schema->name);
+            lyd_free_tree(data_tree);
         }
-        // Free data_tree after merging it.
-        lyd_free_tree(data_tree);
         data_tree = NULL;
     }
 
 cleanup:
+    free_inner_cmd_indexes();
+    free_json_key_paths();
+    free_show_cmd_outputs();
+    free_netlink_rows();
+    arena_release(&oper_arena);
     sr_release_context(sr_session_get_connection(session));
+    pthread_mutex_unlock(&load_pass_lock);
     return ret;
 }
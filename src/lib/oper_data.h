@@ -2,22 +2,110 @@
 #ifndef IPROUTE2_SYSREPO_OPER_DATA_H
 #define IPROUTE2_SYSREPO_OPER_DATA_H
 
+#include <stdbool.h>
 #include <sysrepo.h>
 
 extern char json_buffer[1024 * 1024]; /* holds iproute2 show commands json outputs */
 
+/**
+ * @brief oper data converter backends.
+ */
+typedef enum {
+    OPER_DATA_BACKEND_LYD, /* data tree nodes are created one by one */
+    OPER_DATA_BACKEND_JSON, /* a YANG JSON document is emitted and parsed once per top node */
+} oper_data_backend_t;
+
+/**
+ * @brief sources of the show commands outputs.
+ */
+typedef enum {
+    OPER_DATA_SOURCE_IPR2, /* iproute2 show commands json outputs */
+    OPER_DATA_SOURCE_NETLINK, /* native netlink decoders, for the show commands having one */
+} oper_data_source_t;
+
+#define DUMP_FILTER_MAX_VALUES 32
+
+/**
+ * @brief netlink message attributes a show command dump can be filtered on.
+ */
+typedef enum {
+    DUMP_FILTER_TABLE, /* route table name or id */
+    DUMP_FILTER_PROTOCOL, /* route protocol name or id */
+    DUMP_FILTER_TYPE, /* route type name */
+    DUMP_FILTER_KIND, /* link kind */
+} dump_filter_attr_t;
+
+/**
+ * @brief attribute value whose messages are dropped from a show command dump.
+ */
+struct dump_filter_value {
+    dump_filter_attr_t attr;
+    const char *value;
+};
+
+/**
+ * @brief show command dump filter, see apply_ipr2_cmd_filtered().
+ */
+struct dump_filter {
+    struct dump_filter_value excluded[DUMP_FILTER_MAX_VALUES];
+    int n_excluded;
+    bool group_by_family; /* output {"family": name, "rows": [...]} groups instead of rows */
+    bool owned_only; /* drop the objects outside the config ownership scope */
+};
+
+/**
+ * @brief tc objects dumped by a tc dump request.
+ */
+typedef enum {
+    TC_DUMP_FILTERS,
+    TC_DUMP_CLASSES,
+} tc_dump_type_t;
+
+/**
+ * @brief tc filters or classes dump request of one device or shared block.
+ */
+struct tc_dump_req {
+    tc_dump_type_t type;
+    const char *dev; /* device name, NULL to dump a shared block */
+    const char *block; /* shared block index, used if dev is NULL */
+    const char *direction; /* "ingress" or "egress" clsact parent, NULL for all parents */
+};
+
+/**
+ * tc dump callback, called once a tc dump request completed.
+ * @param [in] req completed request, its objects json array is in json_buffer.
+ * @param [in] arg callback argument.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE on failure.
+ */
+typedef int (*tc_dump_cb_t)(const struct tc_dump_req *req, void *arg);
+
+/**
+ * select the backend used by load_module_data() to build data trees.
+ * @param [in] backend converter backend, OPER_DATA_BACKEND_LYD by default.
+ */
+void set_oper_data_backend(oper_data_backend_t backend);
+
+/**
+ * select the source of a module show commands outputs, used for its operational data, running
+ * config loads and monitor resyncs.
+ * @param [in] module_name module name.
+ * @param [in] source show commands outputs source, OPER_DATA_SOURCE_IPR2 by default.
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE if the module has no netlink decoder.
+ */
+int set_oper_data_source(const char *module_name, oper_data_source_t source);
+
 /**
  * Sets operational data items or running data items for a module in a Sysrepo session
  * based on global json_buffer content.
  * This function parses the json_buffer data outputs comming from iproute2 show commands
- * then converts it to a YANG data tree, and merges the created data tree into a parent
- * data tree.
+ * then converts it to a YANG data tree, built in place under the parent top nodes or linked
+ * as a new parent sibling.
  * @param [in] session: Sysrepo session context.
  * @param [in] module_name: Name of the module for which the data is to be set.
  * @param [in] lys_flags: Flag value used to filter out schema nodes containers and leafs.
  *                        Use LYS_CONFIG_R to allow parsing read-only containers and leafs (for loading operational data).
  *                        Use LYS_CONFIG_W to allow parsing write containers and leafs (for loading configuration data).
- * @param [in, out] parent: Pointer to the parent node for merging the data tree.
+ * @param [in, out] parent: Pointer to the parent node the data trees are added to.
  * @return Returns an integer status code (SR_ERR_OK on success or an error code on failure).
  */
 int load_module_data(sr_session_ctx_t *session, const char *module_name, uint16_t lys_flags,
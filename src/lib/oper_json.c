@@ -0,0 +1,271 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+/*
+ * Authors:     Amjad Daraiseh, adaraiseh@okdanetworks.com>
+ *
+ *              This program is free software; you can redistribute it and/or
+ *              modify it under the terms of the GNU Affero General Public
+ *              License Version 3.0 as published by the Free Software Foundation;
+ *              either version 3.0 of the License, or (at your option) any later
+ *              version.
+ *
+ * Copyright (C) 2024 Okda Networks, <contact@okdanetworks.com>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json-c/printbuf.h"
+#include "arena.h"
+#include "oper_json.h"
+
+struct oper_json_doc {
+    struct arena arena; /* nodes and values, freed with the document */
+    struct oper_json_node *first; /* top-level nodes */
+    struct oper_json_node *last;
+};
+
+struct oper_json_node {
+    const struct lysc_node *schema;
+    const char *value; /* NULL for inner nodes */
+    struct oper_json_node *child;
+    struct oper_json_node *last_child;
+    struct oper_json_node *next;
+    int printed;
+};
+
+typedef enum {
+    JSON_VALUE_STRING,
+    JSON_VALUE_BARE, /* numbers and booleans */
+    JSON_VALUE_EMPTY,
+} json_value_encoding_t;
+
+struct oper_json_doc *oper_json_doc_new(void)
+{
+    return calloc(1, sizeof(struct oper_json_doc));
+}
+
+void oper_json_doc_free(struct oper_json_doc *doc)
+{
+    if (doc == NULL)
+        return;
+    arena_free(&doc->arena);
+    free(doc);
+}
+
+struct oper_json_node *oper_json_add(struct oper_json_doc *doc, struct oper_json_node *parent,
+                                     const struct lysc_node *schema, const char *value)
+{
+    struct oper_json_node *node = arena_calloc(&doc->arena, sizeof(*node));
+    if (node == NULL)
+        return NULL;
+
+    node->schema = schema;
+    if (value) {
+        node->value = arena_strdup(&doc->arena, value);
+        if (node->value == NULL)
+            return NULL;
+    }
+
+    if (parent == NULL) {
+        if (doc->last)
+            doc->last->next = node;
+        else
+            doc->first = node;
+        doc->last = node;
+    } else {
+        if (parent->last_child)
+            parent->last_child->next = node;
+        else
+            parent->child = node;
+        parent->last_child = node;
+    }
+    return node;
+}
+
+struct oper_json_node *oper_json_find_child(struct oper_json_node *parent,
+                                            const struct lysc_node *schema)
+{
+    struct oper_json_node *child;
+
+    for (child = parent->child; child; child = child->next) {
+        if (child->schema == schema)
+            return child;
+    }
+    return NULL;
+}
+
+const struct lysc_node *oper_json_schema(const struct oper_json_node *node)
+{
+    return node->schema;
+}
+
+static int is_json_number(const char *value)
+{
+    if (*value == '-')
+        value++;
+    if (*value == '\0')
+        return 0;
+    for (; *value; value++) {
+        if (*value < '0' || *value > '9')
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * get how a value of a given type is encoded in YANG JSON (RFC 7951 section 6), values that
+ * can't be encoded as their type are printed as strings and rejected by the parser.
+ * @param [in] type YANG type of the value.
+ * @param [in] value value to encode.
+ * @return value encoding.
+ */
+static json_value_encoding_t get_value_encoding(const struct lysc_type *type, const char *value)
+{
+    LY_ARRAY_COUNT_TYPE u;
+
+    switch (type->basetype) {
+    case LY_TYPE_INT8:
+    case LY_TYPE_INT16:
+    case LY_TYPE_INT32:
+    case LY_TYPE_UINT8:
+    case LY_TYPE_UINT16:
+    case LY_TYPE_UINT32:
+        return is_json_number(value) ? JSON_VALUE_BARE : JSON_VALUE_STRING;
+    case LY_TYPE_BOOL:
+        return (!strcmp(value, "true") || !strcmp(value, "false")) ? JSON_VALUE_BARE :
+                                                                      JSON_VALUE_STRING;
+    case LY_TYPE_EMPTY:
+        return JSON_VALUE_EMPTY;
+    case LY_TYPE_LEAFREF:
+        return get_value_encoding(((const struct lysc_type_leafref *)type)->realtype, value);
+    case LY_TYPE_UNION:
+        LY_ARRAY_FOR(((const struct lysc_type_union *)type)->types, u)
+        {
+            const struct lysc_type *member = ((const struct lysc_type_union *)type)->types[u];
+            if (member->basetype != LY_TYPE_EMPTY &&
+                get_value_encoding(member, value) == JSON_VALUE_BARE)
+                return JSON_VALUE_BARE;
+        }
+        return JSON_VALUE_STRING;
+    default:
+        return JSON_VALUE_STRING;
+    }
+}
+
+static void print_json_string(struct printbuf *pb, const char *str)
+{
+    const char *start = str;
+
+    printbuf_strappend(pb, "\"");
+    for (; *str; str++) {
+        unsigned char c = *str;
+        if (c != '"' && c != '\\' && c >= 0x20)
+            continue;
+        printbuf_memappend(pb, start, str - start);
+        if (c == '"')
+            printbuf_strappend(pb, "\\\"");
+        else if (c == '\\')
+            printbuf_strappend(pb, "\\\\");
+        else
+            sprintbuf(pb, "\\u%04x", c);
+        start = str + 1;
+    }
+    printbuf_memappend(pb, start, str - start);
+    printbuf_strappend(pb, "\"");
+}
+
+static void print_json_value(struct printbuf *pb, const struct oper_json_node *node)
+{
+    const struct lysc_type *type;
+
+    if (node->schema->nodetype == LYS_LEAF)
+        type = ((const struct lysc_node_leaf *)node->schema)->type;
+    else
+        type = ((const struct lysc_node_leaflist *)node->schema)->type;
+
+    switch (get_value_encoding(type, node->value)) {
+    case JSON_VALUE_BARE:
+        printbuf_memappend(pb, node->value, strlen(node->value));
+        break;
+    case JSON_VALUE_EMPTY:
+        printbuf_strappend(pb, "[null]");
+        break;
+    default:
+        print_json_string(pb, node->value);
+        break;
+    }
+}
+
+static void print_json_members(struct printbuf *pb, const struct lys_module *parent_module,
+                               struct oper_json_node *first);
+
+static void print_json_instance(struct printbuf *pb, struct oper_json_node *node)
+{
+    node->printed = 1;
+    if (node->schema->nodetype & (LYS_LEAF | LYS_LEAFLIST)) {
+        print_json_value(pb, node);
+        return;
+    }
+    printbuf_strappend(pb, "{");
+    print_json_members(pb, node->schema->module, node->child);
+    printbuf_strappend(pb, "}");
+}
+
+/**
+ * print sibling nodes as JSON object members, the member name is prefixed with the module name
+ * when the module differs from the parent one, all instances of a list or a leaf-list are
+ * printed in one array.
+ * @param [in] pb print buffer.
+ * @param [in] parent_module module of the parent node, NULL for top-level nodes.
+ * @param [in] first first sibling node.
+ */
+static void print_json_members(struct printbuf *pb, const struct lys_module *parent_module,
+                               struct oper_json_node *first)
+{
+    struct oper_json_node *node, *instance;
+    int n_members = 0;
+
+    for (node = first; node; node = node->next) {
+        if (node->printed)
+            continue;
+        if (n_members++)
+            printbuf_strappend(pb, ",");
+
+        printbuf_strappend(pb, "\"");
+        if (node->schema->module != parent_module)
+            sprintbuf(pb, "%s:", node->schema->module->name);
+        sprintbuf(pb, "%s\":", node->schema->name);
+
+        if (!(node->schema->nodetype & (LYS_LIST | LYS_LEAFLIST))) {
+            print_json_instance(pb, node);
+            continue;
+        }
+        printbuf_strappend(pb, "[");
+        for (instance = node; instance; instance = instance->next) {
+            if (instance->schema != node->schema)
+                continue;
+            if (instance != node)
+                printbuf_strappend(pb, ",");
+            print_json_instance(pb, instance);
+        }
+        printbuf_strappend(pb, "]");
+    }
+}
+
+char *oper_json_print(struct oper_json_doc *doc)
+{
+    struct printbuf *pb = printbuf_new();
+    char *text = NULL;
+
+    if (pb == NULL) {
+        fprintf(stderr, "%s: memory allocation failed\n", __func__);
+        return NULL;
+    }
+    printbuf_strappend(pb, "{");
+    print_json_members(pb, NULL, doc->first);
+    printbuf_strappend(pb, "}");
+    text = strdup(pb->buf);
+    printbuf_free(pb);
+    return text;
+}
@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: AGPL-3.0-or-later */
+#ifndef IPROUTE2_SYSREPO_OPER_JSON_H
+#define IPROUTE2_SYSREPO_OPER_JSON_H
+
+#include <libyang/libyang.h>
+
+/**
+ * @brief YANG JSON document built by the oper data converter, nodes and values are allocated
+ * from memory blocks owned by the document and released all at once.
+ */
+struct oper_json_doc;
+
+/**
+ * @brief node of a YANG JSON document, an inner node or a term node holding its value.
+ */
+struct oper_json_node;
+
+/**
+ * create an empty YANG JSON document.
+ * @return the new document, NULL on memory allocation failure.
+ */
+struct oper_json_doc *oper_json_doc_new(void);
+
+/**
+ * free a YANG JSON document and all its nodes.
+ * @param [in] doc document to free.
+ */
+void oper_json_doc_free(struct oper_json_doc *doc);
+
+/**
+ * add a node to a YANG JSON document.
+ * @param [in] doc document to add the node to.
+ * @param [in] parent parent node, NULL to add a top-level node.
+ * @param [in] schema schema node of the new node.
+ * @param [in] value term node value, NULL for inner nodes.
+ * @return the new node, NULL on memory allocation failure.
+ */
+struct oper_json_node *oper_json_add(struct oper_json_doc *doc, struct oper_json_node *parent,
+                                     const struct lysc_node *schema, const char *value);
+
+/**
+ * find the first child node of a given schema.
+ * @param [in] parent node to search the children of.
+ * @param [in] schema schema node of the child.
+ * @return the found child node, NULL if not found.
+ */
+struct oper_json_node *oper_json_find_child(struct oper_json_node *parent,
+                                            const struct lysc_node *schema);
+
+/**
+ * get the schema node of a YANG JSON document node.
+ * @param [in] node document node.
+ * @return the node schema.
+ */
+const struct lysc_node *oper_json_schema(const struct oper_json_node *node);
+
+/**
+ * print a YANG JSON document, list and leaf-list instances are grouped into arrays and
+ * term values are encoded according to their YANG base type.
+ * @param [in] doc document to print.
+ * @return the document text, it's the caller responsibility to free it, NULL on failure.
+ */
+char *oper_json_print(struct oper_json_doc *doc);
+
+#endif // IPROUTE2_SYSREPO_OPER_JSON_H
@@ -69,8 +69,8 @@ else
     exit 1
 fi
 
-# Step 5: Check if nh id 4001 is created
-if ip nexthop show id 4001 >/dev/null 2>&1; then
+# Step 5: Check if the dev only nh id 4001 is created
+if ip nexthop show id 4001 2>/dev/null | grep -q "dev nh_if1"; then
     echo "TEST-INFO:NEXTHOP: IP nexthop id 4001 created successfully (OK)"
 else
     echo "TEST-ERROR:NEXTHOP: Failed to create IP nexthop 4001 (FAIL)"
@@ -17,6 +17,7 @@
 clean_up(){
   ip route del 11.11.11.11/32 2>/dev/null
   ip route del 22.22.22.22/32 2>/dev/null
+  ip -6 route del 2001:db8:22::/64 2>/dev/null
   ip link del if_route1 2>/dev/null
   ip link del if_route2 2>/dev/null
   ip link del if_route3 2>/dev/null
@@ -66,6 +67,15 @@ else
     exit 1
 fi
 
+# Step 5: Check if the IPv6 route is created
+if [ -n "$(ip -6 route show 2001:db8:22::/64 dev if_route1)" ]; then
+    echo "TEST-INFO:ROUTE: route 2001:db8:22::/64 created successfully (OK)"
+else
+    echo "TEST-ERROR:ROUTE: Failed to create route 2001:db8:22::/64 (FAIL)"
+    clean_up
+    exit 1
+fi
+
 # github workflow is failing as mpls is not enabled.
 ## Step 3: Check if mpls route is created, try to create same route, if failed (device already exist) then
 ## the route created successfully.
@@ -136,6 +146,18 @@ else
     exit 1
 fi
 
+# Attempt to delete the IPv6 route
+ip -6 route del 2001:db8:22::/64 2>/dev/null
+
+# if cmd exist failed (no such process) then the route deleted successfully.
+if [ $? -ne 0 ]; then
+    echo "TEST-INFO:ROUTE: Route 2001:db8:22::/64 deleted successfully (OK)"
+else
+    echo "TEST-ERROR:ROUTE: Failed to delete route 2001:db8:22::/64 (FAIL)"
+    clean_up
+    exit 1
+fi
+
 # Attempt to delete the netns route
 ip -n route_red route del 13.13.13.13/32 2>/dev/null
 
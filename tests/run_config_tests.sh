@@ -3,8 +3,11 @@
 # Set default return value
 ret=0
 
-# Start iproute2-sysrepo
-./bin/iproute2-sysrepo --no-monitor 2>&1 &
+# Start iproute2-sysrepo, IPR2_SR_ARGS selects the apply options under test
+# e.g. IPR2_SR_ARGS="--config-netlink iproute2-ip-route,iproute2-ip-nexthop" to apply the routes
+# and nexthops with netlink requests
+echo -e "\nSTARTING IPROUTE2-SYSREPO $IPR2_SR_ARGS"
+./bin/iproute2-sysrepo --no-monitor $IPR2_SR_ARGS 2>&1 &
 sysrepo_pid=$!
 sleep 0.5
 
@@ -0,0 +1,101 @@
+#!/bin/bash
+
+#####################################################################
+# Testbed Script for Testing iproute2-sysrepo "--oper-netlink"
+#####################################################################
+# This script creates links, routes and nexthops on linux, then reads
+# their operational data twice: once from the iproute2 show commands
+# JSON outputs (default) and once from the netlink decoders
+# (--oper-netlink). Both outputs must be identical, the link
+# statistics are left out as they change between the reads.
+#####################################################################
+
+ret=0
+oper_modules="iproute2-ip-link,iproute2-ip-route,iproute2-ip-nexthop"
+cli_output="/tmp/iproute2_sysrepo_oper_cli.xml"
+netlink_output="/tmp/iproute2_sysrepo_oper_netlink.xml"
+
+# operational data compared between the backends
+xpaths=(
+    "/iproute2-ip-link:links/link[name='oper_nl_if1']"
+    "/iproute2-ip-link:links/link[name='oper_nl_if2']"
+    "/iproute2-ip-link:links/vlan[name='oper_nl_vlan']"
+    "/iproute2-ip-route:routes/route[prefix='66.66.66.0/24']"
+    "/iproute2-ip-route:routes/route[prefix='77.77.77.77/32']"
+    "/iproute2-ip-route:routes/route[prefix='2001:db8:66::/64']"
+    "/iproute2-ip-nexthop:nexthops/nexthop[id='6601']"
+    "/iproute2-ip-nexthop:nexthops/nexthop[id='6602']"
+    "/iproute2-ip-nexthop:nexthops/nexthop[id='6603']"
+)
+
+echo -e "\nCREATING TEST SYSTEM CONFIG ON LINUX"
+ip link add name oper_nl_if1 mtu 1450 type dummy
+ip link add name oper_nl_if2 type dummy
+ip link add name oper_nl_vlan link oper_nl_if1 type vlan id 66
+ip link set name oper_nl_if1 up
+ip link set name oper_nl_if2 up
+ip address add dev oper_nl_if1 66.66.1.1/24
+ip address add dev oper_nl_if1 2001:db8:1::1/64 nodad
+ip address add dev oper_nl_if2 66.66.2.1/24
+ip route add 66.66.66.0/24 dev oper_nl_if1
+ip route add 77.77.77.77/32 table 100 metric 5 nexthop via 66.66.1.10 weight 2 \
+    nexthop via 66.66.2.10 weight 3
+ip route add 2001:db8:66::/64 via 2001:db8:1::10 dev oper_nl_if1
+ip nexthop add id 6601 dev oper_nl_if1
+ip nexthop add id 6602 via 66.66.2.10 dev oper_nl_if2
+ip nexthop add id 6603 group 6601/6602
+
+# Function to cleanup
+cleanup() {
+    ip nexthop del id 6603 2>/dev/null
+    ip nexthop del id 6602 2>/dev/null
+    ip nexthop del id 6601 2>/dev/null
+    ip route del 77.77.77.77/32 table 100 2>/dev/null
+    ip link del name oper_nl_vlan 2>/dev/null
+    ip link del name oper_nl_if1 2>/dev/null
+    ip link del name oper_nl_if2 2>/dev/null
+    rm -f $cli_output $netlink_output
+}
+
+# Function to read the compared operational data with the given iproute2-sysrepo options
+dump_oper_data() {
+    echo -e "\nSTARTING IPROUTE2-SYSREPO $2"
+    ./bin/iproute2-sysrepo --no-monitor $2 2>&1 &
+    sysrepo_pid=$!
+    sleep 0.5
+
+    >$1
+    for xpath in "${xpaths[@]}"; do
+        if ! output=$(sysrepocfg -X -d operational -f xml -x "$xpath"); then
+            echo "TEST-ERROR:OPER: sysrepo failed to extract data for $xpath (SYSREPO PROBLEM ?)"
+            ret=1
+        fi
+        echo "$output" | sed '/<stats64>/,/<\/stats64>/d' >>$1
+    done
+
+    kill $sysrepo_pid
+    wait $sysrepo_pid
+}
+
+dump_oper_data $cli_output ""
+dump_oper_data $netlink_output "--oper-netlink $oper_modules"
+if [ $ret -ne 0 ]; then
+    cleanup
+    exit $ret
+fi
+
+if [ ! -s $cli_output ]; then
+    echo "TEST-ERROR:OPER: no operational data read for the test objects (FAIL)"
+    cleanup
+    exit 1
+fi
+if ! diff -u $cli_output $netlink_output; then
+    echo "TEST-ERROR:OPER: --oper-netlink data differs from the show commands data (FAIL)"
+    cleanup
+    exit 1
+fi
+echo "TEST-INFO:OPER: --oper-netlink data matches the show commands data (OK)"
+
+cleanup
+echo "TEST-INFO: All Tests Completed Successfully (PASS)"
+exit $ret
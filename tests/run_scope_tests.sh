@@ -0,0 +1,170 @@
+#!/bin/bash
+
+#####################################################################
+# Testbed Script for Testing iproute2-sysrepo "--own-*" config scope
+#####################################################################
+# This script creates linux objects outside the config ownership
+# scope (a bgp route and a bridge link) and objects inside it before
+# starting iproute2-sysrepo with --own-protocols and --own-link-kinds.
+# It verifies that the foreign objects are left out of the running
+# datastore, and that a config apply and a running replace leave
+# them untouched on linux.
+#
+# Test Steps:
+# 1. Test foreign objects are excluded from the loaded running data
+# 2. Test config apply leaves the foreign objects untouched
+# 3. Test running replace leaves the foreign objects untouched
+#####################################################################
+
+ret=0
+
+owned_if="scope_if1"
+owned_if_address="33.33.33.1/24"
+owned_route="33.33.0.0/16"
+foreign_if="scope_br1"
+foreign_route="55.55.55.0/24"
+applied_if="scope_if2"
+applied_route="44.44.44.0/24"
+running_backup="/tmp/iproute2_sysrepo_scope_running.xml"
+
+echo -e "\nCREATING TEST SYSTEM CONFIG ON LINUX"
+ip link add name $owned_if type dummy
+ip link set name $owned_if up
+ip address add dev $owned_if $owned_if_address
+ip link add name $foreign_if type bridge
+ip route add $owned_route dev $owned_if proto static
+ip route add $foreign_route dev $owned_if proto bgp
+
+# Run iproute2-sysrepo with bgp routes and bridges outside its config scope,
+# IPR2_SR_ARGS adds the loading and apply options under test
+echo -e "\nSTARTING IPROUTE2-SYSREPO --own-protocols boot,static --own-link-kinds dummy $IPR2_SR_ARGS"
+./bin/iproute2-sysrepo --no-monitor --own-protocols boot,static --own-link-kinds dummy \
+    $IPR2_SR_ARGS 2>&1 &
+sysrepo_pid=$!
+sleep 0.5
+
+# Function to cleanup
+cleanup() {
+    ip route del $owned_route 2>/dev/null
+    ip route del $foreign_route 2>/dev/null
+    ip route del $applied_route 2>/dev/null
+    ip link del name $owned_if 2>/dev/null
+    ip link del name $foreign_if 2>/dev/null
+    ip link del name $applied_if 2>/dev/null
+    rm -f $running_backup
+    kill $sysrepo_pid
+    wait $sysrepo_pid
+}
+
+# Function to check the foreign objects are still on linux
+check_foreign_on_linux() {
+    if [ -z "$(ip route show $foreign_route proto bgp)" ]; then
+        echo "TEST-ERROR:SCOPE: foreign route $foreign_route removed from linux $1 (FAIL)"
+        cleanup
+        exit 1
+    fi
+    if ! ip link show dev $foreign_if >/dev/null 2>&1; then
+        echo "TEST-ERROR:SCOPE: foreign link $foreign_if removed from linux $1 (FAIL)"
+        cleanup
+        exit 1
+    fi
+    echo "TEST-INFO:SCOPE: foreign objects untouched $1 (OK)"
+}
+
+####################################################################
+# Test: foreign objects excluded from running
+####################################################################
+echo "--------------------"
+echo "[1] Test scope LOAD"
+echo "---------------------"
+
+output=$(sysrepocfg -X -d running -f xml -m iproute2-ip-route)
+if ! echo "$output" | grep -qP "<prefix>\s*$owned_route\s*</prefix>"; then
+    echo "TEST-ERROR:SCOPE: owned route $owned_route not loaded to running (FAIL)"
+    cleanup
+    exit 1
+fi
+if echo "$output" | grep -qP "<prefix>\s*$foreign_route\s*</prefix>"; then
+    echo "TEST-ERROR:SCOPE: foreign route $foreign_route loaded to running (FAIL)"
+    cleanup
+    exit 1
+fi
+
+output=$(sysrepocfg -X -d running -f xml -m iproute2-ip-link)
+if ! echo "$output" | grep -qP "<name>\s*$owned_if\s*</name>"; then
+    echo "TEST-ERROR:SCOPE: owned link $owned_if not loaded to running (FAIL)"
+    cleanup
+    exit 1
+fi
+if echo "$output" | grep -qP "<name>\s*$foreign_if\s*</name>"; then
+    echo "TEST-ERROR:SCOPE: foreign link $foreign_if loaded to running (FAIL)"
+    cleanup
+    exit 1
+fi
+echo "TEST-INFO:SCOPE: foreign objects excluded from running (OK)"
+
+# operational data shows all the objects
+output=$(sysrepocfg -X -d operational -f xml -m iproute2-ip-route)
+if ! echo "$output" | grep -qP "<prefix>\s*$foreign_route\s*</prefix>"; then
+    echo "TEST-ERROR:SCOPE: foreign route $foreign_route missing from operational (FAIL)"
+    cleanup
+    exit 1
+fi
+echo "TEST-INFO:SCOPE: foreign route in operational (OK)"
+
+####################################################################
+# Test: config apply
+####################################################################
+echo "--------------------"
+echo "[2] Test scope APPLY"
+echo "---------------------"
+
+sysrepocfg -X -d running -f xml >$running_backup || ret=$?
+sysrepocfg -d running --edit tests/cases/test_own_scope_data.xml || ret=$?
+if [ "$ret" -ne 0 ]; then
+    echo "TEST-ERROR:SCOPE: failed to apply the config in sysrepo datastore"
+    cleanup
+    exit "$ret"
+fi
+if [ -z "$(ip route show $applied_route)" ]; then
+    echo "TEST-ERROR:SCOPE: Failed to create route $applied_route (FAIL)"
+    cleanup
+    exit 1
+fi
+echo "TEST-INFO:SCOPE: route $applied_route created successfully (OK)"
+check_foreign_on_linux "by the config apply"
+
+####################################################################
+# Test: running replace
+####################################################################
+echo "--------------------"
+echo "[3] Test scope REPLACE"
+echo "---------------------"
+
+# restoring the loaded running data deletes the applied config only
+sysrepocfg --import=$running_backup -d running -f xml || ret=$?
+if [ "$ret" -ne 0 ]; then
+    echo "TEST-ERROR:SCOPE: failed to replace the running datastore"
+    cleanup
+    exit "$ret"
+fi
+if [ -n "$(ip route show $applied_route)" ]; then
+    echo "TEST-ERROR:SCOPE: Failed to delete route $applied_route (FAIL)"
+    cleanup
+    exit 1
+fi
+echo "TEST-INFO:SCOPE: route $applied_route deleted successfully (OK)"
+check_foreign_on_linux "by the running replace"
+
+cleanup
+
+# Final check for errors
+if [ $ret -ne 0 ]; then
+    echo "TEST-ERROR: One or more test scripts failed. (FAIL)"
+    exit $ret
+else
+    echo "TEST-INFO: All Tests Completed Successfully (PASS)"
+fi
+
+# Exit script with the final return value
+exit $ret
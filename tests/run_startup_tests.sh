@@ -210,9 +210,10 @@ tc class add dev $qdisc_if10 parent 1:10 classid 1:11 htb rate 8Mbit burst 1000
 tc class add dev $qdisc_if10 parent 1:11 classid 1:12 htb rate 950Kbit
 tc class add dev $qdisc_if10 parent 1:12 classid 1:13 htb rate 8bit prio 7
 
-# Run iproute2-sysrepo and store its PID
-echo -e "\nSTARTING IPROUTE2-SYSREPO"
-./bin/iproute2-sysrepo --no-monitor 2>&1 &
+# Run iproute2-sysrepo and store its PID, IPR2_SR_ARGS selects the loading options under test
+# e.g. IPR2_SR_ARGS="--oper-netlink iproute2-ip-link" to load the links with the netlink decoder
+echo -e "\nSTARTING IPROUTE2-SYSREPO $IPR2_SR_ARGS"
+./bin/iproute2-sysrepo --no-monitor $IPR2_SR_ARGS 2>&1 &
 sysrepo_pid=$!
 sleep 0.5
 